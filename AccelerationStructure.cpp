@@ -17,6 +17,8 @@
 
 namespace maple
 {
+	std::atomic<uint64_t> AccelerationStructure::addressChanges{0};
+
 	auto AccelerationStructure::createTopLevel(const uint32_t maxInstanceCount) -> Ptr
 	{
 #ifdef MAPLE_VULKAN
@@ -26,22 +28,30 @@ namespace maple
 #endif        // MAPLE_VULKAN
 	}
 
-	auto AccelerationStructure::createBottomLevel(const VertexBuffer::Ptr &vertexBuffer, const IndexBuffer::Ptr &indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr batchTask) -> Ptr
+	auto AccelerationStructure::createBottomLevel(const VertexBuffer::Ptr &vertexBuffer, const IndexBuffer::Ptr &indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr batchTask, bool allowUpdate) -> Ptr
 	{
 #ifdef MAPLE_VULKAN
-		return std::make_shared<VulkanAccelerationStructure>(vertexBuffer->getAddress(), indexBuffer->getAddress(),  vertexStride, subMeshes, batchTask);
+		return std::make_shared<VulkanAccelerationStructure>(vertexBuffer->getAddress(), indexBuffer->getAddress(),  vertexStride, subMeshes, batchTask, true, allowUpdate);
 #else
 		return std::make_shared<NullAccelerationStructure>();
 #endif
 	}
 
-	auto AccelerationStructure::createBottomLevel(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr batchTask) ->Ptr
+	auto AccelerationStructure::createBottomLevel(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr batchTask, bool allowUpdate) ->Ptr
 	{
 #ifdef MAPLE_VULKAN
-		return std::make_shared<VulkanAccelerationStructure>(vertexBuffer->getAddress(), indexBuffer->getAddress(), vertexStride, subMeshes, batchTask);
+		return std::make_shared<VulkanAccelerationStructure>(vertexBuffer->getAddress(), indexBuffer->getAddress(), vertexStride, subMeshes, batchTask, true, allowUpdate);
 #else
 		return std::make_shared<NullAccelerationStructure>();
 #endif
 	}
 
+	auto AccelerationStructure::createBottomLevel(const GeometryHeap::Ptr& heap, const GeometryAllocation& vertices, const GeometryAllocation& indices, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr batchTask, bool allowUpdate) -> Ptr
+	{
+#ifdef MAPLE_VULKAN
+		return std::make_shared<VulkanAccelerationStructure>(heap->getAddress(vertices), heap->getAddress(indices), vertexStride, subMeshes, batchTask, true, allowUpdate);
+#else
+		return std::make_shared<NullAccelerationStructure>();
+#endif
+	}
 }        // namespace maple
\ No newline at end of file
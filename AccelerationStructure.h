@@ -4,14 +4,17 @@
 #pragma once
 
 #include "BatchTask.h"
+#include "GeometryHeap.h"
 #include "IndexBuffer.h"
 #include "VertexBuffer.h"
+#include <atomic>
 #include <memory>
 
 namespace maple
 {
 	class StorageBuffer;
 	class CommandBuffer;
+	class AccelerationStructure;
 
 	struct SubMesh 
 	{
@@ -26,6 +29,22 @@ namespace maple
 		int32_t instanceOffset;
 	};
 
+	/**
+	 * structure of arrays for AccelerationStructure::setInstances, every array holds count entries.
+	 */
+	struct InstanceBatch
+	{
+		const uint32_t *handles           = nullptr;
+		const mat4 *    transforms        = nullptr;        //column major, transposed while packing
+		const uint32_t *customInstanceIds = nullptr;
+		const uint64_t *instanceAddresses = nullptr;        //ignored when structures are given
+		const uint8_t * masks             = nullptr;        //optional, 0xFF
+		const uint32_t *hitGroupOffsets   = nullptr;        //optional, 0
+		//optional, bottom level structures the instances follow like setInstance with a structure.
+		const std::shared_ptr<AccelerationStructure> *structures = nullptr;
+		uint32_t                                      count      = 0;
+	};
+
 	class  AccelerationStructure
 	{
 	  public:
@@ -33,14 +52,28 @@ namespace maple
 
 		static auto createTopLevel(const uint32_t maxInstanceCount) -> Ptr;
 
-		static auto createBottomLevel(const VertexBuffer::Ptr &vertexBuffer, const IndexBuffer::Ptr &indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr tasks) -> Ptr;
+		/**
+		 * bottom level structures created with allowUpdate are refitted by updateBLAS instead of rebuilt,
+		 * meant for skinned and animated meshes whose topology does not change.
+		 */
+		static auto createBottomLevel(const VertexBuffer::Ptr &vertexBuffer, const IndexBuffer::Ptr &indexBuffer, uint32_t vertexStride, const std::vector<SubMesh>& subMeshes, BatchTask::Ptr tasks, bool allowUpdate = false) -> Ptr;
+
+		static auto createBottomLevel(const VertexBuffer * vertexBuffer, const IndexBuffer* indexBuffer, uint32_t vertexStride, const std::vector<SubMesh> & subMeshes, BatchTask::Ptr tasks, bool allowUpdate = false)->Ptr;
+
+		/**
+		 * geometry written straight into geometry heap allocations.
+		 */
+		static auto createBottomLevel(const GeometryHeap::Ptr &heap, const GeometryAllocation &vertices, const GeometryAllocation &indices, uint32_t vertexStride, const std::vector<SubMesh> &subMeshes, BatchTask::Ptr tasks, bool allowUpdate = false) -> Ptr;
 
-		static auto createBottomLevel(const VertexBuffer * vertexBuffer, const IndexBuffer* indexBuffer, uint32_t vertexStride, const std::vector<SubMesh> & subMeshes, BatchTask::Ptr tasks)->Ptr;
+		virtual ~AccelerationStructure() = default;
 
 		virtual auto getBuildScratchSize() const -> uint64_t = 0;
 
 		virtual auto updateTLAS(const mat4 &transform, uint32_t instanceId, uint32_t customInstanceId, uint64_t instanceAddress) -> uint64_t = 0;
 
+		/**
+		 * queues a refit when the structure allows updates, otherwise a full rebuild.
+		 */
 		virtual auto updateBLAS(std::shared_ptr<BatchTask> batch) -> void = 0;
 
 		virtual auto resetTLAS(uint32_t instanceId) -> void = 0;
@@ -60,6 +93,89 @@ namespace maple
 		virtual auto build(const CommandBuffer *cmd, uint32_t instanceSize, uint32_t instanceOffset = 0) -> void = 0;
 
 		virtual auto isBuilt() const -> bool = 0;
+
+		static constexpr uint32_t InvalidInstance = UINT32_MAX;
+
+		/**
+		 * managed instance table of a top level structure. handles stay valid until freed, live
+		 * instances are kept packed at the front so a build only covers them, which moves instances
+		 * to other slots (gl_InstanceID) when others are freed. do not mix it with updateTLAS.
+		 * returns InvalidInstance when the table is full.
+		 */
+		virtual auto allocateInstance() -> uint32_t = 0;
+
+		virtual auto freeInstance(uint32_t handle) -> void = 0;
+
+		/**
+		 * the transform is column major and transposed into rows while packing, like setInstances.
+		 * the raw address is not updated when the bottom level structure moves, it has to be set
+		 * again after compaction or a full size rebuild. prefer the overload taking the structure.
+		 */
+		virtual auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, uint64_t instanceAddress, uint8_t mask = 0xFF, uint32_t hitGroupOffset = 0) -> void = 0;
+
+		/**
+		 * the instance follows the device address of the structure, uploadInstances re-reads it
+		 * after it changed. the structure is kept alive while the instance references it.
+		 */
+		virtual auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, const Ptr &structure, uint8_t mask = 0xFF, uint32_t hitGroupOffset = 0) -> void = 0;
+
+		/**
+		 * bulk setInstance for many instances, packed in parallel chunks.
+		 */
+		virtual auto setInstances(const InstanceBatch &batch) -> void = 0;
+
+		/**
+		 * copies the instances changed since the last upload, adjacent changes are merged into one region.
+		 */
+		virtual auto uploadInstances(const CommandBuffer *cmd) -> void = 0;
+
+		/**
+		 * live instances of the managed table, the instance size to build with.
+		 */
+		virtual auto getInstanceCount() const -> uint32_t = 0;
+
+		/**
+		 * refits lose quality as the geometry moves away from the built one, every interval refits
+		 * updateBLAS, or build of a top level structure, does a full rebuild instead. 0 always rebuilds.
+		 */
+		inline auto setRebuildInterval(uint32_t interval)
+		{
+			rebuildInterval = interval;
+		}
+
+		inline auto getRebuildInterval() const
+		{
+			return rebuildInterval;
+		}
+
+		/**
+		 * bumped whenever the device address of this structure changes.
+		 */
+		inline auto getAddressGeneration() const
+		{
+			return addressGeneration;
+		}
+
+		/**
+		 * address changes of all structures, top level structures only look at their instances
+		 * when it moved since the last upload.
+		 */
+		static inline auto getAddressChanges()
+		{
+			return addressChanges.load(std::memory_order_relaxed);
+		}
+
+	  protected:
+		inline auto onAddressChanged()
+		{
+			addressGeneration++;
+			addressChanges.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		uint32_t rebuildInterval   = 16;
+		uint32_t addressGeneration = 0;
+
+		static std::atomic<uint64_t> addressChanges;
 	};
 
 	class NullAccelerationStructure : public AccelerationStructure
@@ -77,6 +193,8 @@ namespace maple
 			return 0;
 		}
 
+		virtual auto updateBLAS(std::shared_ptr<BatchTask> batch) -> void override {}
+
 		virtual auto resetTLAS(uint32_t instanceId) -> void {}
 
 		virtual auto getDeviceAddress() const -> uint64_t
@@ -104,6 +222,26 @@ namespace maple
 		{
 			return true;
 		};
+
+		virtual auto allocateInstance() -> uint32_t override
+		{
+			return InvalidInstance;
+		}
+
+		virtual auto freeInstance(uint32_t handle) -> void override {}
+
+		virtual auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, uint64_t instanceAddress, uint8_t mask, uint32_t hitGroupOffset) -> void override {}
+
+		virtual auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, const Ptr &structure, uint8_t mask, uint32_t hitGroupOffset) -> void override {}
+
+		virtual auto setInstances(const InstanceBatch &batch) -> void override {}
+
+		virtual auto uploadInstances(const CommandBuffer *cmd) -> void override {}
+
+		virtual auto getInstanceCount() const -> uint32_t override
+		{
+			return 0;
+		}
 	};        // namespace maple
 
 }        // namespace maple
\ No newline at end of file
@@ -2,16 +2,50 @@
 // This file is part of the Maple Engine                              		//
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include <cstdint>
 #include <memory>
 
 namespace maple
 {
 	class CommandBuffer;
+
+	struct CompactionStats
+	{
+		uint64_t structures    = 0;
+		uint64_t originalSize  = 0;        //bytes before compaction
+		uint64_t compactedSize = 0;        //bytes after compaction
+	};
+
 	class BatchTask
 	{
 	  public:
 		using Ptr = std::shared_ptr<BatchTask>;
+		virtual ~BatchTask() = default;
 		virtual auto execute(const CommandBuffer* cmd) -> void = 0;
 		static auto  create()->Ptr;
+
+		/**
+		 * bottom level structures created after enabling are built compactable. their compacted
+		 * size is read back a few frames later and they are copied into right-sized buffers,
+		 * which changes their device address.
+		 */
+		inline auto setCompaction(bool compaction)
+		{
+			this->compaction = compaction;
+		}
+
+		inline auto isCompactionEnabled() const
+		{
+			return compaction;
+		}
+
+		inline auto &getCompactionStats() const
+		{
+			return compactionStats;
+		}
+
+	  protected:
+		bool            compaction = false;
+		CompactionStats compactionStats;
 	};
 };        // namespace maple
\ No newline at end of file
@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Benchmark.h"
+#include "../CPUProfiler.h"
+#include "../Console.h"
+#include "../GraphicsContext.h"
+#include "../Vulkan/VulkanDevice.h"
+#include "../Vulkan/VulkanSwapChain.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace maple
+{
+	namespace benchmark
+	{
+		namespace
+		{
+			inline auto getSwapChain()
+			{
+				return static_cast<VulkanSwapChain *>(GraphicsContext::get()->getSwapChain().get());
+			}
+
+			inline auto writeString(std::ostream &out, const std::string &str)
+			{
+				out << '"';
+				for (auto c : str)
+				{
+					if (c == '"' || c == '\\')
+						out << '\\';
+					out << c;
+				}
+				out << '"';
+			}
+
+			struct Result
+			{
+				std::string name;
+				std::string skipped;
+				size_t      iterations = 0;
+				double      mean       = 0;
+				double      p50        = 0;
+				double      p99        = 0;
+				double      min        = 0;
+				double      max        = 0;
+				double      bytesPerSecond = 0;
+			};
+
+			auto summarize(const std::string &name, const State &state) -> Result
+			{
+				Result result;
+				result.name    = name;
+				result.skipped = state.getSkipReason();
+
+				auto times = state.getTimes();
+				if (!result.skipped.empty() || times.empty())
+					return result;
+
+				std::sort(times.begin(), times.end());
+				double total = 0;
+				for (auto time : times)
+					total += time;
+				auto percentile = [&](double p) { return times[std::min(times.size() - 1, static_cast<size_t>(p * times.size()))]; };
+
+				result.iterations = times.size();
+				result.mean       = total / times.size();
+				result.p50        = percentile(0.5);
+				result.p99        = percentile(0.99);
+				result.min        = times.front();
+				result.max        = times.back();
+				if (state.getBytesProcessed() > 0 && result.mean > 0)
+					result.bytesPerSecond = state.getBytesProcessed() * 1e9 / result.mean;
+				return result;
+			}
+
+			auto write(const Options &options, const std::vector<Result> &results) -> bool
+			{
+				std::ofstream out(options.output);
+				if (!out)
+				{
+					LOGE("can not write benchmark results {0}", options.output);
+					return false;
+				}
+
+				out.setf(std::ios::fixed);
+				out.precision(3);
+				out << "{\"context\":{\"device\":";
+				writeString(out, VulkanDevice::get()->getPhysicalDevice()->getProperties().deviceName);
+				out << ",\"iterations\":" << options.iterations << ",\"warmup\":" << options.warmup << ",\"time_unit\":\"ns\"},\"benchmarks\":[";
+
+				bool first = true;
+				for (auto &result : results)
+				{
+					out << (first ? "\n" : ",\n") << "{\"name\":";
+					writeString(out, result.name);
+					if (!result.skipped.empty())
+					{
+						out << ",\"skipped\":";
+						writeString(out, result.skipped);
+					}
+					else
+					{
+						out << ",\"iterations\":" << result.iterations << ",\"mean\":" << result.mean << ",\"p50\":" << result.p50
+						    << ",\"p99\":" << result.p99 << ",\"min\":" << result.min << ",\"max\":" << result.max;
+						if (result.bytesPerSecond > 0)
+							out << ",\"bytes_per_second\":" << result.bytesPerSecond;
+					}
+					out << '}';
+					first = false;
+				}
+				out << "\n]}\n";
+				return out.good();
+			}
+		}        // namespace
+
+		State::State(uint32_t iterations, uint32_t warmup, bool framed) :
+		    iterations(iterations),
+		    warmup(warmup),
+		    framed(framed)
+		{
+			times.reserve(iterations);
+		}
+
+		auto State::keepRunning() -> bool
+		{
+			auto now = Clock::now();
+			if (paused)
+				resumeTiming();
+			if (current > warmup)
+				times.emplace_back(std::chrono::duration<double, std::nano>(now - start - pausedTime).count());
+
+			if (!skipReason.empty() || current == warmup + iterations)
+			{
+				if (frameOpen)
+					endFrame();
+				return false;
+			}
+
+			if (framed && current % FrameBatch == 0)
+			{
+				if (frameOpen)
+					endFrame();
+				beginFrame();
+			}
+
+			current++;
+			pausedTime = {};
+			start      = Clock::now();
+			return true;
+		}
+
+		auto State::pauseTiming() -> void
+		{
+			if (paused)
+				return;
+			paused     = true;
+			pauseStart = Clock::now();
+		}
+
+		auto State::resumeTiming() -> void
+		{
+			if (!paused)
+				return;
+			paused = false;
+			pausedTime += Clock::now() - pauseStart;
+		}
+
+		auto State::getCommandBuffer() const -> CommandBuffer *
+		{
+			return frameOpen ? getSwapChain()->getCurrentCommandBuffer() : nullptr;
+		}
+
+		auto State::beginFrame() -> void
+		{
+			getSwapChain()->begin();
+			frameOpen = true;
+		}
+
+		auto State::endFrame() -> void
+		{
+			auto swapChain = getSwapChain();
+			swapChain->end();
+			swapChain->queueSubmit();
+			swapChain->present();
+			frameOpen = false;
+		}
+
+		auto registerScenario(const Scenario &scenario) -> bool
+		{
+			getScenarios().emplace_back(scenario);
+			return true;
+		}
+
+		auto getScenarios() -> std::vector<Scenario> &
+		{
+			static std::vector<Scenario> scenarios;
+			return scenarios;
+		}
+
+		auto run(const Options &options) -> bool
+		{
+			auto scenarios = getScenarios();
+			std::sort(scenarios.begin(), scenarios.end(), [](const Scenario &left, const Scenario &right) {
+				return left.name < right.name;
+			});
+
+			auto                runStart = std::chrono::steady_clock::now();
+			std::vector<Result> results;
+			for (auto &scenario : scenarios)
+			{
+				if (!options.filter.empty() && scenario.name.find(options.filter) == std::string::npos)
+					continue;
+
+				LOGI("[BENCHMARK] {0}", scenario.name);
+				State state(options.iterations, options.warmup, scenario.framed);
+				scenario.function(state);
+				//deferred GPU work and releases of this scenario must not land in the next one.
+				GraphicsContext::get()->waitIdle();
+
+				auto &result = results.emplace_back(summarize(scenario.name, state));
+				if (!result.skipped.empty())
+					LOGW("[BENCHMARK] {0} skipped : {1}", result.name, result.skipped);
+				else
+					LOGI("[BENCHMARK] {0} : mean {1:.1f} ns, p99 {2:.1f} ns", result.name, result.mean, result.p99);
+			}
+
+			if (!options.scopes.empty())
+			{
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - runStart;
+				CPUProfiler::dumpSummary(options.scopes, elapsed.count());
+			}
+			return write(options, results);
+		}
+	}        // namespace benchmark
+}        // namespace maple
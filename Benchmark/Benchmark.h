@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+
+	namespace benchmark
+	{
+		/**
+		 * runs one scenario, modelled after google benchmark:
+		 *
+		 *	while (state.keepRunning())
+		 *		work();
+		 *
+		 * every iteration is timed on its own. framed scenarios run inside a headless frame which is
+		 * submitted every FrameBatch iterations, beginning and submitting it is not timed.
+		 */
+		class State
+		{
+		  public:
+			static constexpr uint32_t FrameBatch = 32;
+
+			State(uint32_t iterations, uint32_t warmup, bool framed);
+
+			auto keepRunning() -> bool;
+
+			/**
+			 * excludes setup inside the loop, e.g. clearing a cache to measure misses.
+			 */
+			auto pauseTiming() -> void;
+			auto resumeTiming() -> void;
+
+			/**
+			 * command buffer of the open frame, nullptr for scenarios which are not framed.
+			 */
+			auto getCommandBuffer() const -> CommandBuffer *;
+
+			inline auto setBytesProcessed(uint64_t bytes)
+			{
+				bytesPerIteration = bytes;
+			}
+
+			inline auto skip(const std::string &reason)
+			{
+				skipReason = reason;
+			}
+
+			inline auto &getTimes() const
+			{
+				return times;
+			}
+
+			inline auto getBytesProcessed() const
+			{
+				return bytesPerIteration;
+			}
+
+			inline auto &getSkipReason() const
+			{
+				return skipReason;
+			}
+
+		  private:
+			using Clock = std::chrono::steady_clock;
+
+			auto beginFrame() -> void;
+			auto endFrame() -> void;
+
+			uint32_t            iterations;
+			uint32_t            warmup;
+			uint32_t            current = 0;
+			bool                framed;
+			bool                frameOpen = false;
+			bool                paused    = false;
+			Clock::time_point   start;
+			Clock::duration     pausedTime{};
+			Clock::time_point   pauseStart;
+			std::vector<double> times;        //ns per measured iteration
+			uint64_t            bytesPerIteration = 0;
+			std::string         skipReason;
+		};
+
+		struct Scenario
+		{
+			std::string                  name;
+			std::function<void(State &)> function;
+			bool                         framed = false;
+		};
+
+		auto registerScenario(const Scenario &scenario) -> bool;
+		auto getScenarios() -> std::vector<Scenario> &;
+
+		struct Options
+		{
+			uint32_t    iterations = 1000;
+			uint32_t    warmup     = 16;
+			std::string filter;                   //substring of the scenario name, empty runs all
+			std::string output = "benchmark.json";
+			std::string scopes;                   //optional CPUProfiler::dumpSummary of the whole run
+		};
+
+		/**
+		 * runs the registered scenarios against the initialized graphics context and writes
+		 * name, iterations, mean, p50, p99, min and max in ns per scenario as json.
+		 * returns false if the results can not be written.
+		 */
+		auto run(const Options &options) -> bool;
+	}        // namespace benchmark
+}        // namespace maple
+
+#define MAPLE_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define MAPLE_BENCHMARK_CONCAT(a, b) MAPLE_BENCHMARK_CONCAT_IMPL(a, b)
+
+#define MAPLE_BENCHMARK_IMPL(name, framed)                                                                   \
+	static auto name(::maple::benchmark::State &state)->void;                                                \
+	static const auto MAPLE_BENCHMARK_CONCAT(name, Registered) = ::maple::benchmark::registerScenario({#name, name, framed}); \
+	static auto name(::maple::benchmark::State &state)->void
+
+//scenario without graphics work, e.g. a cpu kernel.
+#define MAPLE_BENCHMARK(name) MAPLE_BENCHMARK_IMPL(name, false)
+//scenario recording into a frame, State::getCommandBuffer is valid.
+#define MAPLE_BENCHMARK_FRAMED(name) MAPLE_BENCHMARK_IMPL(name, true)
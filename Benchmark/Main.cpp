@@ -0,0 +1,62 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Benchmark.h"
+#include "../Console.h"
+#include "../GraphicsContext.h"
+#include "../RenderDevice.h"
+#include "../ShaderCompiler.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+/**
+ * headless scenario runner, no window or presentation engine is needed. on machines without a GPU
+ * point the loader at a software ICD, e.g.
+ *
+ *	VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json MapleBenchmark --out=results.json
+ *
+ * options : --iterations=N --warmup=N --filter=<substring> --out=<json> --scopes=<json>
+ */
+auto main(int argc, char **argv) -> int
+{
+	using namespace maple;
+
+	benchmark::Options options;
+	for (int32_t i = 1; i < argc; i++)
+	{
+		std::string_view arg   = argv[i];
+		auto             value = [&](std::string_view key) -> const char * {
+			return arg.substr(0, key.size()) == key ? argv[i] + key.size() : nullptr;
+		};
+
+		if (auto v = value("--iterations="))
+			options.iterations = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+		else if (auto v = value("--warmup="))
+			options.warmup = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+		else if (auto v = value("--filter="))
+			options.filter = v;
+		else if (auto v = value("--out="))
+			options.output = v;
+		else if (auto v = value("--scopes="))
+			options.scopes = v;
+		else
+		{
+			std::printf("unknown option %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	Console::init();
+	ShaderCompiler::init();
+	GraphicsContext::get()->init(nullptr, 256, 256);
+	RenderDevice::get()->init();
+
+	auto success = benchmark::run(options);
+
+	GraphicsContext::get()->waitIdle();
+	ShaderCompiler::finalize();
+	Console::shutdown();
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,382 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "Benchmark.h"
+#include "../Console.h"
+#include "../DescriptorSet.h"
+#include "../GraphicsContext.h"
+#include "../ImageConvert.h"
+#include "../Pipeline.h"
+#include "../Shader.h"
+#include "../ShaderCompiler.h"
+#include "../StringUtils.h"
+#include "../Textures.h"
+#include "../UniformBuffer.h"
+#include "../VertexBuffer.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+
+#include <vector>
+
+namespace maple
+{
+	namespace
+	{
+		constexpr uint32_t TargetSize   = 256;
+		constexpr uint32_t ImagePixels  = 1024 * 1024;
+		constexpr uint32_t VertexBytes  = 64 * 1024;
+		constexpr uint32_t TextureBytes = TargetSize * TargetSize * 4;
+		constexpr size_t   LogQueueSize = 8192;
+		constexpr const char *LogFile   = "benchmark.log";
+		constexpr const char *SplitInput =
+		    "layout(location = 0) in vec3 inPosition;\nlayout(location = 1) in vec2 inUV;\nlayout(location = 2) in vec3 inNormal;\n"
+		    "layout(location = 3) in vec4 inTangent;\nlayout(location = 0) out vec2 outUV;\nlayout(location = 1) out vec4 outColor;\n";
+
+		constexpr const char *VertexShader = R"(
+#version 450
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inUV;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject
+{
+	mat4 viewProj;
+	vec4 color;
+} ubo;
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out vec4 outColor;
+
+void main()
+{
+	gl_Position = ubo.viewProj * vec4(inPosition, 1.0);
+	outUV       = inUV;
+	outColor    = ubo.color;
+}
+)";
+
+		constexpr const char *FragmentShader = R"(
+#version 450
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in vec4 inColor;
+
+layout(set = 0, binding = 1) uniform sampler2D uTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	outColor = texture(uTexture, inUV) * inColor;
+}
+)";
+
+		constexpr const char *ComputeShader = R"(
+#version 450
+layout(local_size_x = 64) in;
+layout(set = 0, binding = 0) buffer Values { float values[]; };
+
+void main()
+{
+	uint i    = gl_GlobalInvocationID.x;
+	values[i] = values[i] * 2.0 + 1.0;
+}
+)";
+
+		/**
+		 * resources shared by the scenarios, created on first use so filtered runs only pay for what they touch.
+		 */
+		struct Scene
+		{
+			std::shared_ptr<Shader>        shader;
+			std::shared_ptr<Texture2D>     target;
+			std::shared_ptr<Texture2D>     texture;
+			std::shared_ptr<DescriptorSet> descriptorSet;
+			PipelineInfo                   pipelineInfo;
+			bool                           valid = false;
+
+			static auto get() -> Scene &
+			{
+				static Scene scene;
+				if (!scene.valid)
+					scene.init();
+				return scene;
+			}
+
+		  private:
+			auto init() -> void
+			{
+				std::vector<uint32_t> vertSpirv;
+				std::vector<uint32_t> fragSpirv;
+				if (!ShaderCompiler::complie(ShaderType::Vertex, VertexShader, vertSpirv, "") ||
+				    !ShaderCompiler::complie(ShaderType::Fragment, FragmentShader, fragSpirv, ""))
+				{
+					LOGC("compile benchmark shaders failed");
+					return;
+				}
+
+				shader = Shader::create(vertSpirv, fragSpirv);
+				target = Texture2D::create();
+				target->buildTexture(TextureFormat::RGBA8, TargetSize, TargetSize);
+
+				std::vector<uint8_t> pixels(TextureBytes, 0xff);
+				texture = Texture2D::create(TargetSize, TargetSize, pixels.data());
+
+				descriptorSet = DescriptorSet::create({0, shader.get()});
+				descriptorSet->setTexture("uTexture", texture);
+
+				pipelineInfo.shader          = shader;
+				pipelineInfo.colorTargets[0] = target;
+				pipelineInfo.depthTest       = false;
+				pipelineInfo.pipelineName    = "Benchmark";
+				valid                        = true;
+			}
+		};
+
+		struct UniformData
+		{
+			float viewProj[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+			float color[4]     = {1, 1, 1, 1};
+		};
+
+		template <typename Convert>
+		inline auto convertImage(benchmark::State &state, uint32_t inStride, Convert convert)
+		{
+			std::vector<uint8_t> in(ImagePixels * inStride, 0x5a);
+			std::vector<uint8_t> out(ImagePixels * 4);
+			state.setBytesProcessed(static_cast<uint64_t>(ImagePixels) * inStride);
+			while (state.keepRunning())
+				convert(in.data(), out.data(), static_cast<int32_t>(ImagePixels));
+		}
+
+		/**
+		 * StringUtils::format and split before they stopped allocating, kept as the baseline.
+		 */
+		template <typename... Args>
+		inline auto legacyFormat(const std::string &format, Args... args) -> std::string
+		{
+			size_t                  size = snprintf(nullptr, 0, format.c_str(), args...) + 1;
+			std::unique_ptr<char[]> buf(new char[size]);
+			snprintf(buf.get(), size, format.c_str(), args...);
+			return std::string(buf.get(), buf.get() + size - 1);
+		}
+
+		inline auto legacySplit(std::string input, const std::string &delimiter) -> std::vector<std::string>
+		{
+			std::vector<std::string> ret;
+			size_t                   pos = 0;
+			while ((pos = input.find(delimiter)) != std::string::npos)
+			{
+				ret.push_back(input.substr(0, pos));
+				input.erase(0, pos + delimiter.length());
+			}
+			ret.push_back(input);
+			return ret;
+		}
+
+		/**
+		 * cost of a log call on the calling thread, e.g. the render thread. the line looks like a
+		 * typical per-frame message, queued async messages are written after the timing ends.
+		 */
+		inline auto logLatency(benchmark::State &state, const std::shared_ptr<spdlog::logger> &logger)
+		{
+			logger->set_level(spdlog::level::trace);
+			logger->flush_on(spdlog::level::err);
+			uint32_t frame = 0;
+			while (state.keepRunning())
+				logger->info("frame {0} : {1} draw calls, {2:.3f} ms", frame++, 1024, 16.6f);
+		}
+
+		inline auto logAsyncLatency(benchmark::State &state, spdlog::async_overflow_policy policy)
+		{
+			auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(LogFile, true);
+			//destroyed after the logger, joining the writer thread once the queue is drained.
+			auto pool = std::make_shared<spdlog::details::thread_pool>(LogQueueSize, 1);
+			logLatency(state, std::make_shared<spdlog::async_logger>("BenchmarkAsync", sink, pool, policy));
+		}
+	}        // namespace
+
+	MAPLE_BENCHMARK(PipelineGetHit)
+	{
+		auto &scene = Scene::get();
+		if (!scene.valid)
+			return state.skip("benchmark shaders did not compile");
+
+		Pipeline::get(scene.pipelineInfo);
+		while (state.keepRunning())
+			Pipeline::get(scene.pipelineInfo);
+	}
+
+	MAPLE_BENCHMARK_FRAMED(PipelineGetMiss)
+	{
+		auto &scene = Scene::get();
+		if (!scene.valid)
+			return state.skip("benchmark shaders did not compile");
+
+		while (state.keepRunning())
+		{
+			state.pauseTiming();
+			GraphicsContext::get()->getPipelineCache().clear();
+			state.resumeTiming();
+			Pipeline::get(scene.pipelineInfo);
+		}
+	}
+
+	MAPLE_BENCHMARK(DescriptorSetSetUniform)
+	{
+		auto &scene = Scene::get();
+		if (!scene.valid)
+			return state.skip("benchmark shaders did not compile");
+
+		UniformData data;
+		while (state.keepRunning())
+			scene.descriptorSet->setUniform("UniformBufferObject", "color", data.color);
+	}
+
+	MAPLE_BENCHMARK_FRAMED(DescriptorSetUpdate)
+	{
+		auto &scene = Scene::get();
+		if (!scene.valid)
+			return state.skip("benchmark shaders did not compile");
+
+		UniformData data;
+		while (state.keepRunning())
+		{
+			data.color[0] += 1.0f;
+			scene.descriptorSet->setUniform("UniformBufferObject", &data);
+			scene.descriptorSet->update(state.getCommandBuffer());
+		}
+	}
+
+	MAPLE_BENCHMARK(UniformBufferSetData)
+	{
+		UniformData data;
+		auto        buffer = UniformBuffer::create(sizeof(UniformData), &data);
+		state.setBytesProcessed(sizeof(UniformData));
+		while (state.keepRunning())
+			buffer->setData(&data);
+	}
+
+	MAPLE_BENCHMARK_FRAMED(VertexBufferUpload)
+	{
+		std::vector<uint8_t> vertices(VertexBytes, 0x3c);
+		auto                 buffer = VertexBuffer::create(vertices.data(), VertexBytes);
+		state.setBytesProcessed(VertexBytes);
+		while (state.keepRunning())
+			buffer->setData(VertexBytes, vertices.data());
+	}
+
+	MAPLE_BENCHMARK_FRAMED(VertexBufferUploadGpuOnly)
+	{
+		std::vector<uint8_t> vertices(VertexBytes, 0x3c);
+		auto                 buffer = VertexBuffer::create(vertices.data(), VertexBytes, true);
+		state.setBytesProcessed(VertexBytes);
+		while (state.keepRunning())
+			buffer->setData(VertexBytes, vertices.data());
+	}
+
+	MAPLE_BENCHMARK_FRAMED(TextureUpdate)
+	{
+		auto &scene = Scene::get();
+		if (!scene.valid)
+			return state.skip("benchmark shaders did not compile");
+
+		std::vector<uint8_t> pixels(TextureBytes, 0x7f);
+		state.setBytesProcessed(TextureBytes);
+		while (state.keepRunning())
+			scene.texture->update(0, 0, TargetSize, TargetSize, pixels.data());
+	}
+
+	MAPLE_BENCHMARK(ImageConvert4444To8888)
+	{
+		convertImage(state, 2, ImageConverter::convert4444To8888);
+	}
+
+	MAPLE_BENCHMARK(ImageConvert565To8888)
+	{
+		convertImage(state, 2, ImageConverter::convert565To8888);
+	}
+
+	MAPLE_BENCHMARK(ImageConvert888To8888)
+	{
+		convertImage(state, 3, ImageConverter::convert888To8888);
+	}
+
+	MAPLE_BENCHMARK(LogSync)
+	{
+		auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(LogFile, true);
+		logLatency(state, std::make_shared<spdlog::logger>("BenchmarkSync", sink));
+	}
+
+	MAPLE_BENCHMARK(LogAsyncBlock)
+	{
+		logAsyncLatency(state, spdlog::async_overflow_policy::block);
+	}
+
+	MAPLE_BENCHMARK(LogAsyncDropOldest)
+	{
+		logAsyncLatency(state, spdlog::async_overflow_policy::overrun_oldest);
+	}
+
+	MAPLE_BENCHMARK(StringFormatLegacy)
+	{
+		uint32_t frame = 0;
+		while (state.keepRunning())
+			legacyFormat("frame %u : %s %d draw calls, %.3f ms", frame++, "Forward", 1024, 16.6);
+	}
+
+	MAPLE_BENCHMARK(StringFormat)
+	{
+		uint32_t frame = 0;
+		while (state.keepRunning())
+			StringUtils::format("frame %u : %s %d draw calls, %.3f ms", frame++, "Forward", 1024, 16.6);
+	}
+
+	MAPLE_BENCHMARK(StringFormatTemp)
+	{
+		uint32_t frame = 0;
+		while (state.keepRunning())
+			StringUtils::formatTemp("frame %u : %s %d draw calls, %.3f ms", frame++, "Forward", 1024, 16.6);
+	}
+
+	MAPLE_BENCHMARK(StringSplitLegacy)
+	{
+		state.setBytesProcessed(std::char_traits<char>::length(SplitInput));
+		while (state.keepRunning())
+			legacySplit(SplitInput, "\n");
+	}
+
+	MAPLE_BENCHMARK(StringSplit)
+	{
+		std::vector<std::string> tokens;
+		state.setBytesProcessed(std::char_traits<char>::length(SplitInput));
+		while (state.keepRunning())
+		{
+			tokens.clear();
+			StringUtils::split(SplitInput, "\n", tokens);
+		}
+	}
+
+	MAPLE_BENCHMARK(StringSplitView)
+	{
+		size_t count = 0;
+		state.setBytesProcessed(std::char_traits<char>::length(SplitInput));
+		while (state.keepRunning())
+		{
+			for (auto token : StringUtils::splitView(SplitInput, "\n"))
+				count += token.size();
+		}
+		if (count == 0)
+			state.skip("split produced no tokens");
+	}
+
+	MAPLE_BENCHMARK(ShaderCompilerCompute)
+	{
+		std::vector<uint32_t> spirv;
+		while (state.keepRunning())
+		{
+			spirv.clear();
+			if (!ShaderCompiler::complie(ShaderType::Compute, ComputeShader, spirv, ""))
+				return state.skip("compute shader did not compile");
+		}
+	}
+}        // namespace maple
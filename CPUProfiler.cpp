@@ -0,0 +1,305 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "CPUProfiler.h"
+#include "Console.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace maple
+{
+	namespace
+	{
+		struct Event
+		{
+			std::atomic<const char *> name;
+			std::atomic<uint64_t>     begin;
+			std::atomic<uint64_t>     end;
+		};
+
+		struct Sample
+		{
+			const char *name;
+			uint64_t    begin;
+			uint64_t    end;
+		};
+
+		//written by one thread only, the head is published after the slot is written.
+		struct ThreadBuffer
+		{
+			std::unique_ptr<Event[]> events{new Event[CPUProfiler::BufferCapacity]};
+			std::atomic<uint64_t>    head{0};
+			uint32_t                 threadId = 0;
+			std::string              name;
+
+			inline auto push(const char *name, uint64_t begin, uint64_t end)
+			{
+				auto  index = head.load(std::memory_order_relaxed);
+				auto &event = events[index & (CPUProfiler::BufferCapacity - 1)];
+				//pairs with the fence in snapshot, a reader seeing these stores also sees head >= index.
+				std::atomic_thread_fence(std::memory_order_release);
+				event.name.store(name, std::memory_order_relaxed);
+				event.begin.store(begin, std::memory_order_relaxed);
+				event.end.store(end, std::memory_order_relaxed);
+				head.store(index + 1, std::memory_order_release);
+			}
+
+			//copies what is still in the buffer, slots overwritten while copying are dropped.
+			inline auto snapshot(std::vector<Sample> &samples) const
+			{
+				samples.clear();
+				auto last  = head.load(std::memory_order_acquire);
+				auto first = last > CPUProfiler::BufferCapacity ? last - CPUProfiler::BufferCapacity : 0;
+				for (auto i = first; i < last; i++)
+				{
+					auto &event = events[i & (CPUProfiler::BufferCapacity - 1)];
+					samples.push_back({event.name.load(std::memory_order_relaxed), event.begin.load(std::memory_order_relaxed), event.end.load(std::memory_order_relaxed)});
+				}
+				//the writer may be filling the slot of index 'current' which held index current - capacity.
+				//seqlock style, the fence keeps the slot loads above from moving after the head load.
+				std::atomic_thread_fence(std::memory_order_acquire);
+				auto current = head.load(std::memory_order_relaxed);
+				auto valid   = current >= CPUProfiler::BufferCapacity ? current - CPUProfiler::BufferCapacity + 1 : 0;
+				if (valid > first)
+					samples.erase(samples.begin(), samples.begin() + std::min<uint64_t>(valid - first, samples.size()));
+			}
+		};
+
+		struct Registry
+		{
+			Registry() :
+			    startTicks(CPUProfiler::now()), startTime(std::chrono::steady_clock::now())
+			{
+				frames.name = "Frames";
+			}
+
+			//ticks are rdtsc cycles or clock units, calibrated against the steady clock since start.
+			inline auto ticksPerMicrosecond() const
+			{
+				auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+				return elapsed > 0 ? std::max(static_cast<double>(CPUProfiler::now() - startTicks) / elapsed, 1e-6) : 1.0;
+			}
+
+			std::mutex                                 mutex;
+			std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+			ThreadBuffer                               frames;
+
+			uint64_t                              startTicks;
+			std::chrono::steady_clock::time_point startTime;
+
+			uint64_t           frameIndex     = 0;
+			uint64_t           lastFrameTicks = 0;
+			uint64_t           lastSpikeTicks = 0;
+			std::atomic<float> lastFrameTime{0};
+			float              spikeThreshold = 0;
+			double             spikeSeconds   = 2.0;
+			std::string        spikePrefix;
+		};
+
+		auto getRegistry() -> Registry &
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		thread_local ThreadBuffer *threadBuffer = nullptr;
+
+		auto getThreadBuffer() -> ThreadBuffer &
+		{
+			if (threadBuffer == nullptr)
+			{
+				auto &registry = getRegistry();
+				//buffers outlive their threads, a dump still shows the work of finished threads.
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				auto                        buffer = std::make_unique<ThreadBuffer>();
+				buffer->threadId                  = static_cast<uint32_t>(registry.buffers.size() + 1);
+				threadBuffer                      = buffer.get();
+				registry.buffers.emplace_back(std::move(buffer));
+			}
+			return *threadBuffer;
+		}
+
+		inline auto writeString(std::ostream &out, const char *str)
+		{
+			out << '"';
+			for (; str != nullptr && *str != '\0'; str++)
+			{
+				if (*str == '"' || *str == '\\')
+					out << '\\';
+				out << *str;
+			}
+			out << '"';
+		}
+	}        // namespace
+
+	std::atomic<bool> CPUProfiler::enabled{true};
+
+	auto CPUProfiler::record(const char *name, uint64_t begin, uint64_t end) -> void
+	{
+		getThreadBuffer().push(name, begin, end);
+	}
+
+	auto CPUProfiler::setThreadName(const char *name) -> void
+	{
+		auto &buffer = getThreadBuffer();
+		std::lock_guard<std::mutex> lock(getRegistry().mutex);
+		buffer.name = name;
+	}
+
+	auto CPUProfiler::frameMark() -> void
+	{
+		auto &registry = getRegistry();
+		auto  current  = now();
+		if (registry.lastFrameTicks == 0)
+		{
+			registry.lastFrameTicks = current;
+			return;
+		}
+
+		auto ticksPerMs = registry.ticksPerMicrosecond() * 1000.0;
+		auto frameTime  = static_cast<float>((current - registry.lastFrameTicks) / ticksPerMs);
+		registry.frames.push("Frame", registry.lastFrameTicks, current);
+		registry.lastFrameTicks = current;
+		registry.lastFrameTime.store(frameTime, std::memory_order_relaxed);
+		registry.frameIndex++;
+
+		if (registry.spikeThreshold > 0 && frameTime > registry.spikeThreshold && isEnabled() &&
+		    (registry.lastSpikeTicks == 0 || current - registry.lastSpikeTicks > registry.spikeSeconds * 1000.0 * ticksPerMs))
+		{
+			auto path = registry.spikePrefix + std::to_string(registry.frameIndex) + ".json";
+			if (dump(path, registry.spikeSeconds))
+				LOGW("frame {0} took {1} ms, trace written to {2}", registry.frameIndex, frameTime, path);
+			//the time spent writing the trace is not charged to the next frame.
+			registry.lastFrameTicks = now();
+			registry.lastSpikeTicks = registry.lastFrameTicks;
+		}
+	}
+
+	auto CPUProfiler::dump(const std::string &path, double seconds) -> bool
+	{
+		PROFILE_FUNCTION();
+		std::ofstream out(path);
+		if (!out)
+		{
+			LOGE("can not write profile trace {0}", path);
+			return false;
+		}
+
+		auto &registry    = getRegistry();
+		auto  ticksPerUs  = registry.ticksPerMicrosecond();
+		auto  end         = now();
+		auto  windowTicks = static_cast<uint64_t>(seconds * 1000000.0 * ticksPerUs);
+		auto  from        = end > windowTicks ? end - windowTicks : 0;
+		auto  toUs        = [&](uint64_t ticks) { return static_cast<double>(ticks - registry.startTicks) / ticksPerUs; };
+
+		std::vector<Sample> samples;
+		samples.reserve(BufferCapacity);
+
+		bool first = true;
+		auto write = [&](const ThreadBuffer &buffer) {
+			out << (first ? "" : ",\n") << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << buffer.threadId << R"(,"args":{"name":)";
+			writeString(out, buffer.name.empty() ? ("Thread " + std::to_string(buffer.threadId)).c_str() : buffer.name.c_str());
+			out << "}}";
+			first = false;
+
+			buffer.snapshot(samples);
+			for (auto &sample : samples)
+			{
+				if (sample.end < from || sample.begin < registry.startTicks)
+					continue;
+				out << ",\n{\"name\":";
+				writeString(out, sample.name);
+				out << R"(,"ph":"X","pid":0,"tid":)" << buffer.threadId << ",\"ts\":" << toUs(sample.begin) << ",\"dur\":" << (sample.end - sample.begin) / ticksPerUs << '}';
+			}
+		};
+
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		out << "{\"traceEvents\":[\n";
+		{
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			write(registry.frames);
+			for (auto &buffer : registry.buffers)
+				write(*buffer);
+		}
+		out << "\n]}\n";
+		return out.good();
+	}
+
+	auto CPUProfiler::dumpSummary(const std::string &path, double seconds) -> bool
+	{
+		PROFILE_FUNCTION();
+		auto &registry    = getRegistry();
+		auto  ticksPerUs  = registry.ticksPerMicrosecond();
+		auto  end         = now();
+		auto  windowTicks = static_cast<uint64_t>(seconds * 1000000.0 * ticksPerUs);
+		auto  from        = end > windowTicks ? end - windowTicks : 0;
+
+		//the same name can have several addresses, e.g. one literal per translation unit.
+		std::unordered_map<std::string_view, std::vector<double>> durations;
+		std::vector<Sample>                                       samples;
+		samples.reserve(BufferCapacity);
+
+		auto collect = [&](const ThreadBuffer &buffer) {
+			buffer.snapshot(samples);
+			for (auto &sample : samples)
+			{
+				if (sample.begin >= from && sample.begin >= registry.startTicks && sample.name != nullptr)
+					durations[sample.name].emplace_back((sample.end - sample.begin) / ticksPerUs);
+			}
+		};
+
+		{
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			collect(registry.frames);
+			for (auto &buffer : registry.buffers)
+				collect(*buffer);
+		}
+
+		std::ofstream out(path);
+		if (!out)
+		{
+			LOGE("can not write profile summary {0}", path);
+			return false;
+		}
+
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		out << "{\"seconds\":" << seconds << ",\"scopes\":[";
+		bool first = true;
+		for (auto &[name, times] : durations)
+		{
+			std::sort(times.begin(), times.end());
+			double total = 0;
+			for (auto time : times)
+				total += time;
+			auto percentile = [&](double p) { return times[std::min(times.size() - 1, static_cast<size_t>(p * times.size()))]; };
+
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			writeString(out, std::string(name).c_str());
+			out << ",\"count\":" << times.size() << ",\"total\":" << total << ",\"mean\":" << total / times.size()
+			    << ",\"p50\":" << percentile(0.5) << ",\"p99\":" << percentile(0.99) << ",\"max\":" << times.back() << '}';
+			first = false;
+		}
+		out << "\n]}\n";
+		return out.good();
+	}
+
+	auto CPUProfiler::setSpikeCapture(float thresholdMs, const std::string &prefix, double seconds) -> void
+	{
+		auto &registry          = getRegistry();
+		registry.spikeThreshold = thresholdMs;
+		registry.spikePrefix    = prefix;
+		registry.spikeSeconds   = seconds;
+	}
+
+	auto CPUProfiler::getLastFrameTime() -> float
+	{
+		return getRegistry().lastFrameTime.load(std::memory_order_relaxed);
+	}
+}        // namespace maple
@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#	include <x86intrin.h>
+#endif
+
+namespace maple
+{
+	/**
+	 * built-in scope profiler used by the PROFILE_ macros when Tracy is not linked.
+	 *
+	 * every thread records (name, begin, end) into its own ring buffer, only the owning thread
+	 * writes it and readers never block it. the last seconds of all threads can be written as
+	 * chrome trace json (chrome://tracing, perfetto) on demand or when a frame takes too long.
+	 * names have to outlive the profiler, string literals and __FUNCTION__ do.
+	 */
+	class CPUProfiler
+	{
+	  public:
+		static constexpr uint32_t BufferCapacity = 1 << 16;        //events per thread
+
+		static inline auto now() -> uint64_t
+		{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+			return __rdtsc();
+#else
+			return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+		}
+
+		static inline auto isEnabled()
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		static inline auto setEnabled(bool enable)
+		{
+			enabled.store(enable, std::memory_order_relaxed);
+		}
+
+		static auto record(const char *name, uint64_t begin, uint64_t end) -> void;
+		static auto setThreadName(const char *name) -> void;
+
+		/**
+		 * frame boundary, checks the frame time against the spike threshold.
+		 */
+		static auto frameMark() -> void;
+
+		/**
+		 * writes the last seconds of every thread, returns false if the file can not be written.
+		 */
+		static auto dump(const std::string &path, double seconds = 2.0) -> bool;
+
+		/**
+		 * per scope name statistics of the last seconds as json: count, total, mean, p50, p99 and max
+		 * in microseconds. meant for comparing runs of the same scenario between builds.
+		 */
+		static auto dumpSummary(const std::string &path, double seconds = 2.0) -> bool;
+
+		/**
+		 * frames longer than thresholdMs write <prefix><frame>.json with the last seconds, at most
+		 * once per capture window. a threshold of 0 disables it.
+		 */
+		static auto setSpikeCapture(float thresholdMs, const std::string &prefix = "spike_", double seconds = 2.0) -> void;
+
+		static auto getLastFrameTime() -> float;
+
+	  private:
+		static std::atomic<bool> enabled;
+	};
+
+	class CPUProfileScope
+	{
+	  public:
+		inline CPUProfileScope(const char *name) :
+		    name(name), begin(CPUProfiler::isEnabled() ? CPUProfiler::now() : 0)
+		{
+		}
+
+		inline ~CPUProfileScope()
+		{
+			if (begin != 0)
+				CPUProfiler::record(name, begin, CPUProfiler::now());
+		}
+
+	  private:
+		const char *name;
+		uint64_t    begin;
+	};
+}        // namespace maple
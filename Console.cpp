@@ -3,25 +3,68 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "Console.h"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <algorithm>
+
 namespace maple
 {
-	auto Console::init() -> void
+	auto Console::init(const ConsoleOptions &options) -> void
 	{
 		std::vector<spdlog::sink_ptr> logSinks;
 		logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
-		logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>("Maple.log", true));
+		logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(options.file, true));
 
 		logSinks[0]->set_pattern("%^[%T] %n: %v%$");
 		logSinks[1]->set_pattern("[%T] [%l] %n: %v");
 
-		logger = std::make_shared<spdlog::logger>("Maple", begin(logSinks), end(logSinks));
+		if (options.async)
+		{
+			//one writer thread keeps the order of the messages.
+			spdlog::init_thread_pool(options.queueSize, 1);
+			auto policy = options.overflow == ConsoleOptions::Overflow::Block ? spdlog::async_overflow_policy::block : spdlog::async_overflow_policy::overrun_oldest;
+			logger      = std::make_shared<spdlog::async_logger>("Maple", begin(logSinks), end(logSinks), spdlog::thread_pool(), policy);
+		}
+		else
+		{
+			logger = std::make_shared<spdlog::logger>("Maple", begin(logSinks), end(logSinks));
+		}
+
 		spdlog::register_logger(logger);
 		logger->set_level(spdlog::level::trace);
-		logger->flush_on(spdlog::level::trace);
+		logger->flush_on(std::min(options.flushLevel, spdlog::level::err));
+
+		if (options.flushEvery > 0)
+			spdlog::flush_every(std::chrono::seconds(options.flushEvery));
 	}
+
+	auto Console::shutdown() -> void
+	{
+		if (logger == nullptr)
+			return;
+
+		logger->flush();
+		auto sinks = logger->sinks();
+		auto level = logger->flush_level();
+		spdlog::drop(logger->name());
+		//joins the writer thread after the queue is drained.
+		spdlog::shutdown();
+
+		//destructors running after the teardown may still log.
+		logger = std::make_shared<spdlog::logger>("Maple", begin(sinks), end(sinks));
+		logger->set_level(spdlog::level::trace);
+		logger->flush_on(level);
+	}
+
+	auto Console::getDroppedMessages() -> size_t
+	{
+		if (auto pool = spdlog::thread_pool(); pool != nullptr)
+			return pool->overrun_counter();
+		return 0;
+	}
+
 	std::shared_ptr<spdlog::logger> Console::logger;
 
 };        // namespace maple
@@ -11,11 +11,39 @@ struct lua_State;
 
 namespace maple
 {
+	struct ConsoleOptions
+	{
+		enum class Overflow
+		{
+			Block,             //the calling thread waits for a free slot
+			DropOldest         //the oldest queued message is overwritten
+		};
+
+		/**
+		 * formatting happens on the caller, writing and flushing on a background thread.
+		 * off by default, messages still queued when the process dies are lost.
+		 */
+		bool                      async      = false;
+		size_t                    queueSize  = 8192;
+		Overflow                  overflow   = Overflow::Block;
+		spdlog::level::level_enum flushLevel = spdlog::level::warn;        //errors and criticals always flush
+		uint32_t                  flushEvery = 1;        //seconds, 0 disables the periodic flush
+		std::string               file       = "Maple.log";
+	};
 
 	class Console
 	{
 	public:
-		static auto  init() -> void;
+		static auto  init(const ConsoleOptions &options = {}) -> void;
+		/**
+		 * drains and flushes the queue. messages logged afterwards are written synchronously.
+		 * called by whoever called init, it also shuts down spdlog for the whole process.
+		 */
+		static auto  shutdown() -> void;
+		/**
+		 * messages lost to a full queue with Overflow::DropOldest.
+		 */
+		static auto  getDroppedMessages() -> size_t;
 		static auto& getLogger()
 		{
 			return logger;
@@ -26,9 +54,39 @@ namespace maple
 	};
 };        // namespace maple
 
-#define LOGV(...) maple::Console::getLogger()->trace(__VA_ARGS__)
-#define LOGI(...) maple::Console::getLogger()->info(__VA_ARGS__)
-#define LOGW(...) maple::Console::getLogger()->warn(__VA_ARGS__)
+//levels below MAPLE_LOG_LEVEL compile to nothing, arguments are not evaluated.
+#define MAPLE_LOG_LEVEL_TRACE 0
+#define MAPLE_LOG_LEVEL_INFO 1
+#define MAPLE_LOG_LEVEL_WARN 2
+#define MAPLE_LOG_LEVEL_ERROR 3
+#define MAPLE_LOG_LEVEL_CRITICAL 4
+
+#ifndef MAPLE_LOG_LEVEL
+#	ifdef NDEBUG
+#		define MAPLE_LOG_LEVEL MAPLE_LOG_LEVEL_INFO
+#	else
+#		define MAPLE_LOG_LEVEL MAPLE_LOG_LEVEL_TRACE
+#	endif
+#endif
+
+#if MAPLE_LOG_LEVEL <= MAPLE_LOG_LEVEL_TRACE
+#	define LOGV(...) maple::Console::getLogger()->trace(__VA_ARGS__)
+#else
+#	define LOGV(...) (void) 0
+#endif
+
+#if MAPLE_LOG_LEVEL <= MAPLE_LOG_LEVEL_INFO
+#	define LOGI(...) maple::Console::getLogger()->info(__VA_ARGS__)
+#else
+#	define LOGI(...) (void) 0
+#endif
+
+#if MAPLE_LOG_LEVEL <= MAPLE_LOG_LEVEL_WARN
+#	define LOGW(...) maple::Console::getLogger()->warn(__VA_ARGS__)
+#else
+#	define LOGW(...) (void) 0
+#endif
+
 #define LOGE(...) maple::Console::getLogger()->error(__VA_ARGS__)
 #define LOGC(...) maple::Console::getLogger()->critical(__VA_ARGS__)
 
@@ -51,6 +109,22 @@ namespace maple
 #	define PROFILE_LOCKMARKER(var) LockMark(var)
 #	define PROFILE_SETTHREADNAME(name) tracy::SetThreadName(name)
 
+#elif !defined(MAPLE_DISABLE_CPU_PROFILE)
+#	include "CPUProfiler.h"
+#	define MAPLE_PROFILE_CONCAT_IMPL(a, b) a##b
+#	define MAPLE_PROFILE_CONCAT(a, b) MAPLE_PROFILE_CONCAT_IMPL(a, b)
+#	if defined(_MSC_VER)
+#		define MAPLE_PROFILE_FUNCTION_NAME __FUNCTION__
+#	else
+#		define MAPLE_PROFILE_FUNCTION_NAME __PRETTY_FUNCTION__
+#	endif
+#	define PROFILE_SCOPE(name) ::maple::CPUProfileScope MAPLE_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#	define PROFILE_FUNCTION() ::maple::CPUProfileScope MAPLE_PROFILE_CONCAT(cpuProfileScope, __LINE__)(MAPLE_PROFILE_FUNCTION_NAME)
+#	define PROFILE_FRAMEMARKER() ::maple::CPUProfiler::frameMark()
+#	define PROFILE_LOCK(type, var, name) type var
+#	define PROFILE_LOCKMARKER(var)
+#	define PROFILE_SETTHREADNAME(name) ::maple::CPUProfiler::setThreadName(name)
+
 #else
 #	define PROFILE_SCOPE(name)
 #	define PROFILE_FUNCTION()
@@ -167,6 +167,13 @@ namespace maple
 		uint64_t size;
 	};
 
+	struct BufferUpdate
+	{
+		const void *data;
+		uint32_t    size;
+		uint32_t    offset;
+	};
+
 	struct TextureParameters
 	{
 		TextureFormat format;
@@ -294,7 +301,8 @@ namespace maple
 		Depth_Stencil_Read_Only_Optimal,
 		Shader_Read_Only_Optimal,
 		Transfer_Dst_Optimal,
-		Present_Src
+		Present_Src,
+		Transfer_Src_Optimal
 	};
 
 	enum RendererBufferType
@@ -403,6 +411,7 @@ namespace maple
 		uint32_t    groupCountY = 1;
 		uint32_t    groupCountZ = 1;
 		uint32_t    maxRayRecursionDepth = 2;
+		uint32_t    hitRecordDataSize = 0;        //bytes of shader record data per hit record
 		std::string pipelineName;
 		int32_t		faceId = -1;
 	};
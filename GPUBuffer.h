@@ -23,5 +23,21 @@ namespace maple
 		{
 			return nullptr;
 		};
+
+		/**
+		 * start of the data inside handle(), non zero for sub-allocated buffers.
+		 */
+		virtual auto getOffset() const -> uint64_t
+		{
+			return 0;
+		};
+
+		/**
+		 * bytes starting at getOffset() which belong to this buffer, 0 if it owns all of handle().
+		 */
+		virtual auto getRange() const -> uint64_t
+		{
+			return 0;
+		};
 	};
 };        // namespace maple
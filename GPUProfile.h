@@ -2,15 +2,13 @@
 // This file is part of the Maple Engine                              		//
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
-#include "RHI/GraphicsContext.h"
+#include "GPUProfiler.h"
 
-#if defined(RENDER_API_VULKAN)
-#	include "RHI/Vulkan/VKCommandBuffer.h"
-#	include "RHI/Vulkan/VKDevice.h"
-#endif
+#define MAPLE_GPU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MAPLE_GPU_PROFILE_CONCAT(a, b) MAPLE_GPU_PROFILE_CONCAT_IMPL(a, b)
 
-#if defined(PROFILE_GPU) && defined(RENDER_API_VULKAN) && defined(MAPLE_PROFILE) && defined(TRACY_ENABLE)
-#	define GPUProfile(name)
+#if !defined(MAPLE_DISABLE_GPU_PROFILE)
+#	define GPUProfile(cmd, name) ::maple::GPUProfileScope MAPLE_GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(cmd, name)
 #else
-#	define GPUProfile(name)
+#	define GPUProfile(cmd, name)
 #endif
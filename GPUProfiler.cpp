@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "GPUProfiler.h"
+#include "GraphicsContext.h"
+#include <imgui.h>
+
+#ifdef MAPLE_VULKAN
+#	include "Vulkan/VulkanGPUProfiler.h"
+#endif        // MAPLE_VULKAN
+
+namespace maple
+{
+	namespace
+	{
+		//returns the index after the subtree of the node.
+		auto drawNode(const std::vector<GPUProfileNode> &nodes, uint32_t index, bool statistics) -> uint32_t
+		{
+			auto &node = nodes[index];
+			auto  next = index + 1;
+			auto  leaf = next >= nodes.size() || nodes[next].depth <= node.depth;
+
+			ImGui::PushID(index);
+			auto flags = leaf ? ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen : ImGuiTreeNodeFlags_DefaultOpen;
+			auto open  = ImGui::TreeNodeEx(node.name.c_str(), flags);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", node.time);
+			ImGui::NextColumn();
+			if (statistics)
+			{
+				if (node.hasStatistics)
+				{
+					ImGui::Text("%llu", (unsigned long long) node.statistics.inputAssemblyPrimitives);
+					ImGui::NextColumn();
+					ImGui::Text("%llu", (unsigned long long) node.statistics.fragmentShaderInvocations);
+					ImGui::NextColumn();
+					ImGui::Text("%llu", (unsigned long long) node.statistics.computeShaderInvocations);
+					ImGui::NextColumn();
+				}
+				else
+				{
+					ImGui::NextColumn();
+					ImGui::NextColumn();
+					ImGui::NextColumn();
+				}
+			}
+			ImGui::PopID();
+
+			while (next < nodes.size() && nodes[next].depth > node.depth)
+			{
+				if (open && !leaf)
+					next = drawNode(nodes, next, statistics);
+				else
+					next++;
+			}
+
+			if (open && !leaf)
+				ImGui::TreePop();
+			return next;
+		}
+	}        // namespace
+
+	auto GPUProfiler::create() -> Ptr
+	{
+#ifdef MAPLE_VULKAN
+		return std::make_shared<VulkanGPUProfiler>();
+#else
+		return nullptr;
+#endif        // MAPLE_VULKAN
+	}
+
+	auto GPUProfiler::onImGui() -> void
+	{
+		if (!ImGui::Begin("GPU Profiler"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		ImGui::Checkbox("Enabled", &enabled);
+		if (isPipelineStatisticsSupported())
+		{
+			ImGui::SameLine();
+			ImGui::Checkbox("Pipeline Statistics", &pipelineStatistics);
+		}
+		ImGui::Text("Frame %llu : %.3f ms", (unsigned long long) lastFrame.frame, lastFrame.time);
+		ImGui::Text("Binds (issued / skipped) : pipelines %u / %u, sets %u / %u, push constants %u / %u",
+		            bindStatistics.pipelines, bindStatistics.pipelinesSkipped,
+		            bindStatistics.descriptorSets, bindStatistics.descriptorSetsSkipped,
+		            bindStatistics.pushConstants, bindStatistics.pushConstantsSkipped);
+		ImGui::Separator();
+
+		if (!lastFrame.nodes.empty())
+		{
+			auto statistics = pipelineStatistics;
+			ImGui::Columns(statistics ? 5 : 2, "GPUProfilerColumns");
+			ImGui::Text("Scope");
+			ImGui::NextColumn();
+			ImGui::Text("ms");
+			ImGui::NextColumn();
+			if (statistics)
+			{
+				ImGui::Text("Primitives");
+				ImGui::NextColumn();
+				ImGui::Text("Fragments");
+				ImGui::NextColumn();
+				ImGui::Text("Compute");
+				ImGui::NextColumn();
+			}
+			ImGui::Separator();
+			drawNode(lastFrame.nodes, 0, statistics);
+			ImGui::Columns(1);
+		}
+		ImGui::End();
+	}
+
+	GPUProfileScope::GPUProfileScope(const CommandBuffer *cmd, const char *name) :
+	    cmd(cmd)
+	{
+		if (auto &gpuProfiler = GraphicsContext::get()->getGPUProfiler())
+		{
+			profiler = gpuProfiler.get();
+			profiler->begin(cmd, name);
+		}
+	}
+
+	GPUProfileScope::~GPUProfileScope()
+	{
+		if (profiler != nullptr)
+			profiler->end(cmd);
+	}
+}        // namespace maple
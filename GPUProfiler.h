@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+
+	struct GPUPipelineStatistics
+	{
+		uint64_t inputAssemblyVertices     = 0;
+		uint64_t inputAssemblyPrimitives   = 0;
+		uint64_t vertexShaderInvocations   = 0;
+		uint64_t clippingInvocations       = 0;
+		uint64_t clippingPrimitives        = 0;
+		uint64_t fragmentShaderInvocations = 0;
+		uint64_t computeShaderInvocations  = 0;
+	};
+
+	/**
+	 * binds recorded into the frame command buffer and binds skipped because the state was already bound.
+	 */
+	struct GPUBindStatistics
+	{
+		uint32_t pipelines             = 0;
+		uint32_t pipelinesSkipped      = 0;
+		uint32_t descriptorSets        = 0;
+		uint32_t descriptorSetsSkipped = 0;
+		uint32_t pushConstants         = 0;
+		uint32_t pushConstantsSkipped  = 0;
+	};
+
+	struct GPUProfileNode
+	{
+		std::string           name;
+		uint32_t              depth         = 0;
+		int32_t               parent        = -1;
+		double                begin         = 0;        //ms since the frame started on the GPU
+		double                time          = 0;        //ms
+		bool                  hasStatistics = false;
+		GPUPipelineStatistics statistics;
+	};
+
+	struct GPUProfileFrame
+	{
+		uint64_t frame = 0;
+		double   time  = 0;
+		/**
+		 * pre-order, the first node is the whole frame and every node is followed by its children.
+		 */
+		std::vector<GPUProfileNode> nodes;
+	};
+
+	/**
+	 * timestamp queries around nested scopes of the frame command buffer. queries are written into
+	 * per-frame pools and read back when the pool comes around again, so results are a few frames
+	 * old but reading them never waits for the GPU.
+	 */
+	class GPUProfiler
+	{
+	  public:
+		using Ptr = std::shared_ptr<GPUProfiler>;
+
+		static constexpr uint32_t MaxScopes = 256;
+
+		static auto create() -> Ptr;
+
+		virtual ~GPUProfiler() = default;
+
+		/**
+		 * called by the swap chain around the recording of the frame command buffer.
+		 */
+		virtual auto beginFrame(const CommandBuffer *cmd) -> void = 0;
+		virtual auto endFrame(const CommandBuffer *cmd) -> void   = 0;
+
+		/**
+		 * scopes on other command buffers than the frame one, or while the profiler is disabled, are ignored.
+		 * enabling only takes effect with the next frame.
+		 */
+		virtual auto begin(const CommandBuffer *cmd, const char *name) -> void = 0;
+		virtual auto end(const CommandBuffer *cmd) -> void                     = 0;
+
+		/**
+		 * the latest frame which was resolved.
+		 */
+		inline auto &getLastFrame() const
+		{
+			return lastFrame;
+		}
+
+		/**
+		 * counted on the CPU while recording, so unlike the timings these belong to the last recorded frame.
+		 */
+		inline auto &getBindStatistics() const
+		{
+			return bindStatistics;
+		}
+
+		inline auto setEnabled(bool enabled)
+		{
+			this->enabled = enabled;
+		}
+
+		inline auto isEnabled() const
+		{
+			return enabled;
+		}
+
+		/**
+		 * pipeline statistics can not nest, they are collected for the outermost scope below the frame.
+		 */
+		inline auto setPipelineStatistics(bool statistics)
+		{
+			pipelineStatistics = statistics && isPipelineStatisticsSupported();
+		}
+
+		inline auto isPipelineStatisticsEnabled() const
+		{
+			return pipelineStatistics;
+		}
+
+		virtual auto isPipelineStatisticsSupported() const -> bool
+		{
+			return false;
+		}
+
+		auto onImGui() -> void;
+
+	  protected:
+		GPUProfileFrame   lastFrame;
+		GPUBindStatistics bindStatistics;
+		bool              enabled            = true;
+		bool              pipelineStatistics = false;
+	};
+
+	class GPUProfileScope
+	{
+	  public:
+		GPUProfileScope(const CommandBuffer *cmd, const char *name);
+		~GPUProfileScope();
+
+	  private:
+		const CommandBuffer *cmd;
+		GPUProfiler *        profiler = nullptr;
+	};
+}        // namespace maple
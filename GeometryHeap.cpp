@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "GeometryHeap.h"
+#include "Console.h"
+#include <algorithm>
+
+#ifdef MAPLE_VULKAN
+#	include "Vulkan/VulkanGeometryHeap.h"
+#endif        // MAPLE_VULKAN
+
+namespace maple
+{
+	auto GeometryHeap::create(uint64_t pageSize) -> Ptr
+	{
+#ifdef MAPLE_VULKAN
+		return std::make_shared<VulkanGeometryHeap>(pageSize);
+#else
+		return nullptr;
+#endif        // MAPLE_VULKAN
+	}
+
+	GeometryHeap::GeometryHeap(uint64_t pageSize) :
+	    pageSize(pageSize)
+	{
+	}
+
+	auto GeometryHeap::allocate(uint64_t size, uint64_t alignment) -> GeometryAllocation
+	{
+		PROFILE_FUNCTION();
+		for (uint32_t i = 0; i < allocators.size(); i++)
+		{
+			if (auto allocation = allocators[i].allocate(size, alignment); allocation.isValid())
+			{
+				return {i, allocation.node, allocation.offset, allocation.size};
+			}
+		}
+
+		//oversized requests get a page of their own.
+		auto capacity = std::max(pageSize, size + alignment);
+		createPage(capacity);
+		auto &allocator  = allocators.emplace_back(capacity);
+		auto  allocation = allocator.allocate(size, alignment);
+		MAPLE_ASSERT(allocation.isValid(), "geometry heap allocation failed");
+		LOGI("geometry heap page {0} created, {1} bytes", allocators.size() - 1, capacity);
+		return {static_cast<uint32_t>(allocators.size() - 1), allocation.node, allocation.offset, allocation.size};
+	}
+
+	auto GeometryHeap::free(const GeometryAllocation &allocation) -> void
+	{
+		release(allocation);
+	}
+
+	auto GeometryHeap::release(const GeometryAllocation &allocation) -> void
+	{
+		if (allocation.isValid())
+		{
+			MAPLE_ASSERT(allocation.page < allocators.size(), "allocation from another heap");
+			allocators[allocation.page].free(allocation.node);
+		}
+	}
+
+	auto GeometryHeap::getPage(const GPUBuffer *buffer) const -> int32_t
+	{
+		for (uint32_t i = 0; i < allocators.size(); i++)
+		{
+			if (getPageHandle(i) == buffer->handle())
+				return i;
+		}
+		return -1;
+	}
+
+	auto GeometryHeap::getStatistics() const -> Statistics
+	{
+		Statistics statistics;
+		statistics.pages = static_cast<uint32_t>(allocators.size());
+		for (auto &allocator : allocators)
+		{
+			statistics.allocations += allocator.getAllocationCount();
+			statistics.capacity += allocator.getSize();
+			statistics.used += allocator.getUsed();
+		}
+		return statistics;
+	}
+}        // namespace maple
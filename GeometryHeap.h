@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "IndexBuffer.h"
+#include "OffsetAllocator.h"
+#include "VertexBuffer.h"
+#include <memory>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+
+	struct GeometryAllocation
+	{
+		uint32_t page   = UINT32_MAX;
+		uint32_t node   = OffsetAllocator::InvalidNode;
+		uint64_t offset = 0;
+		uint64_t size   = 0;
+
+		inline auto isValid() const
+		{
+			return node != OffsetAllocator::InvalidNode;
+		}
+	};
+
+	/**
+	 * a few large device local buffers which hold the vertex, index and storage data of many
+	 * meshes. everything in one page can be drawn with one vertex/index binding, using the
+	 * allocation offsets as vertexOffset and firstIndex.
+	 */
+	class GeometryHeap : public std::enable_shared_from_this<GeometryHeap>
+	{
+	  public:
+		using Ptr = std::shared_ptr<GeometryHeap>;
+
+		struct Statistics
+		{
+			uint32_t pages       = 0;
+			uint32_t allocations = 0;
+			uint64_t capacity    = 0;
+			uint64_t used        = 0;
+		};
+
+		static auto create(uint64_t pageSize = 64 * 1024 * 1024) -> Ptr;
+
+		GeometryHeap(uint64_t pageSize);
+		virtual ~GeometryHeap() = default;
+
+		/**
+		 * alignment can be any value, use the vertex stride for vertices so that
+		 * offset / stride is a valid vertexOffset.
+		 */
+		auto allocate(uint64_t size, uint64_t alignment = 4) -> GeometryAllocation;
+
+		/**
+		 * the range is reused once the GPU is done with the current frame.
+		 */
+		virtual auto free(const GeometryAllocation &allocation) -> void;
+
+		/**
+		 * sub-allocated buffers, they return their range to the heap when destroyed.
+		 */
+		virtual auto createVertexBuffer(const void *data, uint32_t size, uint32_t stride) -> VertexBuffer::Ptr = 0;
+		virtual auto createIndexBuffer(const uint16_t *data, uint32_t count) -> IndexBuffer::Ptr              = 0;
+		virtual auto createIndexBuffer(const uint32_t *data, uint32_t count) -> IndexBuffer::Ptr              = 0;
+
+		/**
+		 * offsets of the updates are relative to the allocation.
+		 */
+		virtual auto write(const GeometryAllocation &allocation, const std::vector<BufferUpdate> &updates) -> void = 0;
+
+		virtual auto bindVertexBuffer(const CommandBuffer *cmd, uint32_t page, uint32_t binding = 0) const -> void = 0;
+		virtual auto bindIndexBuffer(const CommandBuffer *cmd, uint32_t page, bool uint16Index) const -> void        = 0;
+		virtual auto getAddress(const GeometryAllocation &allocation) const -> uint64_t                               = 0;
+
+		/**
+		 * page a buffer created by this heap lives in, -1 for foreign buffers.
+		 */
+		auto getPage(const GPUBuffer *buffer) const -> int32_t;
+
+		auto getStatistics() const -> Statistics;
+
+		inline auto getPageSize() const
+		{
+			return pageSize;
+		}
+
+		static inline auto getFirstIndex(const GPUBuffer *indexBuffer, uint32_t indexSize)
+		{
+			return static_cast<uint32_t>(indexBuffer->getOffset() / indexSize);
+		}
+
+		static inline auto getVertexOffset(const GPUBuffer *vertexBuffer, uint32_t stride)
+		{
+			return static_cast<int32_t>(vertexBuffer->getOffset() / stride);
+		}
+
+	  protected:
+		/**
+		 * backend creates the buffer of a new page with the given size.
+		 */
+		virtual auto createPage(uint64_t size) -> void                    = 0;
+		virtual auto getPageHandle(uint32_t page) const -> void *         = 0;
+		auto         release(const GeometryAllocation &allocation) -> void;
+
+		uint64_t                     pageSize;
+		std::vector<OffsetAllocator> allocators;
+	};
+}        // namespace maple
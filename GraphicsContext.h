@@ -27,6 +27,7 @@ namespace maple
 	class FrameBuffer;
 	class Shader;
 	class Sampler;
+	class GPUProfiler;
 
 	struct Caps {
 		int32_t maxSamples = 0;
@@ -79,6 +80,13 @@ namespace maple
 
 		inline auto &getCaps() const { return caps; }
 
+		inline auto &getGPUProfiler() const { return gpuProfiler; }
+
+		/**
+		 * initialized without a native window, frames are rendered into offscreen images.
+		 */
+		inline auto isHeadless() const { return headless; }
+
 		auto clearUnused() -> void;
 
 	protected:
@@ -87,5 +95,7 @@ namespace maple
 		std::unordered_map<std::size_t, CacheAsset<FrameBuffer>> frameBufferCache;
 		std::unordered_map<std::size_t, std::shared_ptr<Sampler>> samplerCache;
 		Caps caps;
+		std::shared_ptr<GPUProfiler> gpuProfiler;
+		bool headless = false;
 	};
 } // namespace maple
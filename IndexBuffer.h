@@ -4,6 +4,7 @@
 #pragma once
 #include "BufferUsage.h"
 #include "GPUBuffer.h"
+#include <vector>
 
 namespace maple
 {
@@ -21,6 +22,8 @@ namespace maple
 		virtual auto setCount(uint32_t indexCount) -> void                            = 0;
 		virtual auto setData(const uint16_t* data, uint32_t count) -> void = 0;
 		virtual auto setData(const uint32_t* data, uint32_t count) -> void = 0;
+		virtual auto setDataSub(uint32_t size, const void *data, uint32_t offset) -> void = 0;
+		virtual auto setDataSub(const std::vector<BufferUpdate> &updates) -> void         = 0;
 
 		virtual auto releasePointer() -> void{};
 
@@ -29,6 +32,11 @@ namespace maple
 			return 0;
 		}
 
+		virtual auto getCapacity() const -> uint64_t
+		{
+			return 0;
+		}
+
 		template <typename T>
 		inline auto getPointer()
 		{
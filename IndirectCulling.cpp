@@ -0,0 +1,261 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "IndirectCulling.h"
+#include "Console.h"
+#include "DescriptorSet.h"
+#include "Pipeline.h"
+#include "RenderDevice.h"
+#include "Shader.h"
+#include "ShaderCompiler.h"
+#include "StorageBuffer.h"
+#include "Textures.h"
+#include <cmath>
+
+namespace maple
+{
+	namespace
+	{
+		constexpr uint32_t LocalSize = 64;
+
+		constexpr const char *CullingShader = R"(
+#version 450
+layout(local_size_x = 64) in;
+
+struct DrawCommand
+{
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int  vertexOffset;
+	uint firstInstance;
+};
+
+struct Instance
+{
+	vec4 boundingSphere;
+	uint drawIndex;
+	uint instanceId;
+	uint padding0;
+	uint padding1;
+};
+
+layout(set = 0, binding = 0) uniform UniformBufferObject
+{
+	mat4 viewProj;
+	vec4 planes[6];
+	vec4 pyramidSize;
+	uint instanceCount;
+	uint occlusion;
+	uint reverseZ;
+	uint compact;
+};
+
+layout(set = 0, binding = 1) readonly buffer Instances { Instance instances[]; };
+layout(set = 0, binding = 2) readonly buffer SourceDraws { DrawCommand sourceDraws[]; };
+layout(set = 0, binding = 3) writeonly buffer CompactedDraws { DrawCommand compactedDraws[]; };
+layout(set = 0, binding = 4) buffer DrawCount { uint drawCount; };
+layout(set = 0, binding = 5) uniform sampler2D uDepthPyramid;
+
+bool frustumVisible(vec4 sphere)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(planes[i].xyz, sphere.xyz) + planes[i].w < -sphere.w)
+			return false;
+	}
+	return true;
+}
+
+bool occlusionVisible(vec4 sphere)
+{
+	vec2  minUV   = vec2(1.0);
+	vec2  maxUV   = vec2(0.0);
+	float nearest = reverseZ != 0 ? 0.0 : 1.0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		vec3 corner = sphere.xyz + sphere.w * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip   = viewProj * vec4(corner, 1.0);
+		//crosses the camera plane, cannot be tested conservatively.
+		if (clip.w <= 0.0)
+			return true;
+		vec3 ndc = clip.xyz / clip.w;
+		vec2 uv  = ndc.xy * 0.5 + 0.5;
+		minUV    = min(minUV, uv);
+		maxUV    = max(maxUV, uv);
+		nearest  = reverseZ != 0 ? max(nearest, ndc.z) : min(nearest, ndc.z);
+	}
+
+	minUV = clamp(minUV, vec2(0.0), vec2(1.0));
+	maxUV = clamp(maxUV, vec2(0.0), vec2(1.0));
+
+	vec2  extent = (maxUV - minUV) * pyramidSize.xy;
+	float level  = clamp(ceil(log2(max(max(extent.x, extent.y), 1.0))), 0.0, pyramidSize.z - 1.0);
+
+	//four taps at that level cover the whole rectangle, keep the farthest depth.
+	float d0 = textureLod(uDepthPyramid, vec2(minUV.x, minUV.y), level).x;
+	float d1 = textureLod(uDepthPyramid, vec2(maxUV.x, minUV.y), level).x;
+	float d2 = textureLod(uDepthPyramid, vec2(minUV.x, maxUV.y), level).x;
+	float d3 = textureLod(uDepthPyramid, vec2(maxUV.x, maxUV.y), level).x;
+
+	if (reverseZ != 0)
+		return nearest >= min(min(d0, d1), min(d2, d3));
+	return nearest <= max(max(d0, d1), max(d2, d3));
+}
+
+void main()
+{
+	uint id = gl_GlobalInvocationID.x;
+	if (id >= instanceCount)
+		return;
+
+	Instance instance = instances[id];
+	bool     visible  = frustumVisible(instance.boundingSphere);
+	if (visible && occlusion != 0)
+		visible = occlusionVisible(instance.boundingSphere);
+
+	DrawCommand draw   = sourceDraws[instance.drawIndex];
+	draw.instanceCount = 1;
+	draw.firstInstance = instance.instanceId;
+
+	if (compact != 0)
+	{
+		if (visible)
+			compactedDraws[atomicAdd(drawCount, 1)] = draw;
+	}
+	else
+	{
+		draw.instanceCount  = visible ? 1 : 0;
+		compactedDraws[id]  = draw;
+	}
+}
+)";
+
+		struct CullingUniform
+		{
+			mat4     viewProj;
+			vec4     planes[6];
+			vec4     pyramidSize;
+			uint32_t instanceCount;
+			uint32_t occlusion;
+			uint32_t reverseZ;
+			uint32_t compact;
+		};
+
+		inline auto row(const mat4 &m, int32_t i) -> vec4
+		{
+			auto get = [&](const vec4 &v) { return i == 0 ? v.x : i == 1 ? v.y : i == 2 ? v.z : v.w; };
+			return {get(m.col[0]), get(m.col[1]), get(m.col[2]), get(m.col[3])};
+		}
+
+		inline auto normalize(const vec4 &a, const vec4 &b, float sign) -> vec4
+		{
+			vec4 p   = {a.x + sign * b.x, a.y + sign * b.y, a.z + sign * b.z, a.w + sign * b.w};
+			auto len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+			return len > 0 ? vec4{p.x / len, p.y / len, p.z / len, p.w / len} : p;
+		}
+
+		//planes point inwards, depth range is [0, 1] so the near plane is the third row alone.
+		inline auto extractPlanes(const mat4 &viewProj, vec4 *planes)
+		{
+			const vec4 zero = {0, 0, 0, 0};
+			auto       r0 = row(viewProj, 0), r1 = row(viewProj, 1), r2 = row(viewProj, 2), r3 = row(viewProj, 3);
+			planes[0] = normalize(r3, r0, 1.f);
+			planes[1] = normalize(r3, r0, -1.f);
+			planes[2] = normalize(r3, r1, 1.f);
+			planes[3] = normalize(r3, r1, -1.f);
+			planes[4] = normalize(r2, zero, 1.f);
+			planes[5] = normalize(r3, r2, -1.f);
+		}
+	}        // namespace
+
+	IndirectCulling::IndirectCulling(uint32_t maxInstances) :
+	    maxInstances(maxInstances)
+	{
+		PROFILE_FUNCTION();
+		std::vector<uint32_t> spirv;
+		if (!ShaderCompiler::complie(ShaderType::Compute, CullingShader, spirv, ""))
+		{
+			LOGC("compile indirect culling shader failed");
+		}
+
+		shader = Shader::create(spirv);
+
+		PipelineInfo info;
+		info.shader       = shader;
+		info.pipelineName = "IndirectCulling";
+		pipeline          = Pipeline::get(info);
+		descriptorSet     = DescriptorSet::create({0, shader.get()});
+
+		compact     = RenderDevice::get()->isDrawIndirectCountSupported();
+		drawBuffer  = StorageBuffer::create(sizeof(DrawIndexedIndirectCommand) * maxInstances, nullptr, BufferOptions{true, MEMORY_USAGE_GPU_ONLY});
+		countBuffer = StorageBuffer::create(sizeof(uint32_t), nullptr, BufferOptions{true, MEMORY_USAGE_GPU_ONLY});
+	}
+
+	auto IndirectCulling::setInstances(const std::shared_ptr<StorageBuffer> &instances, uint32_t count) -> void
+	{
+		MAPLE_ASSERT(count <= maxInstances, "too many instances for indirect culling");
+		this->instances = instances;
+		instanceCount   = count;
+	}
+
+	auto IndirectCulling::setDrawCommands(const std::shared_ptr<StorageBuffer> &drawCommands) -> void
+	{
+		this->drawCommands = drawCommands;
+	}
+
+	auto IndirectCulling::setDepthPyramid(const std::shared_ptr<Texture> &pyramid, bool reverseZ) -> void
+	{
+		depthPyramid   = pyramid;
+		this->reverseZ = reverseZ;
+	}
+
+	auto IndirectCulling::cull(const CommandBuffer *cmd, const mat4 &viewProj) -> void
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(instances != nullptr && drawCommands != nullptr, "instances and draw commands must be set before cull");
+		auto device = RenderDevice::get();
+
+		CullingUniform ubo{};
+		ubo.viewProj = viewProj;
+		extractPlanes(viewProj, ubo.planes);
+		ubo.instanceCount = instanceCount;
+		ubo.occlusion     = depthPyramid != nullptr ? 1 : 0;
+		ubo.reverseZ      = reverseZ ? 1 : 0;
+		ubo.compact       = compact ? 1 : 0;
+		if (depthPyramid != nullptr)
+		{
+			ubo.pyramidSize = {(float) depthPyramid->getWidth(), (float) depthPyramid->getHeight(), (float) depthPyramid->getMipMapLevels(), 0};
+		}
+
+		descriptorSet->setUniform("UniformBufferObject", &ubo);
+		descriptorSet->setStorageBuffer("Instances", instances);
+		descriptorSet->setStorageBuffer("SourceDraws", drawCommands);
+		descriptorSet->setStorageBuffer("CompactedDraws", drawBuffer);
+		descriptorSet->setStorageBuffer("DrawCount", countBuffer);
+		descriptorSet->setTexture("uDepthPyramid", depthPyramid != nullptr ? depthPyramid : Texture2D::getTexture1X1White());
+
+		//the previous frame's draws have to be done with both buffers before they are rewritten.
+		device->bufferMemoryBarrier(cmd, ShaderType::DrawIndirect, ShaderType::TransferStage,
+		                            {{AccessFlags::Read, AccessFlags::Write, countBuffer.get()}});
+		device->clear(countBuffer, 0, cmd);
+		device->bufferMemoryBarrier(cmd, ShaderType::TransferStage, ShaderType::Compute,
+		                            {{AccessFlags::Write, AccessFlags::ReadWrite, countBuffer.get()}});
+		device->bufferMemoryBarrier(cmd, ShaderType::DrawIndirect, ShaderType::Compute,
+		                            {{AccessFlags::Read, AccessFlags::Write, drawBuffer.get()}});
+
+		device->dispatch(cmd, (instanceCount + LocalSize - 1) / LocalSize, 1, 1, pipeline.get(), nullptr, {descriptorSet});
+
+		device->bufferMemoryBarrier(cmd, ShaderType::Compute, ShaderType::DrawIndirect,
+		                            {{AccessFlags::Write, AccessFlags::Read, drawBuffer.get()},
+		                             {AccessFlags::ReadWrite, AccessFlags::Read, countBuffer.get()}});
+	}
+
+	auto IndirectCulling::draw(const CommandBuffer *cmd, Pipeline *pipeline) -> void
+	{
+		PROFILE_FUNCTION();
+		//falls back to instanceCount plain draws when the count can not be read on the GPU.
+		pipeline->drawIndexedIndirectCount(cmd, drawBuffer.get(), countBuffer.get(), instanceCount, sizeof(DrawIndexedIndirectCommand));
+	}
+}        // namespace maple
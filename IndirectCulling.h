@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Definitions.h"
+#include <memory>
+
+namespace maple
+{
+	class StorageBuffer;
+	class Texture;
+
+	/**
+	 * same layout as VkDrawIndexedIndirectCommand.
+	 */
+	struct DrawIndexedIndirectCommand
+	{
+		uint32_t indexCount;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t  vertexOffset;
+		uint32_t firstInstance;
+	};
+
+	/**
+	 * one culled instance. the sphere is in world space (xyz center, w radius),
+	 * drawIndex selects the source draw command, instanceId ends up in firstInstance.
+	 */
+	struct CullingInstance
+	{
+		vec4     boundingSphere;
+		uint32_t drawIndex;
+		uint32_t instanceId;
+		uint32_t padding[2];
+	};
+
+	/**
+	 * gpu driven culling, a compute pass tests instance bounds against the frustum and
+	 * optionally a hi-z depth pyramid, surviving instances are compacted into an indirect
+	 * buffer with an atomic draw count which is consumed by drawIndexedIndirectCount.
+	 *
+	 * without draw indirect count support every instance keeps its slot and culled
+	 * ones are written with zero instances, draw then issues maxInstances draws.
+	 */
+	class IndirectCulling
+	{
+	  public:
+		IndirectCulling(uint32_t maxInstances);
+
+		auto setInstances(const std::shared_ptr<StorageBuffer> &instances, uint32_t count) -> void;
+		auto setDrawCommands(const std::shared_ptr<StorageBuffer> &drawCommands) -> void;
+
+		/**
+		 * pyramid holds the farthest depth per texel, mip 0 is the depth buffer size.
+		 * nullptr disables the occlusion test.
+		 */
+		auto setDepthPyramid(const std::shared_ptr<Texture> &pyramid, bool reverseZ = false) -> void;
+
+		/**
+		 * records the culling pass, must be outside of a render pass.
+		 */
+		auto cull(const CommandBuffer *cmd, const mat4 &viewProj) -> void;
+
+		/**
+		 * draws the survivors with the bound graphics pipeline.
+		 */
+		auto draw(const CommandBuffer *cmd, Pipeline *pipeline) -> void;
+
+		inline auto &getDrawBuffer() const
+		{
+			return drawBuffer;
+		}
+
+		inline auto &getCountBuffer() const
+		{
+			return countBuffer;
+		}
+
+		inline auto getMaxInstances() const
+		{
+			return maxInstances;
+		}
+
+	  private:
+		uint32_t maxInstances  = 0;
+		uint32_t instanceCount = 0;
+		bool     compact       = false;
+		bool     reverseZ      = false;
+
+		std::shared_ptr<StorageBuffer> instances;
+		std::shared_ptr<StorageBuffer> drawCommands;
+		std::shared_ptr<StorageBuffer> drawBuffer;
+		std::shared_ptr<StorageBuffer> countBuffer;
+		std::shared_ptr<Texture>       depthPyramid;
+
+		std::shared_ptr<Shader>        shader;
+		std::shared_ptr<Pipeline>      pipeline;
+		std::shared_ptr<DescriptorSet> descriptorSet;
+	};
+}        // namespace maple
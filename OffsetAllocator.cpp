@@ -0,0 +1,237 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "OffsetAllocator.h"
+#include "Console.h"
+#include <algorithm>
+
+namespace maple
+{
+	namespace
+	{
+		inline auto highestBit(uint64_t value) -> uint32_t
+		{
+			uint32_t bit = 0;
+			while (value >>= 1)
+				bit++;
+			return bit;
+		}
+
+		inline auto lowestBit(uint64_t value) -> uint32_t
+		{
+			uint32_t bit = 0;
+			while ((value & 1) == 0)
+			{
+				value >>= 1;
+				bit++;
+			}
+			return bit;
+		}
+
+		//sizes below SecondLevelCount share the first bucket, one slot per size.
+		template <uint32_t SecondLevelLog2>
+		inline auto mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel)
+		{
+			constexpr uint64_t SecondLevelCount = 1ull << SecondLevelLog2;
+			if (size < SecondLevelCount)
+			{
+				firstLevel  = 0;
+				secondLevel = static_cast<uint32_t>(size);
+				return;
+			}
+			auto bit    = highestBit(size);
+			firstLevel  = bit - SecondLevelLog2 + 1;
+			secondLevel = static_cast<uint32_t>((size >> (bit - SecondLevelLog2)) - SecondLevelCount);
+		}
+	}        // namespace
+
+	OffsetAllocator::OffsetAllocator(uint64_t size) :
+	    size(size)
+	{
+		for (auto &level : heads)
+			level.fill(InvalidNode);
+
+		insertFree(createNode(0, size));
+	}
+
+	auto OffsetAllocator::allocate(uint64_t size, uint64_t alignment) -> Allocation
+	{
+		PROFILE_FUNCTION();
+		if (size == 0)
+			return {};
+
+		//round up to the next bucket, every block in it is big enough then.
+		auto request = size + (alignment > 1 ? alignment - 1 : 0);
+		if (request >= SecondLevelCount)
+			request += (1ull << (highestBit(request) - SecondLevelLog2)) - 1;
+
+		uint32_t firstLevel  = 0;
+		uint32_t secondLevel = 0;
+		mapping<SecondLevelLog2>(request, firstLevel, secondLevel);
+
+		if (firstLevel >= FirstLevelCount || !findFree(firstLevel, secondLevel))
+			return {};
+
+		auto index = heads[firstLevel][secondLevel];
+		removeFree(index);
+
+		auto aligned = alignment > 1 ? (nodes[index].offset + alignment - 1) / alignment * alignment : nodes[index].offset;
+		auto padding = aligned - nodes[index].offset;
+
+		if (padding > 0)
+		{
+			auto front                = createNode(nodes[index].offset, padding);
+			nodes[front].prevPhysical = nodes[index].prevPhysical;
+			nodes[front].nextPhysical = index;
+			if (nodes[index].prevPhysical != InvalidNode)
+				nodes[nodes[index].prevPhysical].nextPhysical = front;
+			nodes[index].prevPhysical = front;
+			nodes[index].offset       = aligned;
+			nodes[index].size -= padding;
+			insertFree(front);
+		}
+
+		if (nodes[index].size > size)
+		{
+			auto back                = createNode(aligned + size, nodes[index].size - size);
+			nodes[back].prevPhysical = index;
+			nodes[back].nextPhysical = nodes[index].nextPhysical;
+			if (nodes[index].nextPhysical != InvalidNode)
+				nodes[nodes[index].nextPhysical].prevPhysical = back;
+			nodes[index].nextPhysical = back;
+			nodes[index].size         = size;
+			insertFree(back);
+		}
+
+		nodes[index].used = true;
+		used += size;
+		allocationCount++;
+		return {aligned, size, index};
+	}
+
+	auto OffsetAllocator::free(uint32_t index) -> void
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(index < nodes.size() && nodes[index].used, "free of an invalid allocation");
+
+		nodes[index].used = false;
+		used -= nodes[index].size;
+		allocationCount--;
+
+		if (auto prev = nodes[index].prevPhysical; prev != InvalidNode && !nodes[prev].used)
+		{
+			removeFree(prev);
+			nodes[prev].size += nodes[index].size;
+			nodes[prev].nextPhysical = nodes[index].nextPhysical;
+			if (nodes[index].nextPhysical != InvalidNode)
+				nodes[nodes[index].nextPhysical].prevPhysical = prev;
+			unusedNodes.emplace_back(index);
+			index = prev;
+		}
+
+		if (auto next = nodes[index].nextPhysical; next != InvalidNode && !nodes[next].used)
+		{
+			removeFree(next);
+			nodes[index].size += nodes[next].size;
+			nodes[index].nextPhysical = nodes[next].nextPhysical;
+			if (nodes[next].nextPhysical != InvalidNode)
+				nodes[nodes[next].nextPhysical].prevPhysical = index;
+			unusedNodes.emplace_back(next);
+		}
+
+		insertFree(index);
+	}
+
+	auto OffsetAllocator::getLargestFree() const -> uint64_t
+	{
+		if (firstLevelMap == 0)
+			return 0;
+
+		auto     firstLevel  = highestBit(firstLevelMap);
+		auto     secondLevel = highestBit(secondLevelMap[firstLevel]);
+		uint64_t largest     = 0;
+		for (auto node = heads[firstLevel][secondLevel]; node != InvalidNode; node = nodes[node].nextFree)
+		{
+			largest = std::max(largest, nodes[node].size);
+		}
+		return largest;
+	}
+
+	auto OffsetAllocator::createNode(uint64_t offset, uint64_t size) -> uint32_t
+	{
+		uint32_t index;
+		if (!unusedNodes.empty())
+		{
+			index = unusedNodes.back();
+			unusedNodes.pop_back();
+			nodes[index] = {};
+		}
+		else
+		{
+			index = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+		}
+		nodes[index].offset = offset;
+		nodes[index].size   = size;
+		return index;
+	}
+
+	auto OffsetAllocator::insertFree(uint32_t index) -> void
+	{
+		uint32_t firstLevel  = 0;
+		uint32_t secondLevel = 0;
+		mapping<SecondLevelLog2>(nodes[index].size, firstLevel, secondLevel);
+
+		auto &head            = heads[firstLevel][secondLevel];
+		nodes[index].prevFree = InvalidNode;
+		nodes[index].nextFree = head;
+		if (head != InvalidNode)
+			nodes[head].prevFree = index;
+		head = index;
+
+		firstLevelMap |= 1ull << firstLevel;
+		secondLevelMap[firstLevel] |= 1u << secondLevel;
+	}
+
+	auto OffsetAllocator::removeFree(uint32_t index) -> void
+	{
+		uint32_t firstLevel  = 0;
+		uint32_t secondLevel = 0;
+		mapping<SecondLevelLog2>(nodes[index].size, firstLevel, secondLevel);
+
+		auto &node = nodes[index];
+		if (node.prevFree != InvalidNode)
+			nodes[node.prevFree].nextFree = node.nextFree;
+		if (node.nextFree != InvalidNode)
+			nodes[node.nextFree].prevFree = node.prevFree;
+
+		auto &head = heads[firstLevel][secondLevel];
+		if (head == index)
+		{
+			head = node.nextFree;
+			if (head == InvalidNode)
+			{
+				secondLevelMap[firstLevel] &= ~(1u << secondLevel);
+				if (secondLevelMap[firstLevel] == 0)
+					firstLevelMap &= ~(1ull << firstLevel);
+			}
+		}
+		node.prevFree = InvalidNode;
+		node.nextFree = InvalidNode;
+	}
+
+	auto OffsetAllocator::findFree(uint32_t &firstLevel, uint32_t &secondLevel) const -> bool
+	{
+		auto secondMap = secondLevel < 32 ? secondLevelMap[firstLevel] & (~0u << secondLevel) : 0;
+		if (secondMap == 0)
+		{
+			auto firstMap = firstLevel + 1 < FirstLevelCount ? firstLevelMap & (~0ull << (firstLevel + 1)) : 0;
+			if (firstMap == 0)
+				return false;
+			firstLevel = lowestBit(firstMap);
+			secondMap  = secondLevelMap[firstLevel];
+		}
+		secondLevel = lowestBit(secondMap);
+		return true;
+	}
+}        // namespace maple
@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * two level segregated fit allocator over a range of offsets, it never touches the memory
+	 * it manages. allocate and free are O(1), free neighbours are merged immediately.
+	 */
+	class OffsetAllocator
+	{
+	  public:
+		static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+		struct Allocation
+		{
+			uint64_t offset = 0;
+			uint64_t size   = 0;
+			uint32_t node   = InvalidNode;
+
+			inline auto isValid() const
+			{
+				return node != InvalidNode;
+			}
+		};
+
+		OffsetAllocator(uint64_t size);
+
+		/**
+		 * alignment does not need to be a power of two, e.g. a vertex stride.
+		 */
+		auto allocate(uint64_t size, uint64_t alignment = 1) -> Allocation;
+		auto free(uint32_t node) -> void;
+
+		auto getLargestFree() const -> uint64_t;
+
+		inline auto getSize() const
+		{
+			return size;
+		}
+
+		inline auto getUsed() const
+		{
+			return used;
+		}
+
+		inline auto getAllocationCount() const
+		{
+			return allocationCount;
+		}
+
+	  private:
+		static constexpr uint32_t SecondLevelLog2  = 4;
+		static constexpr uint32_t SecondLevelCount = 1 << SecondLevelLog2;
+		static constexpr uint32_t FirstLevelCount  = 64;
+
+		struct Node
+		{
+			uint64_t offset       = 0;
+			uint64_t size         = 0;
+			uint32_t prevPhysical = InvalidNode;
+			uint32_t nextPhysical = InvalidNode;
+			uint32_t prevFree     = InvalidNode;
+			uint32_t nextFree     = InvalidNode;
+			bool     used         = false;
+		};
+
+		auto createNode(uint64_t offset, uint64_t size) -> uint32_t;
+		auto insertFree(uint32_t node) -> void;
+		auto removeFree(uint32_t node) -> void;
+		auto findFree(uint32_t &firstLevel, uint32_t &secondLevel) const -> bool;
+
+		uint64_t size            = 0;
+		uint64_t used            = 0;
+		uint32_t allocationCount = 0;
+
+		uint64_t                                                             firstLevelMap = 0;
+		std::array<uint32_t, FirstLevelCount>                                secondLevelMap{};
+		std::array<std::array<uint32_t, SecondLevelCount>, FirstLevelCount> heads;
+
+		std::vector<Node>     nodes;
+		std::vector<uint32_t> unusedNodes;
+	};
+}        // namespace maple
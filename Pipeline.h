@@ -36,6 +36,10 @@ namespace maple
 		virtual auto getRenderPass()->std::shared_ptr<RenderPass> = 0;
 		virtual auto getFrameBuffer()->std::shared_ptr<FrameBuffer> = 0;
 		virtual auto drawIndexedIndirect(const CommandBuffer* cmdBuffer, const StorageBuffer* ssbo, uint32_t drawCount, uint32_t stride = 0, uint64_t offset = 0) -> void {};
+		/**
+		 * the draw count is read from countBuffer on the GPU, capped at maxDrawCount.
+		 */
+		virtual auto drawIndexedIndirectCount(const CommandBuffer* cmdBuffer, const StorageBuffer* ssbo, const StorageBuffer* countBuffer, uint32_t maxDrawCount, uint32_t stride = 0, uint64_t offset = 0, uint64_t countOffset = 0) -> void {};
 
 		virtual auto drawIndexed(const CommandBuffer* cmdBuffer,
 			uint32_t             indexCount,
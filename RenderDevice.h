@@ -41,6 +41,8 @@ namespace maple
 		virtual auto drawInstanced(const CommandBuffer* commandBuffer, uint32_t verticesCount, uint32_t instanceCount, int32_t startInstance = 0, int32_t startVertex = 0) const -> void {};
 		virtual auto drawIndexedIndirect(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, uint32_t count, uint32_t stride) -> void {};
 		virtual auto drawIndirect(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, uint32_t count, uint32_t stride) -> void {};
+		virtual auto drawIndexedIndirectCount(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, const StorageBuffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride) -> void {};
+		virtual auto isDrawIndirectCountSupported() const -> bool { return false; };
 
 		virtual auto memoryBarrier(const CommandBuffer* commandBuffer, uint32_t flag) -> void {};
 		virtual auto memoryBarrier(const CommandBuffer* commandBuffer, ShaderType fromStage, ShaderType toStage, AccessFlags from, AccessFlags to) -> void {};
@@ -0,0 +1,351 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "RenderGraph.h"
+#include "Console.h"
+#include <algorithm>
+
+#ifdef MAPLE_VULKAN
+#	include "Vulkan/VulkanRenderGraph.h"
+#endif        // MAPLE_VULKAN
+
+namespace maple
+{
+	namespace
+	{
+		inline auto alignUp(uint64_t value, uint64_t alignment) -> uint64_t
+		{
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		inline auto needsBarrier(RenderGraphAccess src, RenderGraphAccess dst)
+		{
+			return render_graph::toImageLayout(src) != render_graph::toImageLayout(dst) || render_graph::isWrite(src) || render_graph::isWrite(dst);
+		}
+	}        // namespace
+
+	auto RenderGraphBackend::create() -> Ptr
+	{
+#ifdef MAPLE_VULKAN
+		return std::make_shared<VulkanRenderGraph>();
+#else
+		return std::make_shared<RecordingRenderGraphBackend>();
+#endif        // MAPLE_VULKAN
+	}
+
+	auto RenderGraph::Builder::create(const std::string &name, const RenderGraphTextureDesc &desc) -> RenderGraphHandle
+	{
+		MAPLE_ASSERT(desc.width > 0 && desc.height > 0, "transient texture without size");
+		auto &resource = graph.resources.emplace_back();
+		resource.name  = name;
+		resource.desc  = desc;
+		return {static_cast<int32_t>(graph.resources.size() - 1)};
+	}
+
+	auto RenderGraph::Builder::read(RenderGraphHandle handle, RenderGraphAccess access) -> RenderGraphHandle
+	{
+		MAPLE_ASSERT(handle.isValid() && handle.id < graph.resources.size(), "invalid render graph handle");
+		graph.passes[passIndex].reads.push_back({handle.id, access});
+		return handle;
+	}
+
+	auto RenderGraph::Builder::write(RenderGraphHandle handle, RenderGraphAccess access) -> RenderGraphHandle
+	{
+		MAPLE_ASSERT(handle.isValid() && handle.id < graph.resources.size(), "invalid render graph handle");
+		graph.passes[passIndex].writes.push_back({handle.id, access});
+		return handle;
+	}
+
+	auto RenderGraph::Builder::sideEffect() -> void
+	{
+		graph.passes[passIndex].sideEffect = true;
+	}
+
+	auto RenderGraph::Resources::getTexture(RenderGraphHandle handle) const -> std::shared_ptr<Texture>
+	{
+		MAPLE_ASSERT(handle.isValid() && handle.id < graph.resources.size(), "invalid render graph handle");
+		return graph.resources[handle.id].texture;
+	}
+
+	RenderGraph::RenderGraph(const RenderGraphBackend::Ptr &backend) :
+	    backend(backend)
+	{
+	}
+
+	auto RenderGraph::importTexture(const std::string &name, const std::shared_ptr<Texture> &texture, RenderGraphAccess initialAccess, RenderGraphAccess finalAccess) -> RenderGraphHandle
+	{
+		auto &resource         = resources.emplace_back();
+		resource.name          = name;
+		resource.texture       = texture;
+		resource.imported      = true;
+		resource.initialAccess = initialAccess;
+		resource.finalAccess   = finalAccess;
+		if (texture != nullptr)
+		{
+			resource.desc = {texture->getWidth(), texture->getHeight(), texture->getFormat()};
+		}
+		return {static_cast<int32_t>(resources.size() - 1)};
+	}
+
+	auto RenderGraph::addPass(const std::string &name, const SetupFunc &setup, const ExecuteFunc &execute) -> void
+	{
+		MAPLE_ASSERT(!compiled, "add pass after compile, call reset first");
+		auto &pass   = passes.emplace_back();
+		pass.name    = name;
+		pass.execute = execute;
+		Builder builder(*this, static_cast<uint32_t>(passes.size() - 1));
+		setup(builder);
+	}
+
+	auto RenderGraph::compile() -> void
+	{
+		PROFILE_FUNCTION();
+		statistics = {};
+		finalBarriers.clear();
+		for (auto &resource : resources)
+		{
+			resource.firstPass = -1;
+			resource.lastPass  = -1;
+			resource.aliasOf   = -1;
+		}
+
+		cullPasses();
+		placeResources();
+		scheduleBarriers();
+		compiled = true;
+	}
+
+	auto RenderGraph::cullPasses() -> void
+	{
+		//walk backwards, a pass survives if it writes something which is still needed later.
+		std::vector<bool> needed(resources.size(), false);
+
+		for (int32_t i = static_cast<int32_t>(passes.size()) - 1; i >= 0; i--)
+		{
+			auto &pass = passes[i];
+			pass.alive = pass.sideEffect;
+			for (auto &write : pass.writes)
+			{
+				pass.alive |= resources[write.resource].imported || needed[write.resource];
+			}
+
+			if (!pass.alive)
+			{
+				statistics.culledPasses++;
+				continue;
+			}
+
+			for (auto &write : pass.writes)
+			{
+				auto readsToo = std::any_of(pass.reads.begin(), pass.reads.end(), [&](auto &read) { return read.resource == write.resource; });
+				if (!readsToo)
+				{
+					//fully overwritten here, earlier writers are not needed for it.
+					needed[write.resource] = false;
+				}
+			}
+
+			for (auto &read : pass.reads)
+			{
+				needed[read.resource] = true;
+			}
+
+			for (auto &access : {&pass.reads, &pass.writes})
+			{
+				for (auto &a : *access)
+				{
+					auto &resource = resources[a.resource];
+					if (resource.lastPass == -1)
+						resource.lastPass = i;
+					resource.firstPass = i;
+				}
+			}
+			statistics.passes++;
+		}
+	}
+
+	auto RenderGraph::placeResources() -> void
+	{
+		PROFILE_FUNCTION();
+		struct Block
+		{
+			uint64_t offset;
+			uint64_t size;
+			int32_t  occupant;
+		};
+
+		std::vector<int32_t> order;
+		for (int32_t i = 0; i < resources.size(); i++)
+		{
+			if (!resources[i].imported && resources[i].firstPass != -1)
+			{
+				resources[i].requirements = backend->getMemoryRequirements(resources[i].desc);
+				order.emplace_back(i);
+			}
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](int32_t left, int32_t right) {
+			return resources[left].firstPass < resources[right].firstPass;
+		});
+
+		std::vector<Block> blocks;
+		uint64_t           heapSize       = 0;
+		uint32_t           memoryTypeBits = UINT32_MAX;
+
+		for (auto id : order)
+		{
+			auto &resource     = resources[id];
+			auto &requirements = resource.requirements;
+			memoryTypeBits &= requirements.memoryTypeBits;
+			statistics.unaliasedSize += requirements.size;
+
+			//smallest retired block the texture fits in.
+			int32_t best = -1;
+			for (int32_t i = 0; i < blocks.size(); i++)
+			{
+				auto &block = blocks[i];
+				if (resources[block.occupant].lastPass < resource.firstPass && block.size >= requirements.size &&
+				    block.offset % requirements.alignment == 0 && (best == -1 || block.size < blocks[best].size))
+				{
+					best = i;
+				}
+			}
+
+			if (best != -1)
+			{
+				resource.offset          = blocks[best].offset;
+				resource.aliasOf         = blocks[best].occupant;
+				blocks[best].occupant    = id;
+			}
+			else
+			{
+				resource.offset = alignUp(heapSize, requirements.alignment);
+				heapSize        = resource.offset + requirements.size;
+				blocks.push_back({resource.offset, requirements.size, id});
+			}
+		}
+
+		MAPLE_ASSERT(memoryTypeBits != 0, "transient textures do not share a memory type");
+		statistics.heapSize = heapSize;
+
+		if (heapSize > 0)
+		{
+			backend->allocateHeap(heapSize, memoryTypeBits);
+		}
+
+		for (auto id : order)
+		{
+			resources[id].texture = backend->createTexture(resources[id].name, resources[id].desc, resources[id].offset);
+		}
+	}
+
+	auto RenderGraph::scheduleBarriers() -> void
+	{
+		PROFILE_FUNCTION();
+		std::vector<RenderGraphAccess> current(resources.size(), RenderGraphAccess::None);
+		for (int32_t i = 0; i < resources.size(); i++)
+		{
+			current[i] = resources[i].initialAccess;
+		}
+
+		for (int32_t i = 0; i < passes.size(); i++)
+		{
+			auto &pass = passes[i];
+			pass.barriers.clear();
+			if (!pass.alive)
+				continue;
+
+			//one access per resource, a write wins over a read of the same texture.
+			std::vector<ResourceAccess> accesses;
+			for (auto &access : {&pass.reads, &pass.writes})
+			{
+				for (auto &a : *access)
+				{
+					auto iter = std::find_if(accesses.begin(), accesses.end(), [&](auto &r) { return r.resource == a.resource; });
+					if (iter == accesses.end())
+						accesses.push_back(a);
+					else if (render_graph::isWrite(a.access))
+						iter->access = a.access;
+				}
+			}
+
+			for (auto &a : accesses)
+			{
+				auto &resource = resources[a.resource];
+				if (!resource.imported && resource.firstPass == i)
+				{
+					//first use, contents are undefined. wait for the previous user of the memory.
+					auto src = resource.aliasOf != -1 ? current[resource.aliasOf] : RenderGraphAccess::None;
+					pass.barriers.push_back({a.resource, nullptr, src, a.access, true});
+				}
+				else if (current[a.resource] == RenderGraphAccess::None)
+				{
+					pass.barriers.push_back({a.resource, nullptr, RenderGraphAccess::None, a.access, true});
+				}
+				else if (needsBarrier(current[a.resource], a.access))
+				{
+					pass.barriers.push_back({a.resource, nullptr, current[a.resource], a.access, false});
+				}
+				current[a.resource] = a.access;
+			}
+			statistics.barriers += pass.barriers.size();
+		}
+
+		for (int32_t i = 0; i < resources.size(); i++)
+		{
+			auto &resource = resources[i];
+			if (resource.imported && resource.finalAccess != RenderGraphAccess::None && needsBarrier(current[i], resource.finalAccess))
+			{
+				finalBarriers.push_back({i, nullptr, current[i], resource.finalAccess, current[i] == RenderGraphAccess::None});
+			}
+		}
+		statistics.barriers += finalBarriers.size();
+	}
+
+	auto RenderGraph::execute(const CommandBuffer *cmd) -> void
+	{
+		PROFILE_FUNCTION();
+		if (!compiled)
+			compile();
+
+		const Resources res(*this);
+
+		for (auto &pass : passes)
+		{
+			if (!pass.alive)
+				continue;
+
+			if (!pass.barriers.empty())
+			{
+				for (auto &barrier : pass.barriers)
+				{
+					barrier.texture = resources[barrier.resource].texture.get();
+				}
+				backend->barriers(cmd, pass.barriers);
+			}
+
+			backend->beginPass(cmd, pass.name);
+			if (pass.execute)
+				pass.execute(cmd, res);
+			backend->endPass(cmd, pass.name);
+		}
+
+		if (!finalBarriers.empty())
+		{
+			for (auto &barrier : finalBarriers)
+			{
+				barrier.texture = resources[barrier.resource].texture.get();
+			}
+			backend->barriers(cmd, finalBarriers);
+		}
+	}
+
+	auto RenderGraph::reset() -> void
+	{
+		passes.clear();
+		resources.clear();
+		finalBarriers.clear();
+		statistics = {};
+		compiled   = false;
+	}
+}        // namespace maple
@@ -0,0 +1,360 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Definitions.h"
+#include "Textures.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+
+	enum class RenderGraphAccess : uint8_t
+	{
+		None,
+		ColorAttachment,
+		DepthAttachment,
+		ShaderRead,
+		StorageRead,
+		StorageWrite,
+		TransferSrc,
+		TransferDst,
+		Present
+	};
+
+	namespace render_graph
+	{
+		inline auto isWrite(RenderGraphAccess access)
+		{
+			return access == RenderGraphAccess::ColorAttachment || access == RenderGraphAccess::DepthAttachment ||
+			       access == RenderGraphAccess::StorageWrite || access == RenderGraphAccess::TransferDst;
+		}
+
+		inline auto toImageLayout(RenderGraphAccess access)
+		{
+			switch (access)
+			{
+				case RenderGraphAccess::ColorAttachment:
+					return ImageLayout::Color_Attachment_Optimal;
+				case RenderGraphAccess::DepthAttachment:
+					return ImageLayout::Depth_Stencil_Attachment_Optimal;
+				case RenderGraphAccess::ShaderRead:
+					return ImageLayout::Shader_Read_Only_Optimal;
+				case RenderGraphAccess::StorageRead:
+				case RenderGraphAccess::StorageWrite:
+					return ImageLayout::General;
+				case RenderGraphAccess::TransferSrc:
+					return ImageLayout::Transfer_Src_Optimal;
+				case RenderGraphAccess::TransferDst:
+					return ImageLayout::Transfer_Dst_Optimal;
+				case RenderGraphAccess::Present:
+					return ImageLayout::Present_Src;
+				default:
+					return ImageLayout::Undefined;
+			}
+		}
+	}        // namespace render_graph
+
+	struct RenderGraphTextureDesc
+	{
+		uint32_t      width  = 0;
+		uint32_t      height = 0;
+		TextureFormat format = TextureFormat::RGBA8;
+
+		inline auto operator==(const RenderGraphTextureDesc &other) const
+		{
+			return width == other.width && height == other.height && format == other.format;
+		}
+	};
+
+	struct RenderGraphHandle
+	{
+		int32_t id = -1;
+
+		inline auto isValid() const
+		{
+			return id >= 0;
+		}
+	};
+
+	struct RenderGraphMemoryRequirements
+	{
+		uint64_t size           = 0;
+		uint64_t alignment      = 1;
+		uint32_t memoryTypeBits = UINT32_MAX;
+	};
+
+	struct RenderGraphBarrier
+	{
+		int32_t           resource  = -1;
+		Texture *         texture   = nullptr;
+		RenderGraphAccess srcAccess = RenderGraphAccess::None;
+		RenderGraphAccess dstAccess = RenderGraphAccess::None;
+		/**
+		 * the previous contents are not needed (first use of a transient or an aliased
+		 * memory range), the old layout is treated as undefined.
+		 */
+		bool discard = false;
+	};
+
+	/**
+	 * the API specific part of the render graph. it only ever sees the already
+	 * scheduled work: memory placement, textures and barrier batches.
+	 */
+	class RenderGraphBackend
+	{
+	  public:
+		using Ptr = std::shared_ptr<RenderGraphBackend>;
+
+		static auto create() -> Ptr;
+
+		virtual ~RenderGraphBackend() = default;
+
+		virtual auto getMemoryRequirements(const RenderGraphTextureDesc &desc) -> RenderGraphMemoryRequirements = 0;
+		/**
+		 * make sure the heap backing the transient textures of this frame is at least size bytes.
+		 */
+		virtual auto allocateHeap(uint64_t size, uint32_t memoryTypeBits) -> void = 0;
+		/**
+		 * create (or return a cached) texture which is placed at offset inside the heap.
+		 */
+		virtual auto createTexture(const std::string &name, const RenderGraphTextureDesc &desc, uint64_t offset) -> std::shared_ptr<Texture> = 0;
+
+		virtual auto barriers(const CommandBuffer *cmd, const std::vector<RenderGraphBarrier> &barriers) -> void = 0;
+
+		virtual auto beginPass(const CommandBuffer *cmd, const std::string &name) -> void{};
+		virtual auto endPass(const CommandBuffer *cmd, const std::string &name) -> void{};
+	};
+
+	/**
+	 * backend without any API behind it. it records what the graph asked for so the
+	 * computed schedule can be inspected headless.
+	 */
+	class RecordingRenderGraphBackend : public RenderGraphBackend
+	{
+	  public:
+		enum class EventType : uint8_t
+		{
+			AllocateHeap,
+			CreateTexture,
+			Barrier,
+			BeginPass,
+			EndPass
+		};
+
+		struct Event
+		{
+			EventType          type;
+			std::string        name;
+			uint64_t           offset = 0;
+			uint64_t           size   = 0;
+			RenderGraphBarrier barrier;
+		};
+
+		RecordingRenderGraphBackend(uint64_t alignment = 256) :
+		    alignment(alignment)
+		{
+		}
+
+		virtual auto getMemoryRequirements(const RenderGraphTextureDesc &desc) -> RenderGraphMemoryRequirements override
+		{
+			RenderGraphMemoryRequirements requirements;
+			requirements.size      = uint64_t(desc.width) * desc.height * Texture::getStrideFromFormat(desc.format);
+			requirements.alignment = alignment;
+			return requirements;
+		}
+
+		virtual auto allocateHeap(uint64_t size, uint32_t memoryTypeBits) -> void override
+		{
+			events.push_back({EventType::AllocateHeap, "", 0, size});
+		}
+
+		virtual auto createTexture(const std::string &name, const RenderGraphTextureDesc &desc, uint64_t offset) -> std::shared_ptr<Texture> override
+		{
+			events.push_back({EventType::CreateTexture, name, offset, getMemoryRequirements(desc).size});
+			return nullptr;
+		}
+
+		virtual auto barriers(const CommandBuffer *cmd, const std::vector<RenderGraphBarrier> &barriers) -> void override
+		{
+			for (auto &barrier : barriers)
+			{
+				events.push_back({EventType::Barrier, "", 0, 0, barrier});
+			}
+		}
+
+		virtual auto beginPass(const CommandBuffer *cmd, const std::string &name) -> void override
+		{
+			events.push_back({EventType::BeginPass, name});
+		}
+
+		virtual auto endPass(const CommandBuffer *cmd, const std::string &name) -> void override
+		{
+			events.push_back({EventType::EndPass, name});
+		}
+
+		inline auto &getEvents() const
+		{
+			return events;
+		}
+
+		inline auto clear()
+		{
+			events.clear();
+		}
+
+	  private:
+		uint64_t           alignment;
+		std::vector<Event> events;
+	};
+
+	/**
+	 * per frame graph of passes. passes declare the textures they read and write,
+	 * compile() culls passes whose results are never used, places transient textures
+	 * with disjoint lifetimes in the same memory and computes the barriers between passes.
+	 *
+	 * a pass which loads the previous contents of an attachment has to read it as well,
+	 * a write alone means the pass overwrites the whole texture.
+	 */
+	class RenderGraph
+	{
+	  public:
+		using Ptr = std::shared_ptr<RenderGraph>;
+
+		class Builder
+		{
+		  public:
+			auto create(const std::string &name, const RenderGraphTextureDesc &desc) -> RenderGraphHandle;
+			auto read(RenderGraphHandle handle, RenderGraphAccess access = RenderGraphAccess::ShaderRead) -> RenderGraphHandle;
+			auto write(RenderGraphHandle handle, RenderGraphAccess access = RenderGraphAccess::ColorAttachment) -> RenderGraphHandle;
+			/**
+			 * keep the pass even if nothing reads its outputs. (readback, debug output)
+			 */
+			auto sideEffect() -> void;
+
+		  private:
+			friend class RenderGraph;
+			Builder(RenderGraph &graph, uint32_t passIndex) :
+			    graph(graph), passIndex(passIndex)
+			{
+			}
+			RenderGraph &graph;
+			uint32_t     passIndex;
+		};
+
+		class Resources
+		{
+		  public:
+			auto getTexture(RenderGraphHandle handle) const -> std::shared_ptr<Texture>;
+
+		  private:
+			friend class RenderGraph;
+			Resources(const RenderGraph &graph) :
+			    graph(graph)
+			{
+			}
+			const RenderGraph &graph;
+		};
+
+		using SetupFunc   = std::function<void(Builder &)>;
+		using ExecuteFunc = std::function<void(const CommandBuffer *, const Resources &)>;
+
+		struct Statistics
+		{
+			uint32_t passes        = 0;
+			uint32_t culledPasses  = 0;
+			uint32_t barriers      = 0;
+			uint64_t heapSize      = 0;
+			uint64_t unaliasedSize = 0;
+		};
+
+		RenderGraph(const RenderGraphBackend::Ptr &backend = RenderGraphBackend::create());
+
+		/**
+		 * use a texture owned outside of the graph. it is expected in initialAccess when the
+		 * graph starts and is left in finalAccess (None keeps the last access).
+		 */
+		auto importTexture(const std::string &name, const std::shared_ptr<Texture> &texture, RenderGraphAccess initialAccess,
+		                   RenderGraphAccess finalAccess = RenderGraphAccess::None) -> RenderGraphHandle;
+
+		auto addPass(const std::string &name, const SetupFunc &setup, const ExecuteFunc &execute) -> void;
+
+		auto compile() -> void;
+
+		auto execute(const CommandBuffer *cmd) -> void;
+		/**
+		 * drop all passes and resources, the backend keeps its heaps and cached textures.
+		 */
+		auto reset() -> void;
+
+		inline auto isCulled(uint32_t passIndex) const
+		{
+			return !passes[passIndex].alive;
+		}
+
+		inline auto &getPassBarriers(uint32_t passIndex) const
+		{
+			return passes[passIndex].barriers;
+		}
+
+		inline auto getResourceOffset(RenderGraphHandle handle) const
+		{
+			return resources[handle.id].offset;
+		}
+
+		inline auto &getStatistics() const
+		{
+			return statistics;
+		}
+
+	  private:
+		struct ResourceAccess
+		{
+			int32_t           resource;
+			RenderGraphAccess access;
+		};
+
+		struct PassNode
+		{
+			std::string                     name;
+			ExecuteFunc                     execute;
+			std::vector<ResourceAccess>     reads;
+			std::vector<ResourceAccess>     writes;
+			std::vector<RenderGraphBarrier> barriers;
+			bool                            sideEffect = false;
+			bool                            alive      = false;
+		};
+
+		struct ResourceNode
+		{
+			std::string                   name;
+			RenderGraphTextureDesc        desc;
+			std::shared_ptr<Texture>      texture;
+			bool                          imported      = false;
+			RenderGraphAccess             initialAccess = RenderGraphAccess::None;
+			RenderGraphAccess             finalAccess   = RenderGraphAccess::None;
+			RenderGraphMemoryRequirements requirements;
+			int32_t                       firstPass = -1;
+			int32_t                       lastPass  = -1;
+			uint64_t                      offset    = 0;
+			//resource which used the same memory before this one.
+			int32_t aliasOf = -1;
+		};
+
+		auto cullPasses() -> void;
+		auto placeResources() -> void;
+		auto scheduleBarriers() -> void;
+
+		RenderGraphBackend::Ptr         backend;
+		std::vector<PassNode>           passes;
+		std::vector<ResourceNode>       resources;
+		std::vector<RenderGraphBarrier> finalBarriers;
+		Statistics                      statistics;
+		bool                            compiled = false;
+	};
+}        // namespace maple
@@ -12,9 +12,9 @@ namespace maple
 {
 	namespace
 	{
-		inline auto getShaderTypeByName(const std::string &name) -> ShaderType
+		inline auto getShaderTypeByName(std::string_view name) -> ShaderType
 		{
-			const std::unordered_map<std::string, ShaderType> types =
+			static constexpr std::pair<std::string_view, ShaderType> types[] =
 			    {
 			        {"Vertex", ShaderType::Vertex},
 			        {"Fragment", ShaderType::Fragment},
@@ -26,8 +26,11 @@ namespace maple
 			        {"RayGen", ShaderType::RayGen},
 			        {"RayIntersect", ShaderType::RayIntersect}};
 
-			if (auto iter = types.find(name); iter != types.end())
-				return iter->second;
+			for (auto &type : types)
+			{
+				if (type.first == name)
+					return type.second;
+			}
 
 			MAPLE_ASSERT(false, "Unknow shader type");
 			return ShaderType::Unknown;
@@ -109,20 +112,24 @@ namespace maple
 		MAPLE_ASSERT(false, "unsupported spv::ImageFormat");
 	}
 
-	auto Shader::parseSource(const std::vector<std::string> &lines, std::unordered_multimap<ShaderType, std::string> &shaders) -> void
+	auto Shader::parseSource(std::string_view source, std::unordered_multimap<ShaderType, std::string> &shaders) -> void
 	{
-		for (uint32_t i = 0; i < lines.size(); i++)
+		for (auto line : StringUtils::splitView(source, "\n"))
 		{
-			std::string str = lines[i];
-			if (StringUtils::startWith(str, "#"))
+			if (StringUtils::startWith(line, "#"))
 			{
-				auto path = StringUtils::split(str, " ");
-				auto type = getShaderTypeByName(path[0].substr(1, path[0].length()));
+				auto tokens = StringUtils::splitView(line, " ");
+				auto iter   = tokens.begin();
+				auto name   = *iter;
+				if (++iter == tokens.end())
+					continue;
+
+				auto type = getShaderTypeByName(name.substr(1));
 				if (type != ShaderType::Unknown)
 				{
-					StringUtils::trim(path[1], "\r");
-					shaders.emplace(type, path[1]);
-					LOGV("{0} : {1}", path[0], path[1]);
+					auto path = StringUtils::trimView(*iter, "\r");
+					shaders.emplace(type, path);
+					LOGV("{0} : {1}", name, path);
 				}
 			}
 		}
@@ -138,7 +138,7 @@ namespace maple
 		}
 
 	protected:
-		auto parseSource(const std::vector<std::string>& lines, std::unordered_multimap<ShaderType, std::string>& shaders) -> void;
+		auto parseSource(std::string_view source, std::unordered_multimap<ShaderType, std::string>& shaders) -> void;
 
 	public:
 		static auto create(const ShaderTypes& shaderTypes, const VariableArraySize& size = {}, const std::unordered_set<std::string>& dynamicUniforms = {})->std::shared_ptr<Shader>;
@@ -53,7 +53,18 @@ namespace maple
 		virtual auto map() -> void *                                            = 0;
 		virtual auto getDeviceAddress() const -> uint64_t                       = 0;
 		virtual auto getSize() const -> uint32_t                                = 0;
-		virtual auto resize(uint32_t size) -> void                              = 0;
+		virtual auto getCapacity() const -> uint32_t                            = 0;
+		/**
+		 * reallocates only when the capacity is exceeded and then grows geometrically,
+		 * the contents are discarded in that case.
+		 */
+		virtual auto resize(uint32_t size) -> void = 0;
+		/**
+		 * like resize, but the old contents are copied into the new allocation. host visible
+		 * buffers copy on the host right away, gpu only buffers by commands recorded into
+		 * copyCommand (usually the frame command buffer).
+		 */
+		virtual auto resize(uint32_t size, const CommandBuffer *copyCommand) -> void = 0;
 		virtual auto isDirty() const -> bool                                    = 0;
 		virtual auto setDirty(bool dirty) -> void                               = 0;
 		template <typename T>
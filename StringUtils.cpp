@@ -24,6 +24,21 @@
 
 namespace maple
 {
+	namespace
+	{
+		inline auto equalsIgnoreCase(std::string_view left, std::string_view right) -> bool
+		{
+			return left.size() == right.size() &&
+			       std::equal(left.begin(), left.end(), right.begin(), [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); });
+		}
+	}        // namespace
+
+	auto StringUtils::getFormatBuffer() -> std::vector<char> &
+	{
+		static thread_local std::vector<char> buffer(1024);
+		return buffer;
+	}
+
 	auto StringUtils::getExtension(const std::string &fileName) -> std::string
 	{
 		auto pos = fileName.find_last_of('.');
@@ -130,77 +145,55 @@ namespace maple
 		return true;
 	}
 
-	auto StringUtils::split(std::string input, const std::string &delimiter) -> std::vector<std::string>
+	auto StringUtils::split(std::string_view input, std::string_view delimiter) -> std::vector<std::string>
 	{
 		std::vector<std::string> ret;
-		size_t                   pos = 0;
-		std::string              token;
-		while ((pos = input.find(delimiter)) != std::string::npos)
-		{
-			token = input.substr(0, pos);
-			ret.push_back(token);
-			input.erase(0, pos + delimiter.length());
-		}
-		ret.push_back(input);
+		split(input, delimiter, ret);
 		return ret;
 	}
 
-	auto StringUtils::startWith(const std::string &str, const std::string &start, bool ignoreCase) -> bool
+	auto StringUtils::startWith(std::string_view str, std::string_view start, bool ignoreCase) -> bool
 	{
-		if (ignoreCase)
-		{
-			auto input = str;
-			toLower(input);
-			return input.compare(0, start.size(), toLower2(start)) == 0;
-		}
 		if (start.length() > str.length())
 			return false;
+		if (ignoreCase)
+			return equalsIgnoreCase(str.substr(0, start.size()), start);
 		return str.compare(0, start.size(), start) == 0;
 	}
 
-	auto StringUtils::contains(const std::string &str, const std::string &start) -> bool
+	auto StringUtils::contains(std::string_view str, std::string_view start) -> bool
 	{
-		return str.find(start) != std::string::npos;
+		return str.find(start) != std::string_view::npos;
 	}
 
-	auto StringUtils::endWith(const std::string &str, const std::string &start, bool ignoreCase) -> bool
+	auto StringUtils::endWith(std::string_view str, std::string_view start, bool ignoreCase) -> bool
 	{
-		if (ignoreCase)
-		{
-			auto input = str;
-			toLower(input);
-			return input.compare(str.length() - start.length(), start.size(), toLower2(start)) == 0;
-		}
 		if (start.length() > str.length())
 			return false;
+		if (ignoreCase)
+			return equalsIgnoreCase(str.substr(str.length() - start.length()), start);
 		return str.compare(str.length() - start.length(), start.size(), start) == 0;
 	}
 
-	auto StringUtils::split(std::string input, const std::string &delimiter, std::vector<std::string> &outs) -> void
+	auto StringUtils::split(std::string_view input, std::string_view delimiter, std::vector<std::string> &outs) -> void
 	{
-		size_t      pos = 0;
-		std::string token;
-		while ((pos = input.find(delimiter)) != std::string::npos)
+		for (auto token : splitView(input, delimiter))
 		{
-			token = input.substr(0, pos);
-			outs.push_back(token);
-			input.erase(0, pos + delimiter.length());
+			outs.emplace_back(token);
 		}
-		outs.push_back(input);
 	}
 
-	auto StringUtils::split(std::u16string input, const std::u16string &delimiter,
+	auto StringUtils::split(const std::u16string &input, const std::u16string &delimiter,
 	                        std::vector<std::u16string> &outs) -> void
 	{
-		size_t         pos = 0;
-		std::u16string token;
-		while ((pos = input.find(delimiter)) != std::u16string::npos)
+		size_t begin = 0;
+		size_t pos   = 0;
+		while (!delimiter.empty() && (pos = input.find(delimiter, begin)) != std::u16string::npos)
 		{
-			token = input.substr(0, pos);
-			outs.push_back(token);
-			input.erase(0, pos + delimiter.length());
+			outs.emplace_back(input, begin, pos - begin);
+			begin = pos + delimiter.length();
 		}
-		outs.push_back(input);
+		outs.emplace_back(input, begin);
 	}
 
 	auto StringUtils::trim(std::string &str, const std::string &trimStr) -> void
@@ -212,6 +205,14 @@ namespace maple
 		}
 	}
 
+	auto StringUtils::trimView(std::string_view str, std::string_view trimStr) -> std::string_view
+	{
+		auto begin = str.find_first_not_of(trimStr);
+		if (begin == std::string_view::npos)
+			return {};
+		return str.substr(begin, str.find_last_not_of(trimStr) - begin + 1);
+	}
+
 	auto StringUtils::replace(std::string &str, const std::string &old, const std::string &newStr) -> void
 	{
 		std::string::size_type pos    = 0;
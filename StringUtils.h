@@ -3,33 +3,176 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include <algorithm>
+#include <cstdio>
 #include <functional>
 #include <memory>
 #include <stdarg.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace maple
 {
+	/**
+	 * lazy split over a string_view, tokens point into the input so it has to outlive the range.
+	 * same semantics as StringUtils::split, "a,,b" gives "a", "", "b" and "" gives one empty token.
+	 */
+	class SplitView
+	{
+	  public:
+		class Iterator
+		{
+		  public:
+			Iterator() = default;
+			Iterator(std::string_view input, std::string_view delimiter) :
+			    rest(input), delimiter(delimiter), done(false)
+			{
+				next();
+			}
+
+			inline auto operator*() const -> std::string_view
+			{
+				return token;
+			}
+
+			inline auto operator++() -> Iterator &
+			{
+				next();
+				return *this;
+			}
+
+			inline auto operator==(const Iterator &other) const
+			{
+				return done == other.done && (done || rest.data() == other.rest.data());
+			}
+
+			inline auto operator!=(const Iterator &other) const
+			{
+				return !(*this == other);
+			}
+
+		  private:
+			inline auto next() -> void
+			{
+				if (last)
+				{
+					done = true;
+					return;
+				}
+				auto pos = delimiter.empty() ? std::string_view::npos : rest.find(delimiter);
+				if (pos == std::string_view::npos)
+				{
+					token = rest;
+					rest  = rest.substr(rest.size());
+					last  = true;
+				}
+				else
+				{
+					token = rest.substr(0, pos);
+					rest  = rest.substr(pos + delimiter.size());
+				}
+			}
+
+			std::string_view rest;
+			std::string_view delimiter;
+			std::string_view token;
+			bool             last = false;
+			bool             done = true;
+		};
+
+		SplitView(std::string_view input, std::string_view delimiter) :
+		    input(input), delimiter(delimiter)
+		{
+		}
+
+		inline auto begin() const
+		{
+			return Iterator(input, delimiter);
+		}
+
+		inline auto end() const
+		{
+			return Iterator();
+		}
+
+		inline auto front() const
+		{
+			return *begin();
+		}
+
+	  private:
+		std::string_view input;
+		std::string_view delimiter;
+	};
+
 	class StringUtils
 	{
 	  public:
+		/**
+		 * formats into its own buffer, so arguments may point into the formatTemp buffer.
+		 */
 		template <typename... Args>
 		inline static auto format(const std::string &format, Args... args) -> std::string
 		{
-			size_t                  size = snprintf(nullptr, 0, format.c_str(), args...) + 1;        // Extra space for '\0'
-			std::unique_ptr<char[]> buf(new char[size]);
-			snprintf(buf.get(), size, format.c_str(), args...);
-			return std::string(buf.get(), buf.get() + size - 1);
+			char buffer[256];
+			auto length = snprintf(buffer, sizeof(buffer), format.c_str(), args...);
+			if (length < 0)
+				return {};
+			if (static_cast<size_t>(length) < sizeof(buffer))
+				return {buffer, static_cast<size_t>(length)};
+
+			std::string result(length, '\0');
+			snprintf(result.data(), result.size() + 1, format.c_str(), args...);
+			return result;
+		}
+
+		/**
+		 * printf into a caller provided buffer, truncated to fit. never allocates.
+		 */
+		template <typename... Args>
+		inline static auto formatTo(char *buffer, size_t size, const char *format, Args... args) -> std::string_view
+		{
+			auto length = snprintf(buffer, size, format, args...);
+			if (length < 0 || size == 0)
+				return {};
+			return {buffer, std::min(static_cast<size_t>(length), size - 1)};
 		}
 
+		/**
+		 * printf into a thread local buffer which only grows, so it stops allocating after warm up.
+		 * the result is null terminated and valid until the next formatTemp on the same thread,
+		 * so it must not be passed as an argument to formatTemp, use format or formatTo instead.
+		 */
+		template <typename... Args>
+		inline static auto formatTemp(const char *format, Args... args) -> std::string_view
+		{
+			auto &buffer = getFormatBuffer();
+			auto  length = snprintf(buffer.data(), buffer.size(), format, args...);
+			if (length < 0)
+				return {};
+			if (static_cast<size_t>(length) >= buffer.size())
+			{
+				buffer.resize(length + 1);
+				snprintf(buffer.data(), buffer.size(), format, args...);
+			}
+			return {buffer.data(), static_cast<size_t>(length)};
+		}
+
+		static inline auto splitView(std::string_view input, std::string_view delimiter) -> SplitView
+		{
+			return {input, delimiter};
+		}
+
+		static auto trimView(std::string_view str, std::string_view trimStr = " ") -> std::string_view;
+
 		static auto replace(std::u16string &src, const std::u16string &origin, const std::u16string &des) -> void;
-		static auto split(std::string input, const std::string &delimiter) -> std::vector<std::string>;
-		static auto split(std::u16string input, const std::u16string &delimiter, std::vector<std::u16string> &outs) -> void;
-		static auto split(std::string input, const std::string &delimiter, std::vector<std::string> &outs) -> void;
-		static auto startWith(const std::string &str, const std::string &start, bool ignoreCase = false) -> bool;
-		static auto contains(const std::string &str, const std::string &start) -> bool;
-		static auto endWith(const std::string &str, const std::string &start, bool ignoreCase = false) -> bool;
+		static auto split(std::string_view input, std::string_view delimiter) -> std::vector<std::string>;
+		static auto split(const std::u16string &input, const std::u16string &delimiter, std::vector<std::u16string> &outs) -> void;
+		static auto split(std::string_view input, std::string_view delimiter, std::vector<std::string> &outs) -> void;
+		static auto startWith(std::string_view str, std::string_view start, bool ignoreCase = false) -> bool;
+		static auto contains(std::string_view str, std::string_view start) -> bool;
+		static auto endWith(std::string_view str, std::string_view start, bool ignoreCase = false) -> bool;
 		static auto trim(std::string &str, const std::string &trimStr = " ") -> void;
 		static auto trim(std::u16string &str) -> void;
 		static auto replace(std::string &str, const std::string &old, const std::string &newStr) -> void;
@@ -55,5 +198,8 @@ namespace maple
 		static auto              isCSharpFile(const std::string &filePath) -> bool;
 		static auto              isFBXFile(const std::string &filePath) -> bool;
 		static const std::string delimiter;
+
+	  private:
+		static auto getFormatBuffer() -> std::vector<char> &;
 	};        // namespace StringUtils
 };            // namespace maple
@@ -2,10 +2,54 @@
 // This file is part of the Maple Engine                              		//
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include <cstdint>
 #include <memory>
 
 namespace maple
 {
+	enum class PresentMode : uint8_t
+	{
+		Fifo,               //vsync
+		FifoRelaxed,        //vsync, late frames tear instead of waiting another interval
+		Mailbox,            //no tearing, the newest frame replaces a queued one
+		Immediate,          //no vsync
+	};
+
+	struct FramePacing
+	{
+		/**
+		 * 1 - 3, clamped to the number of swap chain images. 1 waits for the previous frame before
+		 * recording, more only once host visible buffers written every frame (dynamic buffers, the
+		 * instance staging of acceleration structures) are kept per frame slot.
+		 */
+		uint32_t    framesInFlight = 1;
+		PresentMode presentMode    = PresentMode::Fifo;
+		/**
+		 * waitBeforeInput also sleeps for the time the last frames were blocked by presentation,
+		 * so the frame starts just in time instead of sampling input and then waiting.
+		 */
+		bool  lowLatency = false;
+		float marginMs   = 1.0f;
+	};
+
+	/**
+	 * all times in ms, averages and maxima cover the last FramePacingStats::History frames.
+	 */
+	struct FramePacingStats
+	{
+		static constexpr uint32_t History = 120;
+
+		float    frameTime    = 0;        //between frame starts
+		float    frameTimeAvg = 0;
+		float    frameTimeMax = 0;
+		float    cpuTime      = 0;        //from sampling input to the submission
+		float    waitTime     = 0;        //blocked by frames in flight and image acquisition
+		float    latency      = 0;        //from sampling input until the GPU finished the frame
+		float    latencyAvg   = 0;
+		float    latencyMax   = 0;
+		uint64_t frames       = 0;
+	};
+
 	class Texture;
 	class FrameBuffer;
 	class RenderPass;
@@ -36,5 +80,30 @@ namespace maple
 		};
 
 		virtual auto getNativeWin() -> void* { return nullptr; };
+
+		virtual auto setFramePacing(const FramePacing &pacing) -> void
+		{
+			this->pacing = pacing;
+		}
+
+		inline auto &getFramePacing() const
+		{
+			return pacing;
+		}
+
+		inline auto &getFramePacingStats() const
+		{
+			return pacingStats;
+		}
+
+		/**
+		 * optional, call right before sampling input. blocks until the next frame can start so the
+		 * wait does not happen between reading input and rendering it.
+		 */
+		virtual auto waitBeforeInput() -> void {}
+
+	  protected:
+		FramePacing      pacing;
+		FramePacingStats pacingStats;
 	};
 }        // namespace maple
@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "TaskPool.h"
+#include "Console.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace maple
+{
+	namespace
+	{
+		struct Job
+		{
+			const TaskPool::Range *range  = nullptr;
+			uint32_t               count  = 0;
+			uint32_t               chunk  = 0;
+			uint32_t               chunks = 0;
+			std::atomic<uint32_t>  next{0};
+			uint32_t               users = 0;        //workers inside the job, guarded by the pool mutex
+		};
+
+		inline auto runChunks(Job &job)
+		{
+			for (auto i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.chunks; i = job.next.fetch_add(1, std::memory_order_relaxed))
+			{
+				auto begin = i * job.chunk;
+				(*job.range)(begin, std::min(begin + job.chunk, job.count));
+			}
+		}
+
+		inline auto hardwareWorkers() -> uint32_t
+		{
+			return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+
+		class Workers
+		{
+		  public:
+			Workers()
+			{
+				auto count = hardwareWorkers();
+				threads.reserve(count);
+				for (uint32_t i = 0; i < count; i++)
+					threads.emplace_back(&Workers::run, this);
+			}
+
+			~Workers()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					running = false;
+				}
+				wakeup.notify_all();
+				for (auto &thread : threads)
+					thread.join();
+			}
+
+			auto execute(Job &job) -> void
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					jobs.emplace_back(&job);
+				}
+				wakeup.notify_all();
+				runChunks(job);
+
+				//every chunk is taken, no worker may enter the job anymore. wait for the ones still inside.
+				std::unique_lock<std::mutex> lock(mutex);
+				jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+				finished.wait(lock, [&] { return job.users == 0; });
+			}
+
+		  private:
+			auto run() -> void
+			{
+				PROFILE_SETTHREADNAME("TaskPool");
+				std::unique_lock<std::mutex> lock(mutex);
+				while (true)
+				{
+					Job *job = nullptr;
+					wakeup.wait(lock, [&] { return !running || (job = findJob()) != nullptr; });
+					if (!running)
+						return;
+
+					job->users++;
+					lock.unlock();
+					runChunks(*job);
+					lock.lock();
+					if (--job->users == 0)
+						finished.notify_all();
+				}
+			}
+
+			//a job with chunks nobody started yet.
+			inline auto findJob() const -> Job *
+			{
+				for (auto job : jobs)
+				{
+					if (job->next.load(std::memory_order_relaxed) < job->chunks)
+						return job;
+				}
+				return nullptr;
+			}
+
+			std::mutex               mutex;
+			std::condition_variable  wakeup;
+			std::condition_variable  finished;
+			std::vector<Job *>       jobs;
+			std::vector<std::thread> threads;
+			bool                     running = true;
+		};
+
+		inline auto getWorkers() -> Workers &
+		{
+			static Workers workers;
+			return workers;
+		}
+	}        // namespace
+
+	auto TaskPool::getWorkerCount() -> uint32_t
+	{
+		return hardwareWorkers();
+	}
+
+	auto TaskPool::parallelFor(uint32_t count, uint32_t tasks, const Range &range) -> void
+	{
+		PROFILE_FUNCTION();
+		if (count == 0)
+			return;
+
+		tasks = std::clamp<uint32_t>(tasks, 1, count);
+		if (tasks == 1)
+		{
+			range(0, count);
+			return;
+		}
+
+		Job job;
+		job.range  = &range;
+		job.count  = count;
+		job.chunk  = (count + tasks - 1) / tasks;
+		job.chunks = (count + job.chunk - 1) / job.chunk;
+		getWorkers().execute(job);
+	}
+}        // namespace maple
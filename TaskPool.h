@@ -0,0 +1,32 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace maple
+{
+	/**
+	 * persistent worker threads for short data parallel loops, e.g. packing instances every frame.
+	 * the threads are started on first use and sleep while there is no work, so a loop only pays
+	 * for waking them up instead of creating threads.
+	 */
+	class TaskPool
+	{
+	  public:
+		using Range = std::function<void(uint32_t begin, uint32_t end)>;
+
+		/**
+		 * hardware threads minus the calling one, at least one.
+		 */
+		static auto getWorkerCount() -> uint32_t;
+
+		/**
+		 * splits [0, count) into at most tasks chunks and runs them on the workers and the calling
+		 * thread, returns once every chunk ran. chunks are disjoint, small counts run inline.
+		 */
+		static auto parallelFor(uint32_t count, uint32_t tasks, const Range &range) -> void;
+	};
+}        // namespace maple
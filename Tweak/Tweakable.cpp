@@ -15,17 +15,7 @@ namespace maple
 			values = new std::unordered_map<std::string, std::vector<TweakValue*>>();
 		}
 
-		std::vector<std::string> outs;
-		StringUtils::split(tweak->varName, ":", outs);
-
-		if (!outs.empty())
-		{
-			(*values)[outs[0]].emplace_back(tweak);
-		}
-		else 
-		{
-			(*values)["Untitled"].emplace_back(tweak);
-		}
+		(*values)[std::string(StringUtils::splitView(tweak->varName, ":").front())].emplace_back(tweak);
 	};
 
 	auto getValues() ->std::unordered_map<std::string, std::vector<TweakValue*>>&
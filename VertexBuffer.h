@@ -5,6 +5,7 @@
 #include "BufferUsage.h"
 #include "GPUBuffer.h"
 #include <memory>
+#include <vector>
 
 namespace maple
 {
@@ -19,6 +20,7 @@ namespace maple
 		virtual auto resize(uint32_t size) -> void                                        = 0;
 		virtual auto setData(uint32_t size, const void *data) -> void                     = 0;
 		virtual auto setDataSub(uint32_t size, const void *data, uint32_t offset) -> void = 0;
+		virtual auto setDataSub(const std::vector<BufferUpdate> &updates) -> void         = 0;
 		virtual auto releasePointer() -> void                                             = 0;
 		virtual auto bind(const CommandBuffer *commandBuffer, Pipeline *pipeline) -> void = 0;
 		virtual auto unbind() -> void                                                     = 0;
@@ -27,6 +29,14 @@ namespace maple
 			return 0;
 		}
 
+		/**
+		 * allocated bytes, dynamic and stream buffers grow geometrically and never shrink.
+		 */
+		virtual auto getCapacity() const -> uint64_t
+		{
+			return 0;
+		}
+
 		template <typename T>
 		inline auto getPointer() -> T *
 		{
@@ -44,6 +44,10 @@ namespace maple
 		{
 			return pipelineProps.shaderGroupBaseAlignment;
 		}
+		inline auto getShaderGroupHandleAlignment() const
+		{
+			return pipelineProps.shaderGroupHandleAlignment;
+		}
 		inline auto getShaderGroupHandleCaptureReplaySize() const
 		{
 			return pipelineProps.shaderGroupHandleCaptureReplaySize;
@@ -4,8 +4,12 @@
 
 #include "ShaderBindingTable.h"
 #include "../../Console.h"
+#include "../VulkanBuffer.h"
+#include "../VulkanCommandBuffer.h"
 #include "../VulkanDevice.h"
 #include "RayTracingProperties.h"
+#include <algorithm>
+#include <cstring>
 
 namespace maple
 {
@@ -26,8 +30,6 @@ namespace maple
 	                                   const std::vector<VkShaderModule> &                                            missGens,
 	                                   const std::vector<std::tuple<VkShaderModule, VkShaderModule, VkShaderModule>> &hits) -> void
 	{
-		auto alignSize = alignedSize(rayTracingProperties->getShaderGroupHandleSize(), rayTracingProperties->getShaderGroupBaseAlignment());
-
 		for (auto shaderModule : rayGens)
 		{
 			int32_t id    = stages.size();
@@ -46,7 +48,7 @@ namespace maple
 			groupInfo.anyHitShader                         = VK_SHADER_UNUSED_KHR;
 			groupInfo.intersectionShader                   = VK_SHADER_UNUSED_KHR;
 			groups.emplace_back(groupInfo);
-			rayGenSize += alignSize;
+			rayGenCount++;
 		}
 
 		for (auto shaderModule : missGens)
@@ -67,7 +69,7 @@ namespace maple
 			groupInfo.anyHitShader                         = VK_SHADER_UNUSED_KHR;
 			groupInfo.intersectionShader                   = VK_SHADER_UNUSED_KHR;
 			groups.emplace_back(groupInfo);
-			missGroupSize += alignSize;
+			missCount++;
 		}
 
 		for (auto [cloestHit, anyHit, intersection] : hits)
@@ -118,8 +120,158 @@ namespace maple
 			}
 
 			groups.emplace_back(groupInfo);
+			hitCount++;
+		}
+	}
+
+	auto ShaderBindingTable::build(VkPipeline pipeline) -> void
+	{
+		PROFILE_FUNCTION();
+		auto baseAlignment = rayTracingProperties->getShaderGroupBaseAlignment();
+
+		handleSize   = rayTracingProperties->getShaderGroupHandleSize();
+		handleStride = alignedSize(handleSize, rayTracingProperties->getShaderGroupHandleAlignment());
+		hitStride    = alignedSize(handleSize + hitRecordDataSize, rayTracingProperties->getShaderGroupHandleAlignment());
+		missOffset   = alignedSize(rayGenCount * handleStride, baseAlignment);
+		hitOffset    = alignedSize(missOffset + missCount * handleStride, baseAlignment);
+
+		if (hitStride > rayTracingProperties->getMaxShaderGroupStride())
+			LOGE("hit record of {0} bytes is larger than the max shader group stride {1}", hitStride, rayTracingProperties->getMaxShaderGroupStride());
+
+		handles.resize(groups.size() * handleSize);
+		VK_CHECK_RESULT(vkGetRayTracingShaderGroupHandlesKHR(*VulkanDevice::get(), pipeline, 0, static_cast<uint32_t>(groups.size()), handles.size(), handles.data()));
+
+		//the first records are the hit groups in order, instances with no records of their own use them.
+		hitRecordCount = std::max(hitCount, 1u);
+		table.assign(hitOffset + hitRecordCount * hitStride, 0);
+		for (uint32_t i = 0; i < rayGenCount + missCount; i++)
+		{
+			auto offset = i < rayGenCount ? i * handleStride : missOffset + (i - rayGenCount) * handleStride;
+			std::memcpy(&table[offset], &handles[i * handleSize], handleSize);
+		}
+
+		auto defaults = allocateHitRecords(hitCount);
+		for (uint32_t i = 0; i < hitCount; i++)
+			setHitRecord(defaults + i, i);
+
+		createBuffer();
+	}
+
+	auto ShaderBindingTable::createBuffer() -> void
+	{
+		//older buffers are released with the frame. the contents are staged by setVkData, which records
+		//into the upload command buffer of the frame while one is recording instead of submitting and waiting.
+		buffer = std::make_shared<VulkanBuffer>(
+		    VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		    static_cast<uint32_t>(table.size()), nullptr, VMA_MEMORY_USAGE_GPU_ONLY, 0);
+		buffer->setVkData(static_cast<uint32_t>(table.size()), table.data());
+		dirtyRecords.clear();
+	}
+
+	auto ShaderBindingTable::allocateHitRecords(uint32_t count) -> uint32_t
+	{
+		if (count == 0)
+			return InvalidRecord;
+
+		auto allocation = hitRecords.allocate(count);
+		if (!allocation.isValid())
+		{
+			LOGE("shader binding table is out of hit records, {0} requested", count);
+			return InvalidRecord;
+		}
+
+		auto record            = static_cast<uint32_t>(allocation.offset);
+		hitAllocations[record] = allocation.node;
+
+		//the table grows with the highest record in use, the buffer is recreated at the next upload.
+		if (record + count > hitRecordCount)
+		{
+			hitRecordCount = std::max(record + count, hitRecordCount * 2);
+			table.resize(hitOffset + hitRecordCount * hitStride, 0);
+		}
+
+		for (uint32_t i = 0; i < count; i++)
+			setHitRecord(record + i, 0);
+		return record;
+	}
+
+	auto ShaderBindingTable::freeHitRecords(uint32_t record) -> void
+	{
+		if (auto iter = hitAllocations.find(record); iter != hitAllocations.end())
+		{
+			hitRecords.free(iter->second);
+			hitAllocations.erase(iter);
+		}
+	}
+
+	auto ShaderBindingTable::setHitRecord(uint32_t record, uint32_t hitGroup, const void *data, uint32_t size) -> void
+	{
+		MAPLE_ASSERT(record < hitRecordCount && hitGroup < hitCount, "invalid hit record");
+		MAPLE_ASSERT(size <= hitRecordDataSize, "shader record data is larger than the record");
+
+		auto dst = &table[hitOffset + record * hitStride];
+		std::memcpy(dst, &handles[(rayGenCount + missCount + hitGroup) * handleSize], handleSize);
+		if (data != nullptr && size > 0)
+			std::memcpy(dst + handleSize, data, size);
+		dirtyRecords.emplace_back(record);
+	}
 
-			hitGroupSize += alignSize;
+	auto ShaderBindingTable::upload(const VulkanCommandBuffer *cmdBuffer) -> void
+	{
+		//vkCmdUpdateBuffer records the data into the command buffer, at most 64KB each.
+		constexpr VkDeviceSize MaxUpdateSize = 65536;
+
+		if (buffer == nullptr || buffer->getSize() < table.size())
+		{
+			createBuffer();
+			return;
 		}
+
+		if (dirtyRecords.empty())
+			return;
+
+		std::sort(dirtyRecords.begin(), dirtyRecords.end());
+		dirtyRecords.erase(std::unique(dirtyRecords.begin(), dirtyRecords.end()), dirtyRecords.end());
+
+		//the previous trace may still read the table.
+		VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_TRANSFER_BIT, barrier);
+
+		//flushes the barrier above.
+		auto cmd = cmdBuffer->getCommandBuffer();
+
+		for (size_t i = 0; i < dirtyRecords.size();)
+		{
+			auto first = dirtyRecords[i];
+			auto last  = first;
+			while (++i < dirtyRecords.size() && dirtyRecords[i] == last + 1 && (dirtyRecords[i] - first + 1) * hitStride <= MaxUpdateSize)
+				last = dirtyRecords[i];
+
+			auto offset = hitOffset + first * hitStride;
+			vkCmdUpdateBuffer(cmd, buffer->getVkBuffer(), offset, (last - first + 1) * hitStride, &table[offset]);
+		}
+		dirtyRecords.clear();
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, barrier);
+	}
+
+	auto ShaderBindingTable::getRayGenRegion() const -> VkStridedDeviceAddressRegionKHR
+	{
+		//the raygen region holds exactly one record.
+		return {buffer->getDeviceAddress(), handleStride, handleStride};
+	}
+
+	auto ShaderBindingTable::getMissRegion() const -> VkStridedDeviceAddressRegionKHR
+	{
+		return {buffer->getDeviceAddress() + missOffset, handleStride, handleStride * missCount};
+	}
+
+	auto ShaderBindingTable::getHitRegion() const -> VkStridedDeviceAddressRegionKHR
+	{
+		return {buffer->getDeviceAddress() + hitOffset, hitStride, static_cast<VkDeviceSize>(hitStride) * hitRecordCount};
 	}
 }        // namespace maple
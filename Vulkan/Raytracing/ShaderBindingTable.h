@@ -3,19 +3,33 @@
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "../VulkanHelper.h"
+#include "../../OffsetAllocator.h"
 
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 
 namespace maple
 {
 	class RayTracingProperties;
+	class VulkanBuffer;
+	class VulkanCommandBuffer;
 
+	/**
+	 * raygen, miss and hit regions of a ray tracing pipeline. the hit region starts with one record
+	 * per hit group, more records with inline shader record data (material indices, buffer addresses)
+	 * can be allocated per instance. a record of a geometry is found at the hitGroupOffset of its
+	 * instance plus the geometry index. records are kept on the host and only changed ones are
+	 * uploaded before the next trace.
+	 */
 	class ShaderBindingTable final
 	{
 	  public:
 		using Ptr = std::shared_ptr<ShaderBindingTable>;
 
+		static constexpr uint32_t InvalidRecord = UINT32_MAX;
+		static constexpr uint32_t MaxHitRecords = 1 << 20;
+
 		ShaderBindingTable(const std::shared_ptr<RayTracingProperties> &rayTracingProperties);
 
 		auto addShader(
@@ -23,6 +37,42 @@ namespace maple
 		    const std::vector<VkShaderModule> &                                            missGens,
 		    const std::vector<std::tuple<VkShaderModule, VkShaderModule, VkShaderModule>> &hits) -> void;
 
+		/**
+		 * bytes of data following the handle in every hit record, set before build.
+		 */
+		inline auto setHitRecordDataSize(uint32_t size)
+		{
+			hitRecordDataSize = size;
+		}
+
+		/**
+		 * reads the group handles of the pipeline and lays the table out.
+		 */
+		auto build(VkPipeline pipeline) -> void;
+
+		/**
+		 * count consecutive records, one per geometry of an instance. they start with the first hit
+		 * group and no data. returns InvalidRecord when the table is full.
+		 */
+		auto allocateHitRecords(uint32_t count) -> uint32_t;
+
+		auto freeHitRecords(uint32_t record) -> void;
+
+		/**
+		 * hitGroup indexes the hit groups passed to addShader, size is at most the record data size.
+		 */
+		auto setHitRecord(uint32_t record, uint32_t hitGroup, const void *data = nullptr, uint32_t size = 0) -> void;
+
+		/**
+		 * copies the changed records, called before tracing. a grown table is staged through the
+		 * upload command buffer of the frame.
+		 */
+		auto upload(const VulkanCommandBuffer *cmdBuffer) -> void;
+
+		auto getRayGenRegion() const -> VkStridedDeviceAddressRegionKHR;
+		auto getMissRegion() const -> VkStridedDeviceAddressRegionKHR;
+		auto getHitRegion() const -> VkStridedDeviceAddressRegionKHR;
+
 		inline auto &getStages() const
 		{
 			return stages;
@@ -32,23 +82,36 @@ namespace maple
 			return groups;
 		}
 
-		inline auto getHitGroupOffset() const
-		{
-			return rayGenSize + missGroupSize;
-		}
-		inline auto getMissGroupOffset() const
+		inline auto getBuffer() const
 		{
-			return rayGenSize;
+			return buffer;
 		}
 
 	  private:
+		auto createBuffer() -> void;
+
 		std::shared_ptr<RayTracingProperties> rayTracingProperties;
 
 		std::vector<VkPipelineShaderStageCreateInfo>      stages;
 		std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups;
 
-		VkDeviceSize rayGenSize    = 0;
-		VkDeviceSize hitGroupSize  = 0;
-		VkDeviceSize missGroupSize = 0;
+		uint32_t rayGenCount = 0;
+		uint32_t missCount   = 0;
+		uint32_t hitCount    = 0;
+
+		uint32_t     handleSize        = 0;
+		uint32_t     handleStride      = 0;
+		uint32_t     hitRecordDataSize = 0;
+		uint32_t     hitStride         = 0;
+		VkDeviceSize missOffset        = 0;
+		VkDeviceSize hitOffset         = 0;
+		uint32_t     hitRecordCount    = 0;        //records the buffer holds
+
+		std::vector<uint8_t>                   handles;
+		std::vector<uint8_t>                   table;        //host copy of the buffer
+		std::vector<uint32_t>                  dirtyRecords;
+		OffsetAllocator                        hitRecords{MaxHitRecords};
+		std::unordered_map<uint32_t, uint32_t> hitAllocations;        //record -> node
+		std::shared_ptr<VulkanBuffer>          buffer;
 	};
 }        // namespace maple
\ No newline at end of file
@@ -6,13 +6,97 @@
 #include "../../Console.h"
 #include "../VulkanBatchTask.h"
 #include "../VulkanCommandBuffer.h"
+#include "../VulkanContext.h"
 #include "../VulkanDevice.h"
 #include "../VulkanDebug.h"
 #include "RayTracingProperties.h"
+#include "../../SimdChecker.h"
+#include "../../TaskPool.h"
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
 
 namespace maple
 {
 #ifdef MAPLE_VULKAN
+	namespace
+	{
+		inline auto countTrailingZeros(uint64_t bits) -> uint32_t
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index, bits);
+			return index;
+#else
+			return __builtin_ctzll(bits);
+#endif
+		}
+
+		//instances below this are packed on the calling thread.
+		constexpr uint32_t MinInstancesPerTask = 4096;
+
+		inline auto packTransformWithSoftware(const mat4 &transform, VkTransformMatrixKHR &out) -> void
+		{
+			auto &c = transform.col;
+			out     = VkTransformMatrixKHR{{{c[0].x, c[1].x, c[2].x, c[3].x},
+			                                {c[0].y, c[1].y, c[2].y, c[3].y},
+			                                {c[0].z, c[1].z, c[2].z, c[3].z}}};
+		}
+
+		inline auto packTransformWithHardware(const mat4 &transform, VkTransformMatrixKHR &out) -> void
+		{
+#	if defined(__SSE__)
+			auto c0 = _mm_loadu_ps(&transform.col[0].x);
+			auto c1 = _mm_loadu_ps(&transform.col[1].x);
+			auto c2 = _mm_loadu_ps(&transform.col[2].x);
+			auto c3 = _mm_loadu_ps(&transform.col[3].x);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			//the last row (0, 0, 0, 1) is dropped.
+			_mm_storeu_ps(out.matrix[0], c0);
+			_mm_storeu_ps(out.matrix[1], c1);
+			_mm_storeu_ps(out.matrix[2], c2);
+#	elif defined(__ARM_NEON__)
+			//the de-interleaving load is the transpose.
+			auto rows = vld4q_f32(&transform.col[0].x);
+			vst1q_f32(out.matrix[0], rows.val[0]);
+			vst1q_f32(out.matrix[1], rows.val[1]);
+			vst1q_f32(out.matrix[2], rows.val[2]);
+#	else
+			packTransformWithSoftware(transform, out);
+#	endif
+		}
+
+		template <typename Tracked>
+		inline auto writeInstances(VkAccelerationStructureInstanceKHR *instances, Tracked *tracked, const uint32_t *slots, const InstanceBatch &batch, uint32_t begin, uint32_t end) -> void
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				auto  slot     = slots[batch.handles[i]];
+				auto &instance = instances[slot];
+				if (isSimdAvailable)
+					packTransformWithHardware(batch.transforms[i], instance.transform);
+				else
+					packTransformWithSoftware(batch.transforms[i], instance.transform);
+
+				instance.instanceCustomIndex                    = batch.customInstanceIds[i];
+				instance.mask                                   = batch.masks != nullptr ? batch.masks[i] : 0xFF;
+				instance.instanceShaderBindingTableRecordOffset = batch.hitGroupOffsets != nullptr ? batch.hitGroupOffsets[i] : 0;
+				instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+				if (batch.structures != nullptr)
+				{
+					tracked[slot]                           = {batch.structures[i], batch.structures[i]->getAddressGeneration()};
+					instance.accelerationStructureReference = batch.structures[i]->getDeviceAddress();
+				}
+				else
+				{
+					tracked[slot]                           = {};
+					instance.accelerationStructureReference = batch.instanceAddresses[i];
+				}
+			}
+		}
+	}        // namespace
+
 	VulkanAccelerationStructure::VulkanAccelerationStructure(const uint32_t maxInstanceCount)
 	{
 		instanceBufferDevice = std::make_shared<VulkanBuffer>(
@@ -48,6 +132,11 @@ namespace maple
 			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
 			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 			getBuildScratchSize(), nullptr, VMA_MEMORY_USAGE_GPU_ONLY, 0);
+
+		capacity = maxInstanceCount;
+		dirtySlots.resize((maxInstanceCount + 63) / 64);
+		trackedStructures.resize(maxInstanceCount);
+		slotHandles.reserve(maxInstanceCount);
 	}
 
 	VulkanAccelerationStructure::VulkanAccelerationStructure(uint64_t vertexAddress,
@@ -55,7 +144,8 @@ namespace maple
 		uint32_t vertexStride,
 		const std::vector<SubMesh>& subMeshes,
 		std::shared_ptr<BatchTask> batch,
-		bool opaque)
+		bool opaque,
+		bool allowUpdate)
 	{
 		//std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges;
 		//std::vector<VkAccelerationStructureGeometryKHR>       geometries;
@@ -98,6 +188,13 @@ namespace maple
 
 		MAPLE_ASSERT(!geometries.empty(), "error");
 
+		//refitted structures are rebuilt at full size every few frames, compacting them is not worth it.
+		VkBuildAccelerationStructureFlagsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+		if (allowUpdate)
+			buildFlags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+		else if (vkBatch->isCompactionEnabled())
+			buildFlags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+
 		// Create BLAS
 		Desc desc;
 		create(desc
@@ -105,16 +202,22 @@ namespace maple
 			.setGeometries(geometries)
 			.setMaxPrimitiveCounts(maxPrimitiveCounts)
 			.setType(VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR)
-			.setFlags(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR));
+			.setFlags(buildFlags));
+
+		batchTask = vkBatch;
 
 		vkBatch->buildBlas(this, geometries, buildRanges);
 	}
 
 	VulkanAccelerationStructure::~VulkanAccelerationStructure()
 	{
+		if (auto batch = batchTask.lock())
+			batch->cancel(this);
+
 		if (accelerationStructure != nullptr)
 		{
-			vkDestroyAccelerationStructureKHR(*VulkanDevice::get(), accelerationStructure, nullptr);
+			//the frames in flight may still trace against it.
+			VulkanContext::getDeletionQueue().destroy(DeletionType::AccelerationStructure, accelerationStructure);
 			accelerationStructure = nullptr;
 		}
 	}
@@ -127,7 +230,184 @@ namespace maple
 			geometryBuffer = (VkAccelerationStructureInstanceKHR*)mapHost();
 		}
 
-		memset(geometryBuffer, 0, sizeof(VkAccelerationStructureInstanceKHR) * 2048);
+		memset(geometryBuffer, 0, sizeof(VkAccelerationStructureInstanceKHR) * capacity);
+	}
+
+	auto VulkanAccelerationStructure::getHostInstances() -> VkAccelerationStructureInstanceKHR *
+	{
+		auto instances = (VkAccelerationStructureInstanceKHR *) instanceBufferHost->getMapped();
+		return instances != nullptr ? instances : (VkAccelerationStructureInstanceKHR *) mapHost();
+	}
+
+	auto VulkanAccelerationStructure::allocateInstance() -> uint32_t
+	{
+		if (liveInstances >= capacity)
+		{
+			LOGE("top level acceleration structure is full, {0} instances", capacity);
+			return InvalidInstance;
+		}
+
+		uint32_t handle;
+		if (!freeHandles.empty())
+		{
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+		}
+		else
+		{
+			handle = static_cast<uint32_t>(instanceSlots.size());
+			instanceSlots.emplace_back(InvalidInstance);
+		}
+
+		auto slot             = liveInstances++;
+		instanceSlots[handle] = slot;
+		slotHandles.emplace_back(handle);
+		rebuildPending        = true;
+
+		//a null reference keeps the instance inactive until it is set.
+		memset(&getHostInstances()[slot], 0, sizeof(VkAccelerationStructureInstanceKHR));
+		trackedStructures[slot] = {};
+		markDirty(slot);
+		return handle;
+	}
+
+	auto VulkanAccelerationStructure::freeInstance(uint32_t handle) -> void
+	{
+		MAPLE_ASSERT(handle < instanceSlots.size() && instanceSlots[handle] != InvalidInstance, "instance is not allocated");
+
+		//the last live instance fills the hole, the live range stays packed.
+		auto slot = instanceSlots[handle];
+		auto last = --liveInstances;
+		if (slot != last)
+		{
+			auto instances = getHostInstances();
+			instances[slot] = instances[last];
+			trackedStructures[slot]          = std::move(trackedStructures[last]);
+			slotHandles[slot]                = slotHandles[last];
+			instanceSlots[slotHandles[slot]] = slot;
+			markDirty(slot);
+		}
+		trackedStructures[last] = {};
+		slotHandles.pop_back();
+		instanceSlots[handle] = InvalidInstance;
+		freeHandles.emplace_back(handle);
+		rebuildPending        = true;
+	}
+
+	auto VulkanAccelerationStructure::setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, uint64_t instanceAddress, uint8_t mask, uint32_t hitGroupOffset) -> void
+	{
+		MAPLE_ASSERT(handle < instanceSlots.size() && instanceSlots[handle] != InvalidInstance, "instance is not allocated");
+
+		auto  slot     = instanceSlots[handle];
+		auto &instance = getHostInstances()[slot];
+
+		instance.instanceCustomIndex                    = customInstanceId;
+		instance.mask                                   = mask;
+		instance.instanceShaderBindingTableRecordOffset = hitGroupOffset;
+		instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+		instance.accelerationStructureReference         = instanceAddress;
+		if (isSimdAvailable)
+			packTransformWithHardware(transform, instance.transform);
+		else
+			packTransformWithSoftware(transform, instance.transform);
+		trackedStructures[slot] = {};
+		markDirty(slot);
+	}
+
+	auto VulkanAccelerationStructure::setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, const Ptr &structure, uint8_t mask, uint32_t hitGroupOffset) -> void
+	{
+		MAPLE_ASSERT(structure != nullptr, "bottom level structure is null");
+		setInstance(handle, transform, customInstanceId, structure->getDeviceAddress(), mask, hitGroupOffset);
+		trackedStructures[instanceSlots[handle]] = {structure, structure->getAddressGeneration()};
+	}
+
+	auto VulkanAccelerationStructure::setInstances(const InstanceBatch &batch) -> void
+	{
+		PROFILE_FUNCTION();
+		if (batch.count == 0)
+			return;
+
+		auto instances = getHostInstances();
+		auto tracked   = trackedStructures.data();
+		auto slots     = instanceSlots.data();
+
+		//handles are distinct, so chunks write disjoint instances of the mapped buffer.
+		auto tasks = std::min(TaskPool::getWorkerCount() + 1, batch.count / MinInstancesPerTask);
+
+		//dirty bits of different chunks share words, they are set up front on this thread.
+		for (uint32_t i = 0; i < batch.count; i++)
+		{
+			MAPLE_ASSERT(batch.handles[i] < instanceSlots.size() && instanceSlots[batch.handles[i]] != InvalidInstance, "instance is not allocated");
+			markDirty(instanceSlots[batch.handles[i]]);
+		}
+
+		//the persistent workers of the pool, creating threads per call costs more than the packing saves.
+		TaskPool::parallelFor(batch.count, tasks, [&](uint32_t begin, uint32_t end) {
+			writeInstances(instances, tracked, slots, batch, begin, end);
+		});
+	}
+
+	auto VulkanAccelerationStructure::uploadInstances(const CommandBuffer *cmd) -> void
+	{
+		//gaps up to this many clean instances are copied along instead of starting a new region.
+		constexpr uint32_t MergeGap = 4;
+
+		refreshAddresses();
+		if (dirtyBegin >= dirtyEnd)
+			return;
+
+		//slots freed at the end of the table do not need to be uploaded.
+		auto end = std::min(dirtyEnd, liveInstances);
+
+		uploadRanges.clear();
+		for (auto word = dirtyBegin / 64; word * 64 < end; word++)
+		{
+			auto bits = dirtySlots[word];
+			dirtySlots[word] = 0;
+			while (bits != 0)
+			{
+				auto slot = word * 64 + countTrailingZeros(bits);
+				bits &= bits - 1;
+				if (slot >= end)
+					break;
+
+				if (!uploadRanges.empty() && slot <= static_cast<uint32_t>(uploadRanges.back().instanceOffset + uploadRanges.back().count) + MergeGap)
+					uploadRanges.back().count = slot - uploadRanges.back().instanceOffset + 1;
+				else
+					uploadRanges.push_back({1, static_cast<int32_t>(slot)});
+			}
+		}
+		for (auto word = end / 64; word * 64 < dirtyEnd; word++)
+			dirtySlots[word] = 0;
+
+		dirtyBegin = UINT32_MAX;
+		dirtyEnd   = 0;
+
+		if (!uploadRanges.empty())
+			copyToGPU(cmd, uploadRanges);
+	}
+
+	auto VulkanAccelerationStructure::refreshAddresses() -> void
+	{
+		PROFILE_FUNCTION();
+		auto changes = getAddressChanges();
+		if (changes == seenAddressChanges)
+			return;
+		seenAddressChanges = changes;
+
+		auto instances = getHostInstances();
+		for (uint32_t slot = 0; slot < liveInstances; slot++)
+		{
+			auto &tracked = trackedStructures[slot];
+			if (tracked.structure == nullptr || tracked.generation == tracked.structure->getAddressGeneration())
+				continue;
+
+			//the old structure is retired with the frame which moved it, the next build has to pick up the new one.
+			tracked.generation                             = tracked.structure->getAddressGeneration();
+			instances[slot].accelerationStructureReference = tracked.structure->getDeviceAddress();
+			rebuildPending                                 = true;
+			markDirty(slot);
+		}
 	}
 
 	auto VulkanAccelerationStructure::updateTLAS(const mat4& transform, uint32_t instanceId, uint32_t customInstanceId, uint64_t instanceAddress) -> uint64_t
@@ -154,7 +434,17 @@ namespace maple
 	auto VulkanAccelerationStructure::updateBLAS(std::shared_ptr<BatchTask> batch) -> void
 	{
 		auto vkBatch = std::static_pointer_cast<VulkanBatchTask>(batch);
-		vkBatch->buildBlas(this, geometries, buildRanges);
+		//a rebuild needs the worst case size again.
+		if (compacted)
+		{
+			recreate(buildSizesInfo.accelerationStructureSize);
+			compacted = false;
+		}
+		batchTask = vkBatch;
+
+		auto refit = (flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR) && refits < rebuildInterval;
+		refits     = refit ? refits + 1 : 0;
+		vkBatch->buildBlas(this, geometries, buildRanges, refit);
 	}
 
 	auto VulkanAccelerationStructure::resetTLAS(uint32_t instanceId) -> void
@@ -168,10 +458,62 @@ namespace maple
 		memset(&vkASInstance, 0, sizeof(VkAccelerationStructureInstanceKHR));
 	}
 
+	auto VulkanAccelerationStructure::compact(VkCommandBuffer cmd, VkDeviceSize compactedSize) -> void
+	{
+		if (compacted || compactedSize == 0 || compactedSize >= size)
+			return;
+
+		//the source is destroyed with the frame, after the copy has executed.
+		auto source = accelerationStructure;
+		recreate(compactedSize);
+
+		VkCopyAccelerationStructureInfoKHR copyInfo{};
+		copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+		copyInfo.src   = source;
+		copyInfo.dst   = accelerationStructure;
+		copyInfo.mode  = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+		vkCmdCopyAccelerationStructureKHR(cmd, &copyInfo);
+
+		compacted = true;
+	}
+
+	auto VulkanAccelerationStructure::recreate(VkDeviceSize newSize) -> void
+	{
+		if (accelerationStructure != nullptr)
+		{
+			//handles are destroyed grouped by type, the structure goes before the buffer it lives on.
+			VulkanContext::getDeletionQueue().destroy(DeletionType::AccelerationStructure, accelerationStructure);
+			buffer = nullptr;
+		}
+
+		buffer = std::make_shared<VulkanBuffer>(
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR 
+			| VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT ,
+			newSize, nullptr, VMA_MEMORY_USAGE_GPU_ONLY, 0);
+
+		VkAccelerationStructureCreateInfoKHR createInfo{};
+		createInfo.sType  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+		createInfo.type   = type;
+		createInfo.buffer = buffer->getVkBuffer();
+		createInfo.size   = newSize;
+
+		VK_CHECK_RESULT(vkCreateAccelerationStructureKHR(*VulkanDevice::get(), &createInfo, nullptr, &accelerationStructure));
+
+		VkAccelerationStructureDeviceAddressInfoKHR addressInfo{};
+		addressInfo.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+		addressInfo.accelerationStructure = accelerationStructure;
+
+		deviceAddress = vkGetAccelerationStructureDeviceAddressKHR(*VulkanDevice::get(), &addressInfo);
+		size          = newSize;
+		//top level instances following this structure re-read the address on their next upload.
+		onAddressChanged();
+	}
+
 	auto VulkanAccelerationStructure::create(const Desc& desc) -> void
 	{
 		buildGeometryInfo = desc.buildGeometryInfo;
 		flags = desc.buildGeometryInfo.flags;
+		type = desc.createInfo.type;
 
 		buildSizesInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 
@@ -191,6 +533,7 @@ namespace maple
 
 		createInfo.buffer = buffer->getVkBuffer();
 		createInfo.size = buildSizesInfo.accelerationStructureSize;
+		size = buildSizesInfo.accelerationStructureSize;
 
 		VK_CHECK_RESULT(vkCreateAccelerationStructureKHR(*VulkanDevice::get(), &createInfo, nullptr, &accelerationStructure));
 
@@ -364,7 +707,13 @@ namespace maple
 			buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 			buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
 			buildInfo.flags = flags;
-			buildInfo.srcAccelerationStructure = built ? accelerationStructure : VK_NULL_HANDLE;
+			//an update has to keep the instance count of the last build. instances moved between slots by
+			//allocate or free, or pointed at moved structures, would be refitted against the old nodes.
+			//refits also lose quality over time.
+			auto update = built && instanceSize == lastInstanceCount && !rebuildPending && refits < rebuildInterval;
+			refits      = update ? refits + 1 : 0;
+			buildInfo.mode                     = update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+			buildInfo.srcAccelerationStructure = update ? accelerationStructure : VK_NULL_HANDLE;
 			buildInfo.dstAccelerationStructure = accelerationStructure;
 			buildInfo.geometryCount = 1;
 			buildInfo.pGeometries = &geometry;
@@ -390,7 +739,9 @@ namespace maple
 				vkCmdPipelineBarrier(vkCmd->getCommandBuffer(), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &memoryBarrier, 0, 0, 0, 0);
 			}
 
-			built = true;
+			built             = true;
+			rebuildPending    = false;
+			lastInstanceCount = instanceSize;
 
 			debug_utils::cmdEndLabel();
 		}
@@ -5,11 +5,13 @@
 
 #include "../../AccelerationStructure.h"
 #include "../VulkanBuffer.h"
+#include <algorithm>
 
 namespace maple
 {
 	class RayTracingProperties;
 	class BatchTask;
+	class VulkanBatchTask;
 
 	class VulkanAccelerationStructure : public AccelerationStructure
 	{
@@ -36,7 +38,8 @@ namespace maple
 			uint32_t vertexStride,
 			const std::vector<SubMesh>& subMeshes,
 			std::shared_ptr<BatchTask> batch, 
-			bool opaque = true);
+			bool opaque = true,
+			bool allowUpdate = false);
 
 		virtual ~VulkanAccelerationStructure();
 
@@ -67,6 +70,26 @@ namespace maple
 			return flags;
 		}
 
+		/**
+		 * bytes of the buffer backing the structure.
+		 */
+		inline auto getSize() const -> uint64_t
+		{
+			return size;
+		}
+
+		inline auto isCompacted() const
+		{
+			return compacted;
+		}
+
+		/**
+		 * records a compacting copy into a buffer of compactedSize, the old structure is retired
+		 * through the deletion queue. the device address changes, top level instances set with
+		 * this structure pick up the new one on their next upload.
+		 */
+		auto compact(VkCommandBuffer cmd, VkDeviceSize compactedSize) -> void;
+
 		auto updateTLAS(const mat4 &transform, uint32_t instanceId, uint32_t customInstanceId, uint64_t instanceAddress) -> uint64_t override;
 
 		auto updateBLAS(std::shared_ptr<BatchTask> batch) -> void override;
@@ -88,21 +111,83 @@ namespace maple
 			return built;
 		};
 
+		auto allocateInstance() -> uint32_t override;
+
+		auto freeInstance(uint32_t handle) -> void override;
+
+		auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, uint64_t instanceAddress, uint8_t mask, uint32_t hitGroupOffset) -> void override;
+
+		auto setInstance(uint32_t handle, const mat4 &transform, uint32_t customInstanceId, const Ptr &structure, uint8_t mask, uint32_t hitGroupOffset) -> void override;
+
+		auto setInstances(const InstanceBatch &batch) -> void override;
+
+		auto uploadInstances(const CommandBuffer *cmd) -> void override;
+
+		inline auto getInstanceCount() const -> uint32_t override
+		{
+			return liveInstances;
+		}
+
 	  protected:
 		auto create(const Desc &desc) -> void;
 
+		/**
+		 * replaces the structure by an empty one of the given size.
+		 */
+		auto recreate(VkDeviceSize newSize) -> void;
+
 		VulkanBuffer::Ptr                           buffer;
 		VkDeviceAddress                             deviceAddress = 0;
 		VkBuildAccelerationStructureFlagsKHR        flags         = VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
 		VkAccelerationStructureBuildSizesInfoKHR    buildSizesInfo{};
 		VkAccelerationStructureKHR                  accelerationStructure = nullptr;
 		VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo{};
-		
+		VkAccelerationStructureTypeKHR              type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+		VkDeviceSize                                size = 0;
+
 	  private:
-		bool              built = false;
-		VulkanBuffer::Ptr instanceBufferHost;
-		VulkanBuffer::Ptr instanceBufferDevice;
-		VulkanBuffer::Ptr scratchBuffer;
+		struct TrackedStructure
+		{
+			AccelerationStructure::Ptr structure;
+			uint32_t                   generation = 0;
+		};
+
+		auto getHostInstances() -> VkAccelerationStructureInstanceKHR *;
+
+		/**
+		 * re-reads the addresses of tracked instances whose structure moved and marks them dirty.
+		 */
+		auto refreshAddresses() -> void;
+
+		inline auto markDirty(uint32_t slot)
+		{
+			dirtySlots[slot / 64] |= 1ull << (slot % 64);
+			dirtyBegin = std::min(dirtyBegin, slot);
+			dirtyEnd   = std::max(dirtyEnd, slot + 1);
+		}
+
+		bool                           built          = false;
+		bool                           compacted      = false;
+		bool                           rebuildPending = false;        //instances allocated, freed or re-pointed since the last build
+		uint32_t                       refits         = 0;            //since the last full build
+		std::weak_ptr<VulkanBatchTask> batchTask;
+		VulkanBuffer::Ptr              instanceBufferHost;
+		VulkanBuffer::Ptr              instanceBufferDevice;
+		VulkanBuffer::Ptr              scratchBuffer;
+		//managed instance table, slots [0, liveInstances) are live.
+		uint32_t                      capacity           = 0;
+		uint32_t                      liveInstances      = 0;
+		uint32_t                      lastInstanceCount  = 0;
+		uint32_t                      dirtyBegin         = UINT32_MAX;
+		uint32_t                      dirtyEnd           = 0;
+		uint64_t                      seenAddressChanges = 0;
+		std::vector<uint32_t>         instanceSlots;            //handle -> slot
+		std::vector<uint32_t>         slotHandles;              //slot -> handle
+		std::vector<uint32_t>         freeHandles;
+		std::vector<TrackedStructure> trackedStructures;        //slot -> structure the instance follows
+		std::vector<uint64_t>         dirtySlots;
+		std::vector<BuildRange>       uploadRanges;
+
 		//for bottom level..
 		std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges;
 		std::vector<VkAccelerationStructureGeometryKHR>       geometries;
@@ -24,14 +24,6 @@
 namespace maple
 {
 #ifdef MAPLE_VULKAN
-	namespace
-	{
-		inline auto alignedSize(uint32_t value, uint32_t alignment) -> uint32_t
-		{
-			return (value + alignment - 1) & ~(alignment - 1);
-		}
-	}        // namespace
-
 	VulkanRaytracingPipeline::VulkanRaytracingPipeline(const PipelineInfo &info)
 	{
 		init(info);
@@ -114,40 +106,8 @@ namespace maple
 
 		VulkanHelper::setObjectName(info.pipelineName, (uint64_t) pipeline, VK_OBJECT_TYPE_PIPELINE);
 
-		auto groupHandleSize = rayTracingProperties->getShaderGroupHandleSize();
-
-		auto alignSize = alignedSize(groupHandleSize, rayTracingProperties->getShaderGroupBaseAlignment());
-
-		const size_t groupCount = sbt->getGroups().size();
-		size_t       sbtSize    = groupCount * alignSize;
-
-		std::vector<uint8_t> mem(sbtSize);
-
-		VK_CHECK_RESULT(vkGetRayTracingShaderGroupHandlesKHR(
-		    *VulkanDevice::get(),
-		    pipeline,
-		    0,
-		    static_cast<uint32_t>(groupCount),
-		    sbtSize,
-		    mem.data()));
-
-		buffer = std::make_shared<VulkanBuffer>(
-		    VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-		    sbtSize,
-		    nullptr,
-		    VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT);
-
-		buffer->map();
-		auto dst = (uint8_t *) buffer->getMapped();
-		auto src = mem.data();
-
-		for (int32_t i = 0; i < groupCount; i++)
-		{
-			memcpy(dst, src, groupHandleSize);
-
-			dst += alignSize;
-			src += groupHandleSize;
-		}
+		sbt->setHitRecordDataSize(info.hitRecordDataSize);
+		sbt->build(pipeline);
 
 		return true;
 	}
@@ -155,24 +115,24 @@ namespace maple
 	auto VulkanRaytracingPipeline::bind(const CommandBuffer *cmdBuffer, uint32_t layer, int32_t cubeFace, int32_t mipMapLevel) -> FrameBuffer *
 	{
 		PROFILE_FUNCTION();
-		vkCmdBindPipeline(static_cast<const VulkanCommandBuffer *>(cmdBuffer)->getCommandBuffer(),
-		                  VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-		                  pipeline);
+		static_cast<const VulkanCommandBuffer *>(cmdBuffer)->bindPipeline(VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
 		return nullptr;
 	}
 
 	auto VulkanRaytracingPipeline::traceRays(const CommandBuffer *commandBuffer, uint32_t width, uint32_t height, uint32_t depth) -> void
 	{
-		VkDeviceSize groupSize   = alignedSize(rayTracingProperties->getShaderGroupHandleSize(), rayTracingProperties->getShaderGroupBaseAlignment());
-		VkDeviceSize groupStride = groupSize;
-		//TODO ....
-		const VkStridedDeviceAddressRegionKHR raygenSbt   = {buffer->getDeviceAddress(), groupStride, groupSize};
-		const VkStridedDeviceAddressRegionKHR missSbt     = {buffer->getDeviceAddress() + sbt->getMissGroupOffset(), groupStride, groupSize * missGens.size()};
-		const VkStridedDeviceAddressRegionKHR hitSbt      = {buffer->getDeviceAddress() + sbt->getHitGroupOffset(), groupStride, groupSize * hitsGen.size()};
+		auto vkCmdBuffer = static_cast<const VulkanCommandBuffer *>(commandBuffer);
+		sbt->upload(vkCmdBuffer);
+
+		//flushes the barriers of the upload.
+		auto cmd = vkCmdBuffer->getCommandBuffer();
+
+		const VkStridedDeviceAddressRegionKHR raygenSbt   = sbt->getRayGenRegion();
+		const VkStridedDeviceAddressRegionKHR missSbt     = sbt->getMissRegion();
+		const VkStridedDeviceAddressRegionKHR hitSbt      = sbt->getHitRegion();
 		const VkStridedDeviceAddressRegionKHR callableSbt = {0, 0, 0};
 
-		vkCmdTraceRaysKHR(static_cast<const VulkanCommandBuffer *>(commandBuffer)->getCommandBuffer(),
-		                  &raygenSbt, &missSbt, &hitSbt, &callableSbt, width, height, depth);
+		vkCmdTraceRaysKHR(cmd, &raygenSbt, &missSbt, &hitSbt, &callableSbt, width, height, depth);
 	}
 #endif
 };        // namespace maple
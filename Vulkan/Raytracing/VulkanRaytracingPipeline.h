@@ -5,6 +5,7 @@
 
 #include "../VulkanHelper.h"
 #include "../VulkanPipeline.h"
+#include "ShaderBindingTable.h"
 
 #include <functional>
 #include <memory>
@@ -12,7 +13,6 @@
 
 namespace maple
 {
-	class ShaderBindingTable;
 	class RayTracingProperties;
 
 	class VulkanRaytracingPipeline : public VulkanPipeline
@@ -53,7 +53,7 @@ namespace maple
 
 		inline auto getSbtBuffer() const
 		{
-			return buffer;
+			return sbt->getBuffer();
 		}
 
 		auto traceRays(const CommandBuffer *commandBuffer, uint32_t width, uint32_t height, uint32_t depth) -> void override;
@@ -61,7 +61,6 @@ namespace maple
 	  private:
 		std::shared_ptr<ShaderBindingTable>   sbt;
 		std::shared_ptr<RayTracingProperties> rayTracingProperties;
-		std::shared_ptr<VulkanBuffer>         buffer;
 
 		std::vector<VkShaderModule>                                             rayGens;
 		std::vector<VkShaderModule>                                             missGens;
@@ -140,6 +140,8 @@ namespace maple
 		{
 			ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), static_cast<VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer());
 		}
+		//imgui binds its own pipeline, sets and push constants through the raw handle.
+		static_cast<VulkanCommandBuffer*>(commandBuffer)->invalidateBindState();
 		renderPass->endRenderPass(commandBuffer);
 	}
 
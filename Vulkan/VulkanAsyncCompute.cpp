@@ -0,0 +1,414 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanAsyncCompute.h"
+#include "../Console.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanCommandRecycler.h"
+#include "VulkanContext.h"
+#include "VulkanDevice.h"
+#include "VulkanStorageBuffer.h"
+#include "VulkanSwapChain.h"
+#include "VulkanTexture.h"
+#include <algorithm>
+
+namespace maple
+{
+	namespace
+	{
+		constexpr VkAccessFlags GRAPHICS_READ_ACCESS = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+		                                               VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		struct SharedImage
+		{
+			VkTexture *          texture;
+			bool                 depth;
+			VkImageLayout        oldLayout;
+			VkImageLayout        graphicsLayout;
+			VkPipelineStageFlags graphicsStage;
+		};
+
+		struct SharedBuffer
+		{
+			VkBuffer             buffer;
+			VkPipelineStageFlags graphicsStage;
+		};
+
+		inline auto toVkTexture(Texture *texture, bool &depth) -> VkTexture *
+		{
+			depth = false;
+			if (texture->getType() == TextureType::Color)
+				return static_cast<VulkanTexture2D *>(texture);
+			if (texture->getType() == TextureType::Depth)
+			{
+				depth = true;
+				return static_cast<VulkanTextureDepth *>(texture);
+			}
+			LOGW("[AsyncCompute] unsupported texture type for {0}", texture->getName());
+			return nullptr;
+		}
+
+		inline auto imageBarrier(const SharedImage &image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+		                         uint32_t srcFamily, uint32_t dstFamily)
+		{
+			VkImageMemoryBarrier barrier{};
+			barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout                       = oldLayout;
+			barrier.newLayout                       = newLayout;
+			barrier.srcAccessMask                   = srcAccess;
+			barrier.dstAccessMask                   = dstAccess;
+			barrier.srcQueueFamilyIndex             = srcFamily;
+			barrier.dstQueueFamilyIndex             = dstFamily;
+			barrier.image                           = image.texture->getImage();
+			barrier.subresourceRange.aspectMask     = image.depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel   = 0;
+			barrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+			return barrier;
+		}
+
+		inline auto bufferBarrier(VkBuffer buffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess, uint32_t srcFamily, uint32_t dstFamily)
+		{
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask       = srcAccess;
+			barrier.dstAccessMask       = dstAccess;
+			barrier.srcQueueFamilyIndex = srcFamily;
+			barrier.dstQueueFamilyIndex = dstFamily;
+			barrier.buffer              = buffer;
+			barrier.offset              = 0;
+			barrier.size                = VK_WHOLE_SIZE;
+			return barrier;
+		}
+
+		inline auto submitTimeline(VkQueue queue, VkCommandBuffer cmd, VkSemaphore waitSemaphore, uint64_t waitValue, VkPipelineStageFlags waitStage,
+		                           VkSemaphore signalSemaphore, uint64_t signalValue)
+		{
+			VkTimelineSemaphoreSubmitInfo timelineInfo{};
+			timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.waitSemaphoreValueCount   = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+			timelineInfo.pWaitSemaphoreValues      = &waitValue;
+			timelineInfo.signalSemaphoreValueCount = 1;
+			timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext                = &timelineInfo;
+			submitInfo.waitSemaphoreCount   = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+			submitInfo.pWaitSemaphores      = &waitSemaphore;
+			submitInfo.pWaitDstStageMask    = &waitStage;
+			submitInfo.commandBufferCount   = 1;
+			submitInfo.pCommandBuffers      = &cmd;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores    = &signalSemaphore;
+			VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+		}
+
+		inline auto collectShared(const std::vector<AsyncComputeJob> &jobs, std::vector<SharedBuffer> &buffers, std::vector<SharedImage> &images)
+		{
+			for (auto &job : jobs)
+			{
+				for (auto &buffer : job.buffers)
+				{
+					auto handle = static_cast<VulkanStorageBuffer *>(buffer.get())->getHandle();
+					auto iter   = std::find_if(buffers.begin(), buffers.end(), [&](auto &b) { return b.buffer == handle; });
+					if (iter == buffers.end())
+						buffers.push_back({handle, job.graphicsStage});
+					else
+						iter->graphicsStage |= job.graphicsStage;
+				}
+
+				for (auto &image : job.images)
+				{
+					bool depth     = false;
+					auto vkTexture = toVkTexture(image.get(), depth);
+					if (vkTexture == nullptr)
+						continue;
+					auto iter = std::find_if(images.begin(), images.end(), [&](auto &i) { return i.texture == vkTexture; });
+					if (iter == images.end())
+					{
+						images.push_back({vkTexture, depth, vkTexture->getImageLayout(), job.graphicsLayout, job.graphicsStage});
+					}
+					else
+					{
+						//the last job touching the image decides how graphics gets it back.
+						iter->graphicsLayout = job.graphicsLayout;
+						iter->graphicsStage |= job.graphicsStage;
+					}
+				}
+			}
+		}
+	}        // namespace
+
+	VulkanAsyncCompute::VulkanAsyncCompute()
+	{
+		auto &indices     = VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices();
+		graphicsFamily    = indices.graphicsFamily.value();
+		computeFamily     = indices.computeFamily.value();
+		timelineSupported = VulkanDevice::get()->getPhysicalDevice()->isTimelineSemaphoreSupported();
+
+		if (!timelineSupported)
+		{
+			LOGW("[AsyncCompute] timeline semaphores are not supported, compute jobs run inline on graphics");
+			return;
+		}
+
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue  = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreInfo, nullptr, &graphicsTimeline));
+		VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreInfo, nullptr, &computeTimeline));
+	}
+
+	VulkanAsyncCompute::~VulkanAsyncCompute()
+	{
+		if (graphicsTimeline != VK_NULL_HANDLE)
+			vkDestroySemaphore(*VulkanDevice::get(), graphicsTimeline, nullptr);
+		if (computeTimeline != VK_NULL_HANDLE)
+			vkDestroySemaphore(*VulkanDevice::get(), computeTimeline, nullptr);
+	}
+
+	auto VulkanAsyncCompute::submit(const std::vector<AsyncComputeJob> &jobs) -> uint64_t
+	{
+		PROFILE_FUNCTION();
+		auto swapChain = std::static_pointer_cast<VulkanSwapChain>(VulkanContext::get()->getSwapChain());
+		MAPLE_ASSERT(swapChain->isRecording(), "async compute jobs have to be submitted while a frame is recording");
+
+		if (!timelineSupported)
+			return recordInline(jobs);
+
+		std::vector<SharedBuffer> buffers;
+		std::vector<SharedImage>  images;
+		collectShared(jobs, buffers, images);
+
+		//released to graphics already, a second release would not match the pending acquire.
+		for (auto &buffer : buffers)
+		{
+			MAPLE_ASSERT(std::none_of(queued.buffers.begin(), queued.buffers.end(), [&](auto &b) { return b.buffer == buffer.buffer; }),
+			             "a buffer can only be shared with the jobs of one submit per frame");
+		}
+		for (auto &image : images)
+		{
+			MAPLE_ASSERT(std::none_of(queued.images.begin(), queued.images.end(), [&](auto &i) { return i.image == image.texture->getImage(); }),
+			             "an image can only be shared with the jobs of one submit per frame");
+		}
+
+		const auto frameIndex = swapChain->getCurrentBufferIndex();
+		const bool transfer   = graphicsFamily != computeFamily;
+
+		if (transfer && (!buffers.empty() || !images.empty()))
+		{
+			std::vector<VkBufferMemoryBarrier> bufferBarriers;
+			std::vector<VkImageMemoryBarrier>  imageBarriers;
+			for (auto &buffer : buffers)
+			{
+				bufferBarriers.emplace_back(bufferBarrier(buffer.buffer, VK_ACCESS_MEMORY_WRITE_BIT, 0, graphicsFamily, computeFamily));
+			}
+			for (auto &image : images)
+			{
+				imageBarriers.emplace_back(imageBarrier(image, image.oldLayout, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_MEMORY_WRITE_BIT, 0, graphicsFamily, computeFamily));
+			}
+
+			//graphics does not touch the resources in this frame, so the release goes in its own submission ahead of it.
+			auto releaseCmd = VulkanContext::get()->getCommandRecycler()->requestCommandBuffer(frameIndex, graphicsFamily);
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(releaseCmd, &beginInfo));
+			vkCmdPipelineBarrier(releaseCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+			                     bufferBarriers.size(), bufferBarriers.data(), imageBarriers.size(), imageBarriers.data());
+			VK_CHECK_RESULT(vkEndCommandBuffer(releaseCmd));
+
+			submitTimeline(VulkanDevice::get()->getGraphicsQueue(), releaseCmd, VK_NULL_HANDLE, 0, 0, graphicsTimeline, ++graphicsValue);
+		}
+
+		VulkanCommandBuffer cmd(VulkanContext::get()->getCommandRecycler()->requestCommandBuffer(frameIndex, computeFamily), CommandBufferType::Compute);
+		cmd.beginRecording();
+
+		//acquire on compute, chained to the semaphore wait stage. (same family: only the layout transition is left)
+		const uint32_t srcFamily = transfer ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+		const uint32_t dstFamily = transfer ? computeFamily : VK_QUEUE_FAMILY_IGNORED;
+		for (auto &image : images)
+		{
+			cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			                    imageBarrier(image, image.oldLayout, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, srcFamily, dstFamily));
+		}
+		if (transfer)
+		{
+			for (auto &buffer : buffers)
+			{
+				cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				                    bufferBarrier(buffer.buffer, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, srcFamily, dstFamily));
+			}
+		}
+
+		for (auto i = 0; i < jobs.size(); i++)
+		{
+			if (i > 0)
+			{
+				//jobs of one submission may consume each other's results.
+				VkMemoryBarrier memoryBarrier{};
+				memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+				cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, memoryBarrier);
+			}
+			if (jobs[i].record)
+				jobs[i].record(&cmd);
+		}
+
+		//release back to graphics.
+		for (auto &image : images)
+		{
+			cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			                    imageBarrier(image, VK_IMAGE_LAYOUT_GENERAL, image.graphicsLayout, VK_ACCESS_SHADER_WRITE_BIT, 0, dstFamily, srcFamily));
+		}
+		if (transfer)
+		{
+			for (auto &buffer : buffers)
+			{
+				cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				                    bufferBarrier(buffer.buffer, VK_ACCESS_SHADER_WRITE_BIT, 0, dstFamily, srcFamily));
+			}
+		}
+		cmd.endRecording();
+
+		submitTimeline(VulkanDevice::get()->getComputeQueue(), cmd.getCommandBuffer(), graphicsTimeline, graphicsValue,
+		               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, computeTimeline, ++computeValue);
+
+		//the acquire on graphics waits for the next frame, see onFrameBegin.
+		for (auto &image : images)
+		{
+			if (transfer)
+			{
+				queued.images.emplace_back(imageBarrier(image, VK_IMAGE_LAYOUT_GENERAL, image.graphicsLayout, 0, GRAPHICS_READ_ACCESS, computeFamily, graphicsFamily));
+			}
+			image.texture->setImageLayout(image.graphicsLayout);
+		}
+		if (transfer)
+		{
+			for (auto &buffer : buffers)
+			{
+				queued.buffers.emplace_back(bufferBarrier(buffer.buffer, 0, GRAPHICS_READ_ACCESS, computeFamily, graphicsFamily));
+			}
+		}
+
+		queued.value = computeValue;
+		for (auto &job : jobs)
+		{
+			queued.stages |= job.graphicsStage;
+		}
+		return computeValue;
+	}
+
+	auto VulkanAsyncCompute::recordInline(const std::vector<AsyncComputeJob> &jobs) -> uint64_t
+	{
+		PROFILE_FUNCTION();
+		auto graphicsCmd = static_cast<VulkanCommandBuffer *>(VulkanContext::get()->getSwapChain()->getCurrentCommandBuffer());
+
+		for (auto &job : jobs)
+		{
+			for (auto &image : job.images)
+			{
+				bool depth = false;
+				if (auto vkTexture = toVkTexture(image.get(), depth))
+					vkTexture->transitionImage(VK_IMAGE_LAYOUT_GENERAL, graphicsCmd);
+			}
+
+			if (job.record)
+				job.record(graphicsCmd);
+
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = GRAPHICS_READ_ACCESS | VK_ACCESS_SHADER_WRITE_BIT;
+			graphicsCmd->pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, job.graphicsStage | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, memoryBarrier);
+
+			for (auto &image : job.images)
+			{
+				bool depth = false;
+				if (auto vkTexture = toVkTexture(image.get(), depth))
+					vkTexture->transitionImage(job.graphicsLayout, graphicsCmd);
+			}
+		}
+		//ordered on the graphics queue already, nothing to wait for.
+		return 0;
+	}
+
+	auto VulkanAsyncCompute::onFrameBegin() -> void
+	{
+		PROFILE_FUNCTION();
+		if (!timelineSupported || queued.value == 0)
+			return;
+
+		const auto frameIndex = VulkanContext::get()->getSwapChain()->getCurrentBufferIndex();
+		auto       acquireCmd = VulkanContext::get()->getCommandRecycler()->requestCommandBuffer(frameIndex, graphicsFamily);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK_RESULT(vkBeginCommandBuffer(acquireCmd, &beginInfo));
+
+		//chains the semaphore wait to the consuming stages of everything submitted after it on this queue.
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = 0;
+		memoryBarrier.dstAccessMask = GRAPHICS_READ_ACCESS;
+		vkCmdPipelineBarrier(acquireCmd, queued.stages, queued.stages, 0, 1, &memoryBarrier,
+		                     queued.buffers.size(), queued.buffers.data(), queued.images.size(), queued.images.data());
+		VK_CHECK_RESULT(vkEndCommandBuffer(acquireCmd));
+
+		submitTimeline(VulkanDevice::get()->getGraphicsQueue(), acquireCmd, computeTimeline, queued.value, queued.stages, graphicsTimeline, ++graphicsValue);
+
+		queued.value  = 0;
+		queued.stages = 0;
+		queued.buffers.clear();
+		queued.images.clear();
+	}
+
+	auto VulkanAsyncCompute::onGraphicsSubmit(std::vector<VkPipelineStageFlags> &waitStages, std::vector<VkSemaphore> &waitSemaphores, std::vector<uint64_t> &waitValues,
+	                                          std::vector<VkSemaphore> &signalSemaphores, std::vector<uint64_t> &signalValues) -> void
+	{
+		if (!timelineSupported)
+			return;
+
+		//binary semaphores in the same submission still need a (ignored) value.
+		waitValues.resize(waitSemaphores.size(), 0);
+		signalValues.resize(signalSemaphores.size(), 0);
+
+		signalSemaphores.emplace_back(graphicsTimeline);
+		signalValues.emplace_back(++graphicsValue);
+	}
+
+	auto VulkanAsyncCompute::wait(uint64_t value, uint64_t timeout) -> void
+	{
+		PROFILE_FUNCTION();
+		if (!timelineSupported || value == 0)
+			return;
+
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores    = &computeTimeline;
+		waitInfo.pValues        = &value;
+		VK_CHECK_RESULT(vkWaitSemaphores(*VulkanDevice::get(), &waitInfo, timeout));
+	}
+
+	auto VulkanAsyncCompute::getCompletedValue() const -> uint64_t
+	{
+		if (!timelineSupported)
+			return computeValue;
+
+		uint64_t value = 0;
+		VK_CHECK_RESULT(vkGetSemaphoreCounterValue(*VulkanDevice::get(), computeTimeline, &value));
+		return value;
+	}
+};        // namespace maple
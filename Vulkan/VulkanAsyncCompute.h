@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "VulkanHelper.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	class CommandBuffer;
+	class StorageBuffer;
+	class Texture;
+
+	struct AsyncComputeJob
+	{
+		std::string                                 name;
+		std::function<void(const CommandBuffer *)> record;
+		/**
+		 * resources shared with graphics. they are handed to the compute queue for the job
+		 * and handed back afterwards, images are in GENERAL while on the compute queue.
+		 */
+		std::vector<std::shared_ptr<StorageBuffer>> buffers;
+		std::vector<std::shared_ptr<Texture>>       images;
+		/**
+		 * where graphics consumes the results in the next frame, graphics only waits for the job there.
+		 */
+		VkPipelineStageFlags graphicsStage  = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		VkImageLayout        graphicsLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	};
+
+	/**
+	 * runs compute jobs on the compute queue next to the graphics work of the frame.
+	 *
+	 * the results are consumed one frame later. jobs start as soon as they are submitted and
+	 * overlap the rest of the frame, the next frame hands the shared resources back to graphics
+	 * in a small submission of its own which waits for the compute value at the stages the jobs
+	 * declared, so the frame itself never waits for compute as a whole.
+	 *
+	 * shared resources belong to compute from the submit until the next frame: graphics must not
+	 * use them anywhere in the frame which submitted them. work repeated every frame should
+	 * alternate between two sets of resources.
+	 *
+	 * without timeline semaphores the jobs are recorded inline on the graphics command buffer.
+	 */
+	class VulkanAsyncCompute
+	{
+	  public:
+		VulkanAsyncCompute();
+		~VulkanAsyncCompute();
+
+		inline auto isAsync() const
+		{
+			return timelineSupported;
+		}
+
+		/**
+		 * returns the compute timeline value signalled once the jobs are done.
+		 */
+		auto submit(const std::vector<AsyncComputeJob> &jobs) -> uint64_t;
+
+		/**
+		 * called by the swap chain before the frame starts recording, hands the results of the
+		 * jobs submitted during the previous frame to graphics.
+		 */
+		auto onFrameBegin() -> void;
+
+		/**
+		 * called for the graphics submission of the frame, appends the graphics timeline signal.
+		 */
+		auto onGraphicsSubmit(std::vector<VkPipelineStageFlags> &waitStages, std::vector<VkSemaphore> &waitSemaphores, std::vector<uint64_t> &waitValues,
+		                      std::vector<VkSemaphore> &signalSemaphores, std::vector<uint64_t> &signalValues) -> void;
+
+		/**
+		 * host side wait, e.g. before reading back results of a job.
+		 */
+		auto wait(uint64_t value, uint64_t timeout = UINT64_MAX) -> void;
+
+		auto getCompletedValue() const -> uint64_t;
+
+		inline auto getSubmittedValue() const
+		{
+			return computeValue;
+		}
+
+	  private:
+		auto recordInline(const std::vector<AsyncComputeJob> &jobs) -> uint64_t;
+
+		bool        timelineSupported = false;
+		uint32_t    graphicsFamily    = 0;
+		uint32_t    computeFamily     = 0;
+		VkSemaphore graphicsTimeline  = VK_NULL_HANDLE;
+		VkSemaphore computeTimeline   = VK_NULL_HANDLE;
+		uint64_t    graphicsValue     = 0;
+		uint64_t    computeValue      = 0;
+
+		//jobs of the frame being recorded, handed to graphics when the next frame begins.
+		struct Handoff
+		{
+			uint64_t                           value  = 0;
+			VkPipelineStageFlags               stages = 0;
+			std::vector<VkBufferMemoryBarrier> buffers;        //acquires on graphics
+			std::vector<VkImageMemoryBarrier>  images;
+		};
+		Handoff queued;
+	};
+};        // namespace maple
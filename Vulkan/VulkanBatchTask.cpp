@@ -8,6 +8,8 @@
 #include "VulkanDebug.h"
 #include "VulkanContext.h"
 #include "VulkanDevice.h"
+#include "../Console.h"
+#include <algorithm>
 #include <cmath>
 
 namespace maple
@@ -19,27 +21,49 @@ namespace maple
 		return (x + (alignment - 1)) & ~(alignment - 1);
 	}
 
+	VulkanBatchTask::~VulkanBatchTask()
+	{
+		for (auto &batch : compactions)
+			vkDestroyQueryPool(*VulkanDevice::get(), batch.queryPool, nullptr);
+	}
+
 	auto VulkanBatchTask::execute(const CommandBuffer* cmd) -> void
 	{
 		auto vkCmd = static_cast<const VulkanCommandBuffer*>(cmd);
 
-		auto alignment = VulkanDevice::get()->getPhysicalDevice()->getAccelerationStructureProperties().minAccelerationStructureScratchOffsetAlignment;
+		compact(vkCmd->getCommandBuffer());
 
 		if (requests.size() > 0)
 		{
-			//std::shared_ptr<VulkanBuffer> scratchBuffer;
 			debug_utils::cmdBeginLabel("Build Bottom AccelerationStructure");
-			VkMemoryBarrier memoryBarrier;
-			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-			memoryBarrier.pNext         = nullptr;
-			memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-			memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
 
-			VkDeviceSize scratchBufferSize = 0;
+			VkDeviceSize alignment = VulkanDevice::get()->getPhysicalDevice()->getAccelerationStructureProperties().minAccelerationStructureScratchOffsetAlignment;
+			alignment              = std::max<VkDeviceSize>(alignment, 1);
 
-			for (auto &request : requests)
-				scratchBufferSize += align(request.accelerationStructure->getBuildScratchSize(),request.accelerationStructure->getBuildSizes().buildScratchSize);
+			auto scratchSize = [&](const BLASBuildRequest &request) {
+				auto &sizes = request.accelerationStructure->getBuildSizes();
+				return align(request.update ? sizes.updateScratchSize : sizes.buildScratchSize, alignment);
+			};
 
+			//requests are split into chunks whose scratch fits the budget, a single larger request is a chunk of its own.
+			std::vector<size_t> chunks;
+			VkDeviceSize        chunkSize    = 0;
+			VkDeviceSize        maxChunkSize = 0;
+			for (size_t i = 0; i < requests.size(); i++)
+			{
+				auto size = scratchSize(requests[i]);
+				if (chunkSize > 0 && chunkSize + size > scratchBudget)
+				{
+					chunks.emplace_back(i);
+					chunkSize = 0;
+				}
+				chunkSize += size;
+				maxChunkSize = std::max(maxChunkSize, chunkSize);
+			}
+			chunks.emplace_back(requests.size());
+
+			//the allocation is not guaranteed to start at the scratch alignment.
+			auto scratchBufferSize = maxChunkSize + alignment;
 			if (scratchBuffer == nullptr) 
 			{
 				scratchBuffer = std::make_shared<VulkanBuffer>(
@@ -50,45 +74,173 @@ namespace maple
 			{
 				scratchBuffer->resize(scratchBufferSize,nullptr);
 			}
+			auto scratchAddress = align(scratchBuffer->getDeviceAddress(), alignment);
+
+			//scratch of the previous chunk is reused, and refits read their own earlier build.
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+			memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
 
-			
+			std::vector<VkAccelerationStructureBuildGeometryInfoKHR>     buildInfos;
+			std::vector<const VkAccelerationStructureBuildRangeInfoKHR *> buildRanges;
+			buildInfos.reserve(requests.size());
+			buildRanges.reserve(requests.size());
 
-			for (auto &request : requests)
+			size_t first = 0;
+			for (auto last : chunks)
 			{
-				const VkAccelerationStructureBuildRangeInfoKHR *buildRanges = &request.buildRanges[0];
-
-				VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
-
-				buildInfo.sType                     = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-				buildInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-				buildInfo.flags                     = request.accelerationStructure->getFlags();
-				buildInfo.srcAccelerationStructure  = VK_NULL_HANDLE;
-				buildInfo.dstAccelerationStructure  = request.accelerationStructure->getAccelerationStructure();
-				buildInfo.geometryCount             = (uint32_t) request.geometries.size();
-				buildInfo.pGeometries               = request.geometries.data();
-				buildInfo.scratchData.deviceAddress = scratchBuffer->getDeviceAddress() 
-					+ align(request.accelerationStructure->getBuildScratchSize(), request.accelerationStructure->getBuildSizes().buildScratchSize);;
-					//request.accelerationStructure->getDeviceAddress();
-					//scratchBuffer->getDeviceAddress();
-
-				vkCmdBuildAccelerationStructuresKHR(vkCmd->getCommandBuffer(), 1, &buildInfo, &buildRanges);
+				buildInfos.clear();
+				buildRanges.clear();
+
+				VkDeviceSize offset = 0;
+				for (auto i = first; i < last; i++)
+				{
+					auto &request = requests[i];
+
+					VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+					buildInfo.sType                     = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+					buildInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+					buildInfo.flags                     = request.accelerationStructure->getFlags();
+					buildInfo.mode                      = request.update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+					buildInfo.srcAccelerationStructure  = request.update ? request.accelerationStructure->getAccelerationStructure() : VK_NULL_HANDLE;
+					buildInfo.dstAccelerationStructure  = request.accelerationStructure->getAccelerationStructure();
+					buildInfo.geometryCount             = (uint32_t) request.geometries.size();
+					buildInfo.pGeometries               = request.geometries.data();
+					buildInfo.scratchData.deviceAddress = scratchAddress + offset;
+
+					buildInfos.emplace_back(buildInfo);
+					buildRanges.emplace_back(request.buildRanges.data());
+					offset += scratchSize(request);
+				}
+
+				//every request has its own destination, the whole chunk is built by one call.
+				vkCmdBuildAccelerationStructuresKHR(vkCmd->getCommandBuffer(), (uint32_t) buildInfos.size(), buildInfos.data(), buildRanges.data());
 				vkCmdPipelineBarrier(vkCmd->getCommandBuffer(), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &memoryBarrier, 0, 0, 0, 0);
+				first = last;
 			}
 			debug_utils::cmdEndLabel();
+
+			//the query pool is reset on the host, compact may read it before this command buffer ran.
+			if (compaction && VulkanDevice::get()->getPhysicalDevice()->isHostQueryResetSupported())
+			{
+				CompactionBatch                         batch;
+				std::vector<VkAccelerationStructureKHR> handles;
+				for (auto &request : requests)
+				{
+					if (request.accelerationStructure->getFlags() & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
+					{
+						batch.structures.emplace_back(request.accelerationStructure);
+						handles.emplace_back(request.accelerationStructure->getAccelerationStructure());
+					}
+				}
+
+				if (!handles.empty())
+				{
+					VkQueryPoolCreateInfo createInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+					createInfo.queryType  = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+					createInfo.queryCount = static_cast<uint32_t>(handles.size());
+					VK_CHECK_RESULT(vkCreateQueryPool(*VulkanDevice::get(), &createInfo, nullptr, &batch.queryPool));
+					vkResetQueryPool(*VulkanDevice::get(), batch.queryPool, 0, createInfo.queryCount);
+
+					//the barrier after the last build makes the structures visible to the query.
+					vkCmdWriteAccelerationStructuresPropertiesKHR(vkCmd->getCommandBuffer(), createInfo.queryCount, handles.data(),
+					                                              VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, batch.queryPool, 0);
+					compactions.emplace_back(std::move(batch));
+				}
+			}
 			requests.clear();
 		}
 	}
 
+	auto VulkanBatchTask::compact(VkCommandBuffer cmd) -> void
+	{
+		std::vector<VkDeviceSize> sizes;
+		bool                      copied = false;
+
+		for (auto it = compactions.begin(); it != compactions.end();)
+		{
+			auto count = static_cast<uint32_t>(it->structures.size());
+			sizes.resize(count);
+			//never waits, the batch stays pending until every size is available.
+			if (vkGetQueryPoolResults(*VulkanDevice::get(), it->queryPool, 0, count, sizes.size() * sizeof(VkDeviceSize), sizes.data(),
+			                          sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+			{
+				it++;
+				continue;
+			}
+
+			uint64_t originalSize  = 0;
+			uint64_t compactedSize = 0;
+			uint32_t compacted     = 0;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				auto structure = it->structures[i];
+				if (structure == nullptr)
+					continue;
+				originalSize += structure->getSize();
+				structure->compact(cmd, sizes[i]);
+				compactedSize += structure->getSize();
+				compacted += structure->isCompacted() ? 1 : 0;
+			}
+
+			if (compacted > 0)
+			{
+				copied = true;
+				compactionStats.structures += compacted;
+				compactionStats.originalSize += originalSize;
+				compactionStats.compactedSize += compactedSize;
+				LOGI("compacted {0} BLAS, {1} KB -> {2} KB", compacted, originalSize / 1024, compactedSize / 1024);
+			}
+
+			//the copies do not use the pool, but the command buffer which wrote it may still be pending.
+			auto queryPool = it->queryPool;
+			VulkanContext::getDeletionQueue().destroy(DeletionType::QueryPool, queryPool);
+			it = compactions.erase(it);
+		}
+
+		if (copied)
+		{
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+			memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		}
+	}
+
 	auto VulkanBatchTask::buildBlas(VulkanAccelerationStructure *                               accelerationStructure,
 	                                const std::vector<VkAccelerationStructureGeometryKHR> &     geometries,
-	                                const std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges) -> void
+	                                const std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges,
+	                                bool                                                        update) -> void
 	{
 		if (geometries.size() > 0 || buildRanges.size() > 0)
-			requests.push_back({accelerationStructure, geometries, buildRanges});
+		{
+			auto pending = std::find_if(requests.begin(), requests.end(), [&](auto &request) { return request.accelerationStructure == accelerationStructure; });
+			if (pending != requests.end())
+			{
+				pending->geometries  = geometries;
+				pending->buildRanges = buildRanges;
+				pending->update      = pending->update && update;
+				return;
+			}
+
+			//a size queried before the rebuild does not describe the new content.
+			for (auto &batch : compactions)
+				std::replace(batch.structures.begin(), batch.structures.end(), accelerationStructure, static_cast<VulkanAccelerationStructure *>(nullptr));
+			requests.push_back({accelerationStructure, geometries, buildRanges, update});
+		}
 		else
 		{
 			throw std::runtime_error("(Vulkan) Building a BLAS fail.");
 		}
 	}
+
+	auto VulkanBatchTask::cancel(VulkanAccelerationStructure *accelerationStructure) -> void
+	{
+		requests.erase(std::remove_if(requests.begin(), requests.end(), [&](auto &request) { return request.accelerationStructure == accelerationStructure; }), requests.end());
+		for (auto &batch : compactions)
+			std::replace(batch.structures.begin(), batch.structures.end(), accelerationStructure, static_cast<VulkanAccelerationStructure *>(nullptr));
+	}
 #endif        // MAPLE_VULKAN
 }        // namespace maple
\ No newline at end of file
@@ -11,22 +11,54 @@ namespace maple
 	class VulkanBatchTask : public BatchTask
 	{
 	  public:
+		~VulkanBatchTask();
+
 		virtual auto execute(const CommandBuffer * cmd) -> void override;
 
+		/**
+		 * update refits the previous build in place, a pending full build of the same structure wins.
+		 */
 		auto buildBlas(VulkanAccelerationStructure* accelerationStructure,
 			const std::vector<VkAccelerationStructureGeometryKHR>& geometries,
-			const std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges) -> void;
+			const std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges,
+			bool update = false) -> void;
+
+		/**
+		 * drops pending builds and compactions of a structure which is destroyed.
+		 */
+		auto cancel(VulkanAccelerationStructure *accelerationStructure) -> void;
+
+		/**
+		 * bytes of scratch one build call may use, larger batches are built in several calls which
+		 * share the scratch buffer.
+		 */
+		inline auto setScratchBudget(VkDeviceSize budget)
+		{
+			scratchBudget = budget;
+		}
 
 	  private:
+		//structures built by one execute, compacted once all their sizes are available.
+		struct CompactionBatch
+		{
+			VkQueryPool                                queryPool = VK_NULL_HANDLE;
+			std::vector<VulkanAccelerationStructure *> structures;
+		};
+
+		auto compact(VkCommandBuffer cmd) -> void;
+
 		struct BLASBuildRequest
 		{
 			VulkanAccelerationStructure *                         accelerationStructure;
 			std::vector<VkAccelerationStructureGeometryKHR>       geometries;
 			std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges;
+			bool                                                  update = false;
 		};
 
 		std::vector<BLASBuildRequest> requests;
+		std::vector<CompactionBatch>  compactions;
 
 		std::shared_ptr<VulkanBuffer> scratchBuffer;
+		VkDeviceSize                  scratchBudget = 64 * 1024 * 1024;
 	};
 };        // namespace maple
\ No newline at end of file
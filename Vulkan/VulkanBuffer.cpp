@@ -7,10 +7,25 @@
 #include "VulkanDevice.h"
 #include "VulkanHelper.h"
 #include "VulkanSwapChain.h"
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 namespace maple
 {
+	namespace
+	{
+		//copies recorded into the same upload command buffer may touch the same range.
+		inline auto transferBarrier(VkCommandBuffer cmd)
+		{
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		}
+	}        // namespace
+
 	VulkanBuffer::VulkanBuffer()
 	{
 	}
@@ -22,6 +37,20 @@ namespace maple
 		init(usage, size, data, vmaUsage, vmaCreateFlags);
 	}
 
+	VulkanBuffer::VulkanBuffer(const std::shared_ptr<GeometryHeap> &heap, const GeometryAllocation &suballocation, VkBuffer buffer, VkDeviceAddress pageAddress, VkBufferUsageFlags usage) :
+	    buffer(buffer),
+	    size(suballocation.size),
+	    usage(usage),
+	    baseOffset(suballocation.offset),
+	    heap(heap),
+	    suballocation(suballocation)
+	{
+#ifdef USE_VMA_ALLOCATOR
+		vmaUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+#endif
+		address = pageAddress != 0 ? pageAddress + baseOffset : 0;
+	}
+
 	VulkanBuffer::~VulkanBuffer()
 	{
 		release();
@@ -33,6 +62,8 @@ namespace maple
 		//param for creating
 		this->usage                   = usage;
 		this->size                    = size;
+		this->vmaUsage                = vmaUsage;
+		this->vmaCreateFlags          = vmaCreateFlags;
 		VkBufferCreateInfo bufferInfo = {};
 		bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 		bufferInfo.size               = size;
@@ -52,6 +83,8 @@ namespace maple
 		else if (vmaUsage == VMA_MEMORY_USAGE_GPU_ONLY)
 		{
 			memoryPropFlags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			//src as well, growing copies the old contents over.
+			usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 			usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 		}
 		else if (vmaUsage == VMA_MEMORY_USAGE_CPU_TO_GPU)
@@ -83,6 +116,7 @@ namespace maple
 		vmaCreateBuffer(VulkanDevice::get()->getAllocator(), &bufferInfo, &vmaCreateInfo, &buffer, &allocation, nullptr);
 
 #else
+		bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 		VK_CHECK_RESULT(vkCreateBuffer(*VulkanDevice::get(), &bufferInfo, nullptr, &buffer));
 
 		VkMemoryRequirements memRequirements;
@@ -133,6 +167,7 @@ namespace maple
 	auto VulkanBuffer::map(VkDeviceSize size, VkDeviceSize offset) -> void
 	{
 		PROFILE_FUNCTION();
+		MAPLE_ASSERT(heap == nullptr, "sub-allocated buffers are device local");
 #ifdef USE_VMA_ALLOCATOR
 		VK_CHECK_RESULT(vmaMapMemory(VulkanDevice::get()->getAllocator(), allocation, &mapped));
 #else
@@ -193,9 +228,150 @@ namespace maple
 		PROFILE_FUNCTION();
 		if (data != nullptr)
 		{
-			map(size, offset);
-			memcpy(reinterpret_cast<uint8_t *>(mapped) + offset, data, size);
+			setVkData({{data, size, offset}});
+		}
+	}
+
+	auto VulkanBuffer::setVkData(const std::vector<BufferUpdate> &updates) -> void
+	{
+		PROFILE_FUNCTION();
+		if (updates.empty())
+			return;
+
+		if (isHostVisible())
+		{
+			//mapped by the owner already (getPointer), keep it mapped.
+			auto wasMapped = mapped != nullptr;
+			if (!wasMapped)
+				map();
+			for (auto &update : updates)
+			{
+				MAPLE_ASSERT(update.offset + update.size <= size, "buffer update out of range");
+				memcpy(reinterpret_cast<uint8_t *>(mapped) + baseOffset + update.offset, update.data, update.size);
+			}
+			if (!wasMapped)
+				unmap();
+			return;
+		}
+
+		uint32_t total = 0;
+		for (auto &update : updates)
+		{
+			MAPLE_ASSERT(update.offset + update.size <= size, "buffer update out of range");
+			total += update.size;
+		}
+
+		if (total == 0)
+			return;
+
+		auto staging = std::make_unique<VulkanBuffer>(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, total, nullptr);
+		staging->map();
+		std::vector<VkBufferCopy> regions;
+		regions.reserve(updates.size());
+		uint32_t srcOffset = 0;
+		for (auto &update : updates)
+		{
+			memcpy(reinterpret_cast<uint8_t *>(staging->mapped) + srcOffset, update.data, update.size);
+			regions.push_back({srcOffset, baseOffset + update.offset, update.size});
+			srcOffset += update.size;
+		}
+		staging->unmap();
+
+		auto cmd = VulkanHelper::beginSingleTimeCommands();
+		transferBarrier(cmd);
+		vkCmdCopyBuffer(cmd, staging->getVkBuffer(), buffer, static_cast<uint32_t>(regions.size()), regions.data());
+		VulkanHelper::endSingleTimeCommands(cmd);
+	}
+
+	auto VulkanBuffer::grow(uint32_t required, bool keepContents, bool geometric, VkCommandBuffer copyCommand) -> void
+	{
+		PROFILE_FUNCTION();
+		if (required <= size)
+			return;
+
+		MAPLE_ASSERT(heap == nullptr, "sub-allocated buffers can not grow");
+		auto capacity = geometric ? std::max<VkDeviceSize>(required, size + size / 2) : required;
+
+		if (!keepContents || buffer == VK_NULL_HANDLE)
+		{
+			release();
+			init(usage, static_cast<uint32_t>(capacity), nullptr, vmaUsage, vmaCreateFlags);
+			return;
+		}
+
+		auto oldBuffer = buffer;
+		auto oldSize   = size;
+		auto wasMapped = mapped != nullptr;
+#ifdef USE_VMA_ALLOCATOR
+		auto oldAllocation = allocation;
+#else
+		auto oldMemory = memory;
+#endif
+
+		if (isHostVisible())
+		{
+			//host writes land right away, a copy on the GPU would later overwrite them with the old contents.
+			if (!wasMapped)
+				map();
+			invalidate();
+			auto oldMapped = mapped;
+			mapped         = nullptr;
+
+			init(usage, static_cast<uint32_t>(capacity), nullptr, vmaUsage, vmaCreateFlags);
+			map();
+			memcpy(mapped, oldMapped, oldSize);
+			flush();
+			if (!wasMapped)
+				unmap();
+
+#ifdef USE_VMA_ALLOCATOR
+			vmaUnmapMemory(VulkanDevice::get()->getAllocator(), oldAllocation);
+#else
+			vkUnmapMemory(*VulkanDevice::get(), oldMemory);
+#endif
+		}
+		else
+		{
 			unmap();
+			init(usage, static_cast<uint32_t>(capacity), nullptr, vmaUsage, vmaCreateFlags);
+			copyOnDevice(oldBuffer, oldSize, copyCommand);
+		}
+
+		//frames in flight may still read the old buffer, and a device copy may still be pending.
+		auto &queue = VulkanContext::getDeletionQueue();
+#ifdef USE_VMA_ALLOCATOR
+		queue.destroy(DeletionType::Buffer, oldBuffer, oldAllocation);
+#else
+		queue.destroy(DeletionType::Buffer, oldBuffer);
+		queue.destroy(DeletionType::Memory, oldMemory);
+#endif
+		if (wasMapped && mapped == nullptr)
+			map();
+	}
+
+	auto VulkanBuffer::copyOnDevice(VkBuffer oldBuffer, VkDeviceSize oldSize, VkCommandBuffer copyCommand) -> void
+	{
+		VkBufferCopy copy = {0, 0, oldSize};
+		if (copyCommand != VK_NULL_HANDLE)
+		{
+			//in the middle of a frame, earlier shader writes have to land before the copy and the copy before later reads.
+			VkMemoryBarrier memoryBarrier{};
+			memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(copyCommand, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+			vkCmdCopyBuffer(copyCommand, oldBuffer, buffer, 1, &copy);
+			memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(copyCommand, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		}
+		else
+		{
+			auto cmd = VulkanHelper::beginSingleTimeCommands();
+			transferBarrier(cmd);
+			vkCmdCopyBuffer(cmd, oldBuffer, buffer, 1, &copy);
+			transferBarrier(cmd);
+			VulkanHelper::endSingleTimeCommands(cmd);
 		}
 	}
 
@@ -208,32 +384,35 @@ namespace maple
 	auto VulkanBuffer::resize(uint32_t size, const void *data) -> void
 	{
 		PROFILE_FUNCTION();
+		MAPLE_ASSERT(heap == nullptr, "sub-allocated buffers can not be resized");
 		release();
-		init(usage, size, data);
+		init(usage, size, data, vmaUsage, vmaCreateFlags);
 	}
 
 	auto VulkanBuffer::release() -> void
 	{
 		PROFILE_FUNCTION();
+		if (heap != nullptr)
+		{
+			//the page owns the VkBuffer.
+			heap->free(suballocation);
+			heap   = nullptr;
+			buffer = VK_NULL_HANDLE;
+			return;
+		}
+
 		if (buffer)
 		{
-			auto &queue    = VulkanContext::getDeletionQueue();
-			auto  buffer   = this->buffer;
-			auto  bufferId = VulkanContext::get()->getSwapChain()->getCurrentBufferIndex();
+			auto &queue = VulkanContext::getDeletionQueue();
 #ifdef USE_VMA_ALLOCATOR
-			auto alloc = allocation;
 			unmap();
-			queue.emplace([buffer, alloc, bufferId] { vmaDestroyBuffer(VulkanDevice::get()->getAllocator(), buffer, alloc); });
+			queue.destroy(DeletionType::Buffer, buffer, allocation);
 #else
-
-			auto memory = this->memory;
-			queue.emplace([buffer, memory]() {
-				vkDestroyBuffer(*VulkanDevice::get(), buffer, nullptr);
-				if (memory)
-				{
-					vkFreeMemory(*VulkanDevice::get(), memory, nullptr);
-				}
-			});
+			queue.destroy(DeletionType::Buffer, buffer);
+			if (memory)
+			{
+				queue.destroy(DeletionType::Memory, memory);
+			}
 #endif
 		}
 	}
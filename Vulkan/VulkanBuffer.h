@@ -3,9 +3,12 @@
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include "../Definitions.h"
+#include "../GeometryHeap.h"
 #include "VkCommon.h"
 
 #include <memory>
+#include <vector>
 
 namespace maple
 {
@@ -20,6 +23,10 @@ namespace maple
 #else
 		VulkanBuffer(VkBufferUsageFlags usage, uint32_t size, const void *data, uint32_t vmaUsage = 3, uint32_t vmaCreateFlags = 0);
 #endif        // USE_VMA_ALLOCATOR
+		/**
+		 * view of a range in a geometry heap page, the range goes back to the heap on release.
+		 */
+		VulkanBuffer(const std::shared_ptr<GeometryHeap> &heap, const GeometryAllocation &suballocation, VkBuffer buffer, VkDeviceAddress pageAddress, VkBufferUsageFlags usage);
 		virtual ~VulkanBuffer();
 
 		auto resize(uint32_t size, const void *data) -> void;
@@ -33,6 +40,32 @@ namespace maple
 		auto flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) -> void;
 		auto invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) -> void;
 		auto setVkData(uint32_t size, const void *data, uint32_t offset = 0) -> void;
+		/**
+		 * writes all ranges at once, one map for host visible memory,
+		 * one staging buffer and one copy for gpu only memory.
+		 */
+		auto setVkData(const std::vector<BufferUpdate> &updates) -> void;
+		/**
+		 * reallocates to at least the required size, geometric grows by half of the current size.
+		 * when keepContents is set, host visible buffers copy the old contents on the host right away,
+		 * so later host writes are kept. gpu only buffers copy on the GPU, recorded into copyCommand
+		 * if given, otherwise into the upload commands.
+		 */
+		auto grow(uint32_t required, bool keepContents, bool geometric = true, VkCommandBuffer copyCommand = VK_NULL_HANDLE) -> void;
+
+		inline auto isHostVisible() const
+		{
+#ifdef USE_VMA_ALLOCATOR
+			return vmaUsage != VMA_MEMORY_USAGE_GPU_ONLY;
+#else
+			return heap == nullptr;
+#endif
+		}
+
+		inline auto getBaseOffset() const
+		{
+			return baseOffset;
+		}
 
 		inline auto setUsage(VkBufferUsageFlags flags)
 		{
@@ -66,6 +99,8 @@ namespace maple
 		auto release() -> void;
 
 	  protected:
+		auto copyOnDevice(VkBuffer oldBuffer, VkDeviceSize oldSize, VkCommandBuffer copyCommand) -> void;
+
 		VkDeviceAddress        address = 0;
 		VkDescriptorBufferInfo desciptorBufferInfo{};
 		VkBuffer               buffer    = VK_NULL_HANDLE;
@@ -74,10 +109,16 @@ namespace maple
 		VkDeviceSize           alignment = 0;
 		void *                 mapped    = nullptr;
 		VkBufferUsageFlags     usage;
+		uint32_t               vmaUsage       = 3;
+		uint32_t               vmaCreateFlags = 0;
 #ifdef USE_VMA_ALLOCATOR
 		VmaAllocation allocation{};
 		VmaAllocation mappedAllocation{};
 #endif
 		bool dynamic = false;
+
+		VkDeviceSize                  baseOffset = 0;
+		std::shared_ptr<GeometryHeap> heap;
+		GeometryAllocation            suballocation;
 	};
 }        // namespace maple
@@ -7,14 +7,70 @@
 #include "VulkanDevice.h"
 #include "VulkanFence.h"
 #include "VulkanFrameBuffer.h"
+#include "VulkanLayoutCache.h"
 #include "VulkanPipeline.h"
 #include "VulkanRenderPass.h"
 
 #include "../Console.h"
 #include "../GraphicsContext.h"
+#include <algorithm>
 
 namespace maple
 {
+	namespace
+	{
+		constexpr VkAccessFlags WriteAccessMask =
+		    VK_ACCESS_SHADER_WRITE_BIT |
+		    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		    VK_ACCESS_TRANSFER_WRITE_BIT |
+		    VK_ACCESS_HOST_WRITE_BIT |
+		    VK_ACCESS_MEMORY_WRITE_BIT |
+		    VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+		inline auto getBindPointIndex(VkPipelineBindPoint bindPoint) -> uint32_t
+		{
+			switch (bindPoint)
+			{
+			case VK_PIPELINE_BIND_POINT_COMPUTE:
+				return 1;
+			case VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR:
+				return 2;
+			default:
+				return 0;
+			}
+		}
+
+		inline auto setMask(uint32_t first, uint32_t count) -> uint32_t
+		{
+			return (count >= 32 ? UINT32_MAX : (1u << count) - 1) << first;
+		}
+
+		inline auto isReadOnly(VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+		{
+			return ((srcAccess | dstAccess) & WriteAccessMask) == 0;
+		}
+
+		inline auto rangeEnd(uint32_t base, uint32_t count)
+		{
+			return count == VK_REMAINING_MIP_LEVELS ? UINT32_MAX : base + count;
+		}
+
+		inline auto isSameRange(const VkImageSubresourceRange &a, const VkImageSubresourceRange &b)
+		{
+			return a.aspectMask == b.aspectMask &&
+			       a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount &&
+			       a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount;
+		}
+
+		inline auto isOverlapping(const VkImageSubresourceRange &a, const VkImageSubresourceRange &b)
+		{
+			return (a.aspectMask & b.aspectMask) != 0 &&
+			       a.baseMipLevel < rangeEnd(b.baseMipLevel, b.levelCount) && b.baseMipLevel < rangeEnd(a.baseMipLevel, a.levelCount) &&
+			       a.baseArrayLayer < rangeEnd(b.baseArrayLayer, b.layerCount) && b.baseArrayLayer < rangeEnd(a.baseArrayLayer, a.layerCount);
+		}
+	}        // namespace
+
 	VulkanCommandBuffer::VulkanCommandBuffer(CommandBufferType cmdBufferType) :
 		primary(false),
 		cmdBufferType(cmdBufferType)
@@ -86,6 +142,10 @@ namespace maple
 	auto VulkanCommandBuffer::unload() -> void
 	{
 		PROFILE_FUNCTION();
+		//wrapped handle, owned and recycled by its pool.
+		if (commandPool == nullptr)
+			return;
+
 		GraphicsContext::get()->waitIdle();
 
 		if (state == CommandBufferState::Submitted)
@@ -103,6 +163,9 @@ namespace maple
 		PROFILE_FUNCTION();
 		MAPLE_ASSERT(primary, "beginRecording() called from a secondary command buffer!");
 		state = CommandBufferState::Recording;
+		barrierStats = {};
+		bindStats    = {};
+		invalidateBindState();
 
 		VkCommandBufferBeginInfo beginCI{};
 		beginCI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -121,6 +184,7 @@ namespace maple
 		PROFILE_FUNCTION();
 		MAPLE_ASSERT(!primary, "beginRecordingSecondary() called from a primary command buffer!");
 		state = CommandBufferState::Recording;
+		invalidateBindState();
 
 		VkCommandBufferInheritanceInfo inheritanceInfo{};
 		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
@@ -147,9 +211,7 @@ namespace maple
 
 		boundPipeline = nullptr;
 
-#ifdef MAPLE_PROFILE
-		//TracyVkCollect(VulkanDevice::get()->getTracyContext(), commandBuffer);
-#endif        // MAPLE_PROFILE
+		flushBarriers();
 
 		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 		state = CommandBufferState::Ended;
@@ -164,7 +226,10 @@ namespace maple
 		//state = CommandBufferState::Submitted;
 		auto vkCmd = std::static_pointer_cast<VulkanCommandBuffer>(secondaryCmdBuffer);
 		auto secCmd = vkCmd->getCommandBuffer();
+		flushBarriers();
 		vkCmdExecuteCommands(commandBuffer, 1, &secCmd);
+		//bind state is undefined after secondary command buffers ran.
+		invalidateBindState();
 	}
 
 	auto VulkanCommandBuffer::updateViewport(uint32_t width, uint32_t height) const -> void
@@ -226,6 +291,7 @@ namespace maple
 		rects.rect.offset = { rect.x,rect.y };
 		rects.rect.extent = { (uint32_t)rect.z,(uint32_t)rect.w };
 		rects.layerCount = 1;
+		flushBarriers();
 		vkCmdClearAttachments(commandBuffer,1, &attachment, 1,&rects);
 	}
 
@@ -266,11 +332,6 @@ namespace maple
 	}
 
 	auto VulkanCommandBuffer::endSingleTimeCommands() -> void
-	{
-		VulkanHelper::endSingleTimeCommands(commandBuffer);
-	}
-
-	auto VulkanCommandBuffer::submit() -> void
 	{
 		PROFILE_FUNCTION();
 
@@ -293,14 +354,21 @@ namespace maple
 
 		VK_CHECK_RESULT(vkQueueSubmit(VulkanDevice::get()->getGraphicsQueue(), 1, &submitInfo, updateFence->getHandle()));
 		updateFence->waitAndReset();
+	}
 
+	auto VulkanCommandBuffer::submit() -> void
+	{
+		PROFILE_FUNCTION();
+		endSingleTimeCommands();
 		beginRecording();
 	}
 
 	auto VulkanCommandBuffer::executeInternal(const std::vector<VkPipelineStageFlags>& flags,
 		const std::vector<VkSemaphore>& waitSemaphores,
 		const std::vector<VkSemaphore>& signalSemaphores,
-		bool                                     waitFence) -> void
+		bool                                     waitFence,
+		const std::vector<uint64_t>&             waitValues,
+		const std::vector<uint64_t>&             signalValues) -> void
 	{
 		PROFILE_FUNCTION();
 		MAPLE_ASSERT(primary, "Used Execute on secondary command buffer!");
@@ -318,6 +386,19 @@ namespace maple
 		submitInfo.signalSemaphoreCount = signalSemaphores.size();
 		submitInfo.pSignalSemaphores = signalSemaphores.data();
 
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		if (!waitValues.empty() || !signalValues.empty())
+		{
+			MAPLE_ASSERT(waitValues.empty() || waitValues.size() == waitSemaphores.size(), "one wait value per semaphore");
+			MAPLE_ASSERT(signalValues.empty() || signalValues.size() == signalSemaphores.size(), "one signal value per semaphore");
+			timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.waitSemaphoreValueCount   = waitValues.size();
+			timelineInfo.pWaitSemaphoreValues      = waitValues.data();
+			timelineInfo.signalSemaphoreValueCount = signalValues.size();
+			timelineInfo.pSignalSemaphoreValues    = signalValues.data();
+			submitInfo.pNext                       = &timelineInfo;
+		}
+
 		//fence->reset();
 
 		VK_CHECK_RESULT(vkQueueSubmit(
@@ -333,6 +414,247 @@ namespace maple
 		secondaryCommands.clear();
 	}
 
+	auto VulkanCommandBuffer::pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkImageMemoryBarrier& barrier) const -> void
+	{
+		barrierStats.requested++;
+
+		const bool sameQueue = barrier.srcQueueFamilyIndex == barrier.dstQueueFamilyIndex;
+
+		if (sameQueue && barrier.oldLayout == barrier.newLayout && isReadOnly(barrier.srcAccessMask, barrier.dstAccessMask))
+		{
+			barrierStats.skipped++;
+			return;
+		}
+
+		for (auto iter = pendingImageBarriers.begin(); iter != pendingImageBarriers.end(); iter++)
+		{
+			if (iter->image != barrier.image || !isOverlapping(iter->subresourceRange, barrier.subresourceRange))
+				continue;
+
+			//nothing was recorded in between, so A->B followed by B->C becomes A->C.
+			if (sameQueue && iter->srcQueueFamilyIndex == iter->dstQueueFamilyIndex &&
+			    isSameRange(iter->subresourceRange, barrier.subresourceRange) && iter->newLayout == barrier.oldLayout)
+			{
+				iter->newLayout     = barrier.newLayout;
+				iter->dstAccessMask = barrier.dstAccessMask;
+				pendingSrcStages |= srcStage;
+				pendingDstStages |= dstStage;
+				barrierStats.merged++;
+
+				if (iter->oldLayout == iter->newLayout && isReadOnly(iter->srcAccessMask, iter->dstAccessMask))
+				{
+					pendingImageBarriers.erase(iter);
+					barrierStats.skipped++;
+				}
+				return;
+			}
+			//overlapping sub-resources can not live in the same batch.
+			flushBarriers();
+			break;
+		}
+
+		pendingImageBarriers.emplace_back(barrier);
+		pendingSrcStages |= srcStage;
+		pendingDstStages |= dstStage;
+	}
+
+	auto VulkanCommandBuffer::pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkBufferMemoryBarrier& barrier) const -> void
+	{
+		barrierStats.requested++;
+
+		const bool sameQueue = barrier.srcQueueFamilyIndex == barrier.dstQueueFamilyIndex;
+
+		if (sameQueue && isReadOnly(barrier.srcAccessMask, barrier.dstAccessMask))
+		{
+			barrierStats.skipped++;
+			return;
+		}
+
+		if (sameQueue)
+		{
+			for (auto& pending : pendingBufferBarriers)
+			{
+				if (pending.buffer == barrier.buffer && pending.srcQueueFamilyIndex == pending.dstQueueFamilyIndex)
+				{
+					pending.srcAccessMask |= barrier.srcAccessMask;
+					pending.dstAccessMask |= barrier.dstAccessMask;
+					if (pending.offset != barrier.offset || pending.size != barrier.size)
+					{
+						pending.offset = 0;
+						pending.size   = VK_WHOLE_SIZE;
+					}
+					pendingSrcStages |= srcStage;
+					pendingDstStages |= dstStage;
+					barrierStats.merged++;
+					return;
+				}
+			}
+		}
+
+		pendingBufferBarriers.emplace_back(barrier);
+		pendingSrcStages |= srcStage;
+		pendingDstStages |= dstStage;
+	}
+
+	auto VulkanCommandBuffer::pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkMemoryBarrier& barrier) const -> void
+	{
+		barrierStats.requested++;
+
+		if (isReadOnly(barrier.srcAccessMask, barrier.dstAccessMask))
+		{
+			barrierStats.skipped++;
+			return;
+		}
+
+		pendingMemoryBarrier.srcAccessMask |= barrier.srcAccessMask;
+		pendingMemoryBarrier.dstAccessMask |= barrier.dstAccessMask;
+		pendingSrcStages |= srcStage;
+		pendingDstStages |= dstStage;
+	}
+
+	auto VulkanCommandBuffer::flushBarriers() const -> void
+	{
+		if (!hasPendingBarriers())
+			return;
+
+		PROFILE_FUNCTION();
+
+		const bool hasMemoryBarrier = pendingMemoryBarrier.srcAccessMask != 0 || pendingMemoryBarrier.dstAccessMask != 0;
+
+		vkCmdPipelineBarrier(commandBuffer,
+			pendingSrcStages != 0 ? pendingSrcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			pendingDstStages != 0 ? pendingDstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			hasMemoryBarrier ? 1 : 0, &pendingMemoryBarrier,
+			static_cast<uint32_t>(pendingBufferBarriers.size()), pendingBufferBarriers.data(),
+			static_cast<uint32_t>(pendingImageBarriers.size()), pendingImageBarriers.data());
+
+		pendingImageBarriers.clear();
+		pendingBufferBarriers.clear();
+		pendingMemoryBarrier.srcAccessMask = 0;
+		pendingMemoryBarrier.dstAccessMask = 0;
+		pendingSrcStages = 0;
+		pendingDstStages = 0;
+		barrierStats.flushes++;
+	}
+
+	auto VulkanCommandBuffer::bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) const -> void
+	{
+		auto &bound = boundSets[getBindPointIndex(bindPoint)];
+		if (bound.pipeline == pipeline)
+		{
+			bindStats.pipelinesSkipped++;
+			return;
+		}
+
+		vkCmdBindPipeline(getCommandBuffer(), bindPoint, pipeline);
+		bound.pipeline = pipeline;
+		bindStats.pipelines++;
+	}
+
+	auto VulkanCommandBuffer::bindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t count, const VkDescriptorSet *sets, const uint32_t *dynamicOffsets) const -> void
+	{
+		if (count == 0)
+			return;
+
+		auto &bound = boundSets[getBindPointIndex(bindPoint)];
+
+		if (layout != bound.layout)
+		{
+			//sets bound with the previous layout survive up to the first incompatible set.
+			if (bound.validSets != 0)
+				bound.validSets &= setMask(0, VulkanDevice::get()->getLayoutCache()->getCompatibleSetCount(bound.layout, layout));
+			bound.layout = layout;
+		}
+
+		std::vector<uint32_t> offsets;
+
+		if (firstSet + count > MaxBoundSets)
+		{
+			for (uint32_t i = 0; dynamicOffsets != nullptr && i < count; i++)
+			{
+				if (dynamicOffsets[i] != NoDynamicOffset)
+					offsets.emplace_back(dynamicOffsets[i]);
+			}
+			vkCmdBindDescriptorSets(getCommandBuffer(), bindPoint, layout, firstSet, count, sets, static_cast<uint32_t>(offsets.size()), offsets.data());
+			bound.validSets = 0;
+			bindStats.descriptorSets += count;
+			return;
+		}
+
+		uint32_t first = count;
+		uint32_t last  = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto index  = firstSet + i;
+			auto offset = dynamicOffsets != nullptr ? dynamicOffsets[i] : NoDynamicOffset;
+			if ((bound.validSets & (1u << index)) == 0 || bound.sets[index] != sets[i] || bound.dynamicOffsets[index] != offset)
+			{
+				first = std::min(first, i);
+				last  = i;
+			}
+		}
+
+		if (first == count)
+		{
+			bindStats.descriptorSetsSkipped += count;
+			return;
+		}
+
+		for (auto i = first; i <= last; i++)
+		{
+			auto index                  = firstSet + i;
+			bound.sets[index]           = sets[i];
+			bound.dynamicOffsets[index] = dynamicOffsets != nullptr ? dynamicOffsets[i] : NoDynamicOffset;
+			if (bound.dynamicOffsets[index] != NoDynamicOffset)
+				offsets.emplace_back(bound.dynamicOffsets[index]);
+		}
+
+		auto bindCount = last - first + 1;
+		vkCmdBindDescriptorSets(getCommandBuffer(), bindPoint, layout, firstSet + first, bindCount, sets + first, static_cast<uint32_t>(offsets.size()), offsets.data());
+		bound.validSets |= setMask(firstSet + first, bindCount);
+		bindStats.descriptorSets += bindCount;
+		bindStats.descriptorSetsSkipped += count - bindCount;
+	}
+
+	auto VulkanCommandBuffer::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void *data) const -> void
+	{
+		if (layout != pushConstantLayout)
+		{
+			if (pushConstantLayout == VK_NULL_HANDLE || !VulkanDevice::get()->getLayoutCache()->isPushConstantCompatible(pushConstantLayout, layout))
+				boundPushConstants.clear();
+			pushConstantLayout = layout;
+		}
+
+		auto bytes = static_cast<const uint8_t *>(data);
+		auto iter  = std::find_if(boundPushConstants.begin(), boundPushConstants.end(), [&](const BoundPushConstant &push) {
+			return push.stages == stages && push.offset == offset && push.data.size() == size;
+		});
+
+		if (iter != boundPushConstants.end() && std::equal(iter->data.begin(), iter->data.end(), bytes))
+		{
+			bindStats.pushConstantsSkipped++;
+			return;
+		}
+
+		vkCmdPushConstants(getCommandBuffer(), layout, stages, offset, size, data);
+		bindStats.pushConstants++;
+
+		//ranges sharing bytes with this one are replaced by it.
+		boundPushConstants.erase(std::remove_if(boundPushConstants.begin(), boundPushConstants.end(), [&](const BoundPushConstant &push) {
+			                         return (push.stages & stages) != 0 && push.offset < offset + size && offset < push.offset + push.data.size();
+		                         }),
+		                         boundPushConstants.end());
+		boundPushConstants.push_back({stages, offset, {bytes, bytes + size}});
+	}
+
+	auto VulkanCommandBuffer::invalidateBindState() const -> void
+	{
+		boundSets          = {};
+		pushConstantLayout = VK_NULL_HANDLE;
+		boundPushConstants.clear();
+	}
+
 	auto VulkanCommandBuffer::addTask(const std::function<void(const CommandBuffer*)>& task) -> void
 	{
 		tasks.emplace_back(task);
@@ -346,6 +668,11 @@ namespace maple
 		state = CommandBufferState::Idle;
 	}
 
+	auto VulkanCommandBuffer::isComplete() -> bool
+	{
+		return state != CommandBufferState::Submitted || fence->isSignaled();
+	}
+
 	auto VulkanCommandBuffer::reset() -> void
 	{
 		PROFILE_FUNCTION();
@@ -4,6 +4,7 @@
 #pragma once
 #include "../CommandBuffer.h"
 #include "VulkanHelper.h"
+#include <array>
 
 namespace maple
 {
@@ -56,17 +57,93 @@ namespace maple
 		auto wait() -> void;
 		auto reset() -> void;
 
+		/**
+		 * true unless the command buffer is submitted and still executing, never blocks.
+		 */
+		auto isComplete() -> bool;
+
+		/**
+		 * waitValues/signalValues are only needed when timeline semaphores are involved,
+		 * they have one entry per semaphore (ignored for binary ones).
+		 */
 		auto executeInternal(
 			const std::vector<VkPipelineStageFlags>& flags,
 			const std::vector<VkSemaphore>& waitSemaphores,
 			const std::vector<VkSemaphore>& signalSemaphores,
-			bool                                     waitFence) -> void;
-
+			bool                                     waitFence,
+			const std::vector<uint64_t>&             waitValues   = {},
+			const std::vector<uint64_t>&             signalValues = {}) -> void;
+
+		/**
+		 * raw handle, pending barriers are flushed first so anything recorded
+		 * through it observes them.
+		 */
 		inline auto getCommandBuffer() const
 		{
+			if (hasPendingBarriers())
+				flushBarriers();
 			return commandBuffer;
 		}
 
+		/**
+		 * barriers are accumulated and emitted as one vkCmdPipelineBarrier before the next
+		 * command (draw, dispatch, copy, render pass) is recorded. no-op transitions are dropped.
+		 */
+		auto pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkImageMemoryBarrier &barrier) const -> void;
+		auto pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkBufferMemoryBarrier &barrier) const -> void;
+		auto pipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkMemoryBarrier &barrier) const -> void;
+		auto flushBarriers() const -> void;
+
+		inline auto hasPendingBarriers() const
+		{
+			return !pendingImageBarriers.empty() || !pendingBufferBarriers.empty() || pendingMemoryBarrier.srcAccessMask != 0 || pendingMemoryBarrier.dstAccessMask != 0;
+		}
+
+		struct BarrierStats
+		{
+			uint32_t requested = 0;
+			uint32_t skipped   = 0;
+			uint32_t merged    = 0;
+			uint32_t flushes   = 0;
+		};
+
+		inline auto &getBarrierStats() const
+		{
+			return barrierStats;
+		}
+
+		/**
+		 * bind state tracking. pipelines, descriptor sets and push constants which are already bound
+		 * are not recorded again, descriptor sets are bound from the first one which changed. sets stay
+		 * bound across pipeline layouts as far as the layouts are compatible (see VulkanLayoutCache).
+		 * anything recording binds through the raw handle has to call invalidateBindState afterwards.
+		 */
+		static constexpr uint32_t MaxBoundSets    = 8;
+		static constexpr uint32_t NoDynamicOffset = UINT32_MAX;
+
+		auto bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) const -> void;
+		/**
+		 * dynamicOffsets has one entry per set, NoDynamicOffset for sets without a dynamic buffer. may be null.
+		 */
+		auto bindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t count, const VkDescriptorSet *sets, const uint32_t *dynamicOffsets) const -> void;
+		auto pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void *data) const -> void;
+		auto invalidateBindState() const -> void;
+
+		struct BindStats
+		{
+			uint32_t pipelines             = 0;
+			uint32_t pipelinesSkipped      = 0;
+			uint32_t descriptorSets        = 0;
+			uint32_t descriptorSetsSkipped = 0;
+			uint32_t pushConstants         = 0;
+			uint32_t pushConstantsSkipped  = 0;
+		};
+
+		inline auto &getBindStats() const
+		{
+			return bindStats;
+		}
+
 		inline auto getCommandBuffeType() const
 		{
 			return cmdBufferType;
@@ -97,5 +174,34 @@ namespace maple
 		VkSemaphore                                             rendererSemaphore = VK_NULL_HANDLE;
 		std::vector< CommandBuffer::Ptr> secondaryCommands;
 		std::unique_ptr<VulkanFence> updateFence;
+
+		mutable std::vector<VkImageMemoryBarrier>  pendingImageBarriers;
+		mutable std::vector<VkBufferMemoryBarrier> pendingBufferBarriers;
+		mutable VkMemoryBarrier                    pendingMemoryBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		mutable VkPipelineStageFlags               pendingSrcStages = 0;
+		mutable VkPipelineStageFlags               pendingDstStages = 0;
+		mutable BarrierStats                       barrierStats;
+
+		struct BoundSets
+		{
+			VkPipeline                                pipeline = VK_NULL_HANDLE;
+			VkPipelineLayout                          layout   = VK_NULL_HANDLE;
+			std::array<VkDescriptorSet, MaxBoundSets> sets{};
+			std::array<uint32_t, MaxBoundSets>        dynamicOffsets{};
+			uint32_t                                  validSets = 0;        //bit per set index
+		};
+
+		struct BoundPushConstant
+		{
+			VkShaderStageFlags   stages;
+			uint32_t             offset;
+			std::vector<uint8_t> data;
+		};
+
+		//graphics, compute and ray tracing
+		mutable std::array<BoundSets, 3>       boundSets;
+		mutable VkPipelineLayout               pushConstantLayout = VK_NULL_HANDLE;
+		mutable std::vector<BoundPushConstant> boundPushConstants;
+		mutable BindStats                      bindStats;
 	};
 };        // namespace maple
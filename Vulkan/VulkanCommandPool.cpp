@@ -7,7 +7,8 @@
 
 namespace maple
 {
-	VulkanCommandPool::VulkanCommandPool(int32_t queueIndex, VkCommandPoolCreateFlags flags)
+	VulkanCommandPool::VulkanCommandPool(int32_t queueIndex, VkCommandPoolCreateFlags flags) :
+	    queueIndex(queueIndex)
 	{
 		VkCommandPoolCreateInfo createInfo{};
 		createInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -18,11 +19,40 @@ namespace maple
 
 	VulkanCommandPool::~VulkanCommandPool()
 	{
+		//command buffers are freed together with the pool.
 		vkDestroyCommandPool(*VulkanDevice::get(), commandPool, nullptr);
 	}
 
-	auto VulkanCommandPool::reset() -> void
+	auto VulkanCommandPool::reset(bool releaseResources) -> void
 	{
-		vkResetCommandPool(*VulkanDevice::get(), commandPool, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
+		PROFILE_FUNCTION();
+		vkResetCommandPool(*VulkanDevice::get(), commandPool, releaseResources ? VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT : 0);
+		activePrimaryCount   = 0;
+		activeSecondaryCount = 0;
+	}
+
+	auto VulkanCommandPool::requestCommandBuffer(VkCommandBufferLevel level) -> VkCommandBuffer
+	{
+		PROFILE_FUNCTION();
+		const bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		auto &     buffers = primary ? primaryCommandBuffers : secondaryCommandBuffers;
+		auto &     active  = primary ? activePrimaryCount : activeSecondaryCount;
+
+		if (active < buffers.size())
+		{
+			return buffers[active++];
+		}
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level              = level;
+		allocInfo.commandPool        = commandPool;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkAllocateCommandBuffers(*VulkanDevice::get(), &allocInfo, &commandBuffer));
+		buffers.emplace_back(commandBuffer);
+		active++;
+		return commandBuffer;
 	}
 };        // namespace maple
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "VulkanHelper.h"
+#include <vector>
 
 namespace maple
 {
@@ -12,7 +13,16 @@ namespace maple
 	  public:
 		VulkanCommandPool(int32_t queueIndex, VkCommandPoolCreateFlags flags);
 		~VulkanCommandPool();
-		auto reset() -> void;
+		/**
+		 * reset every command buffer allocated from this pool in one call.
+		 * handed out buffers are kept and returned again by requestCommandBuffer.
+		 */
+		auto reset(bool releaseResources = true) -> void;
+		/**
+		 * return a recycled command buffer if there is one, otherwise allocate a new one.
+		 * the buffer stays owned by the pool and is valid until the next reset.
+		 */
+		auto requestCommandBuffer(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) -> VkCommandBuffer;
 
 		autoUnpack(commandPool);
 
@@ -21,7 +31,23 @@ namespace maple
 			return commandPool;
 		}
 
+		inline auto getQueueIndex() const
+		{
+			return queueIndex;
+		}
+
+		inline auto getActiveCount() const
+		{
+			return activePrimaryCount + activeSecondaryCount;
+		}
+
 	  private:
 		VkCommandPool commandPool;
+		int32_t       queueIndex;
+
+		std::vector<VkCommandBuffer> primaryCommandBuffers;
+		std::vector<VkCommandBuffer> secondaryCommandBuffers;
+		uint32_t                     activePrimaryCount   = 0;
+		uint32_t                     activeSecondaryCount = 0;
 	};
 };        // namespace maple
@@ -0,0 +1,144 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanCommandRecycler.h"
+#include "../Console.h"
+#include "VulkanCommandPool.h"
+#include "VulkanDevice.h"
+#include "VulkanFence.h"
+
+namespace maple
+{
+	VulkanCommandRecycler::VulkanCommandRecycler(uint32_t framesCount) :
+	    frames(framesCount)
+	{
+	}
+
+	VulkanCommandRecycler::~VulkanCommandRecycler()
+	{
+		frames.clear();
+		immediates.clear();
+	}
+
+	auto VulkanCommandRecycler::getQueueResources(std::unordered_map<uint32_t, QueueResources> &queues, uint32_t queueFamily) -> QueueResources &
+	{
+		auto &resources = queues[queueFamily];
+		if (resources.commandPool == nullptr)
+		{
+			resources.commandPool = std::make_shared<VulkanCommandPool>(queueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			resources.fencePool   = std::make_shared<VulkanFencePool>();
+		}
+		return resources;
+	}
+
+	auto VulkanCommandRecycler::requestCommandBuffer(uint32_t frameIndex, uint32_t queueFamily, VkCommandBufferLevel level) -> VkCommandBuffer
+	{
+		MAPLE_ASSERT(frameIndex < frames.size(), "Unsupported Frame Index");
+		std::lock_guard<std::mutex> locker(mutex);
+		return getQueueResources(frames[frameIndex].queues, queueFamily).commandPool->requestCommandBuffer(level);
+	}
+
+	auto VulkanCommandRecycler::requestFence(uint32_t frameIndex, uint32_t queueFamily) -> VkFence
+	{
+		MAPLE_ASSERT(frameIndex < frames.size(), "Unsupported Frame Index");
+		std::lock_guard<std::mutex> locker(mutex);
+		return getQueueResources(frames[frameIndex].queues, queueFamily).fencePool->requestFence();
+	}
+
+	auto VulkanCommandRecycler::resetFrame(uint32_t frameIndex) -> void
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(frameIndex < frames.size(), "Unsupported Frame Index");
+		std::lock_guard<std::mutex> locker(mutex);
+
+		auto &frame = frames[frameIndex];
+		MAPLE_ASSERT(frame.uploadCommandBuffer == VK_NULL_HANDLE, "upload command buffer was never submitted");
+
+		for (auto &[family, resources] : frame.queues)
+		{
+			resources.fencePool->wait();
+			resources.fencePool->reset();
+			resources.commandPool->reset(false);
+		}
+	}
+
+	auto VulkanCommandRecycler::getUploadCommandBuffer(uint32_t frameIndex) -> VkCommandBuffer
+	{
+		MAPLE_ASSERT(frameIndex < frames.size(), "Unsupported Frame Index");
+		auto &frame = frames[frameIndex];
+		if (frame.uploadCommandBuffer == VK_NULL_HANDLE)
+		{
+			frame.uploadCommandBuffer = requestCommandBuffer(frameIndex, VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily.value());
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(frame.uploadCommandBuffer, &beginInfo));
+		}
+		return frame.uploadCommandBuffer;
+	}
+
+	auto VulkanCommandRecycler::submitUploads(uint32_t frameIndex, VkQueue queue) -> void
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(frameIndex < frames.size(), "Unsupported Frame Index");
+		auto &frame = frames[frameIndex];
+		if (frame.uploadCommandBuffer == VK_NULL_HANDLE)
+			return;
+
+		//make the uploads visible to everything submitted after them on this queue.
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		vkCmdPipelineBarrier(frame.uploadCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+		VK_CHECK_RESULT(vkEndCommandBuffer(frame.uploadCommandBuffer));
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers    = &frame.uploadCommandBuffer;
+
+		//no fence, the fence of the frame submitted afterwards covers it.
+		VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+		frame.uploadCommandBuffer = VK_NULL_HANDLE;
+	}
+
+	auto VulkanCommandRecycler::acquireImmediate(uint32_t queueFamily) -> VkCommandBuffer
+	{
+		std::lock_guard<std::mutex> locker(mutex);
+		immediateCount++;
+		return getQueueResources(immediates, queueFamily).commandPool->requestCommandBuffer();
+	}
+
+	auto VulkanCommandRecycler::submitImmediate(uint32_t queueFamily, VkCommandBuffer cmd, VkQueue queue) -> void
+	{
+		PROFILE_FUNCTION();
+		VkFence fence = VK_NULL_HANDLE;
+		{
+			std::lock_guard<std::mutex> locker(mutex);
+			fence = getQueueResources(immediates, queueFamily).fencePool->requestFence();
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers    = &cmd;
+
+		VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
+		VK_CHECK_RESULT(vkWaitForFences(*VulkanDevice::get(), 1, &fence, VK_TRUE, UINT64_MAX));
+
+		std::lock_guard<std::mutex> locker(mutex);
+		MAPLE_ASSERT(immediateCount > 0, "submitImmediate without acquireImmediate");
+		//nested one-time commands may still be recording, only recycle once all of them are done.
+		if (--immediateCount == 0)
+		{
+			for (auto &[family, resources] : immediates)
+			{
+				resources.fencePool->reset();
+				resources.commandPool->reset(false);
+			}
+		}
+	}
+};        // namespace maple
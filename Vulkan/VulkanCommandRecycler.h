@@ -0,0 +1,79 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "VulkanHelper.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace maple
+{
+	class VulkanCommandPool;
+	class VulkanFencePool;
+
+	/**
+	 * hands out transient command buffers and fences per queue family.
+	 *
+	 * frame resources are reset in bulk (vkResetCommandPool) once the frame they were
+	 * recorded for has retired. immediate resources are used by blocking one-time
+	 * submissions and are reset as soon as no immediate submission is outstanding.
+	 */
+	class VulkanCommandRecycler
+	{
+	  public:
+		VulkanCommandRecycler(uint32_t framesCount);
+		~VulkanCommandRecycler();
+
+		auto requestCommandBuffer(uint32_t frameIndex, uint32_t queueFamily, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) -> VkCommandBuffer;
+		auto requestFence(uint32_t frameIndex, uint32_t queueFamily) -> VkFence;
+		/**
+		 * the frame must have retired on the GPU. waits for the fences handed out for it,
+		 * then resets all of its pools and fences.
+		 */
+		auto resetFrame(uint32_t frameIndex) -> void;
+
+		/**
+		 * command buffer which collects one-time uploads recorded while a frame is in flight.
+		 * it is begun on first use and submitted ahead of the frame by submitUploads.
+		 */
+		auto getUploadCommandBuffer(uint32_t frameIndex) -> VkCommandBuffer;
+		auto submitUploads(uint32_t frameIndex, VkQueue queue) -> void;
+
+		inline auto isUploadCommandBuffer(uint32_t frameIndex, VkCommandBuffer cmd) const
+		{
+			return frameIndex < frames.size() && cmd != VK_NULL_HANDLE && frames[frameIndex].uploadCommandBuffer == cmd;
+		}
+
+		/**
+		 * blocking path, returns a command buffer which is not begun yet.
+		 */
+		auto acquireImmediate(uint32_t queueFamily) -> VkCommandBuffer;
+		/**
+		 * submit an ended command buffer from acquireImmediate and wait for it.
+		 */
+		auto submitImmediate(uint32_t queueFamily, VkCommandBuffer cmd, VkQueue queue) -> void;
+
+	  private:
+		struct QueueResources
+		{
+			std::shared_ptr<VulkanCommandPool> commandPool;
+			std::shared_ptr<VulkanFencePool>   fencePool;
+		};
+
+		struct FrameResources
+		{
+			std::unordered_map<uint32_t, QueueResources> queues;
+			VkCommandBuffer                              uploadCommandBuffer = VK_NULL_HANDLE;
+		};
+
+		auto getQueueResources(std::unordered_map<uint32_t, QueueResources> &queues, uint32_t queueFamily) -> QueueResources &;
+
+		std::vector<FrameResources>                  frames;
+		std::unordered_map<uint32_t, QueueResources> immediates;
+		uint32_t                                     immediateCount = 0;
+		std::mutex                                   mutex;
+	};
+};        // namespace maple
@@ -46,9 +46,7 @@ namespace maple
 	auto VulkanComputePipeline::bind(const CommandBuffer *cmdBuffer, uint32_t layer, int32_t cubeFace, int32_t mipMapLevel) -> FrameBuffer *
 	{
 		PROFILE_FUNCTION();
-		vkCmdBindPipeline(static_cast<const VulkanCommandBuffer *>(cmdBuffer)->getCommandBuffer(),
-		                  VK_PIPELINE_BIND_POINT_COMPUTE,
-		                  pipeline);
+		static_cast<const VulkanCommandBuffer *>(cmdBuffer)->bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
 		return nullptr;
 	}
 };        // namespace maple
@@ -3,9 +3,12 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "VulkanContext.h"
 #include "VkCommon.h"
+#include "VulkanAsyncCompute.h"
 #include "VulkanCommandBuffer.h"
+#include "VulkanCommandRecycler.h"
 #include "VulkanDevice.h"
 #include "VulkanFence.h"
+#include "VulkanGPUProfiler.h"
 #include "VulkanHelper.h"
 #include "VulkanRenderDevice.h"
 #include "VulkanSwapChain.h"
@@ -17,6 +20,7 @@
 #endif
 
 #include "../Console.h"
+#include <imgui.h>
 
 #define VK_LAYER_LUNARG_STANDARD_VALIDATION_NAME "VK_LAYER_LUNARG_standard_validation"
 #define VK_LAYER_LUNARG_ASSISTENT_LAYER_NAME "VK_LAYER_LUNARG_assistant_layer"
@@ -47,7 +51,7 @@ namespace maple
 			return layers;
 		}
 
-		inline auto getRequiredExtensions()
+		inline auto getRequiredExtensions(bool headless)
 		{
 			std::vector<const char *> extensions;
 
@@ -57,6 +61,10 @@ namespace maple
 				extensions.emplace_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 			}
 
+			//no surface is created without a window.
+			if (headless)
+				return extensions;
+
 			extensions.emplace_back("VK_KHR_surface");
 #if defined(TRACY_ENABLE) && defined(PLATFORM_WINDOWS)
 			//extensions.emplace_back("VK_EXT_calibrated_timestamps");
@@ -191,10 +199,20 @@ namespace maple
 
 	VulkanContext::~VulkanContext()
 	{
-		for (int32_t i = 0; i < 3; i++)
+		//frames may still be in flight.
+		if (vkInstance != nullptr)
+			waitIdle();
+
+		for (uint32_t i = 0; i < MAX_SWAPCHAIN_BUFFERS; i++)
 		{
 			getDeletionQueue(i).flush();
 		}
+		//drains what the background thread still holds before the device goes away.
+		VulkanDeletionQueue::setBackgroundThread(false);
+
+		gpuProfiler.reset();
+		asyncCompute.reset();
+		commandRecycler.reset();
 
 		if (reportCallback)
 		{
@@ -235,12 +253,20 @@ namespace maple
 	auto VulkanContext::init(void* nativeWin, uint32_t width, uint32_t height) -> void
 	{
 		PROFILE_FUNCTION();
+		headless = nativeWin == nullptr;
+		if (headless)
+			LOGI("[VULKAN] headless context {0}x{1}", width, height);
+
 		createInstance();
 		VulkanDevice::get()->init();
 		setupDebug();
 
+		commandRecycler = std::make_shared<VulkanCommandRecycler>(MAX_SWAPCHAIN_BUFFERS);
+		asyncCompute    = std::make_shared<VulkanAsyncCompute>();
+
 		swapChain    = SwapChain::create(width,height);
 		swapChain->init(false, nativeWin);
+		gpuProfiler  = GPUProfiler::create();
 
 		auto & properties = VulkanDevice::get()->getPhysicalDevice()->getProperties();
 		caps.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
@@ -272,6 +298,25 @@ namespace maple
 
 	auto VulkanContext::onImGui() -> void
 	{
+		if (gpuProfiler != nullptr)
+			gpuProfiler->onImGui();
+
+		if (!ImGui::Begin("Deletion Queue"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		auto background = VulkanDeletionQueue::isBackgroundThreadEnabled();
+		if (ImGui::Checkbox("Background Thread", &background))
+			VulkanDeletionQueue::setBackgroundThread(background);
+
+		for (uint32_t i = 0; i < MAX_SWAPCHAIN_BUFFERS; i++)
+		{
+			auto &stats = deletionQueue[i].getStats();
+			ImGui::Text("Frame %u : handles %u (offloaded %u), callbacks %u", i, stats.handles, stats.offloaded, stats.callbacks);
+		}
+		ImGui::End();
 	}
 
 	auto VulkanContext::waitIdle() const -> void
@@ -284,7 +329,7 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		instanceLayerNames     = getRequiredLayers();
-		instanceExtensionNames = getRequiredExtensions();
+		instanceExtensionNames = getRequiredExtensions(headless);
 		if (VkConfig::EnableValidationLayers && !checkValidationLayerSupport(instanceLayers, instanceLayerNames))
 		{
 			LOGC("[VULKAN] Validation layers requested, but not available!");
@@ -330,14 +375,19 @@ namespace maple
 		return std::static_pointer_cast<VulkanContext>(GraphicsContext::get());
 	}
 
+	auto VulkanContext::getCurrentFrameIndex() const -> uint32_t
+	{
+		return swapChain != nullptr ? swapChain->getCurrentBufferIndex() : 0;
+	}
+
 	auto VulkanContext::getDeletionQueue() -> CommandQueue &
 	{
-		return get()->deletionQueue[(get()->vkInstance) ? get()->getSwapChain()->getCurrentBufferIndex() : 0];
+		return get()->deletionQueue[get()->getCurrentFrameIndex()];
 	}
 
 	auto VulkanContext::getDeletionQueue(uint32_t index) -> CommandQueue &
 	{
-		MAPLE_ASSERT(index < 3, "Unsupported Frame Index");
+		MAPLE_ASSERT(index < MAX_SWAPCHAIN_BUFFERS, "Unsupported Frame Index");
 		return get()->deletionQueue[index];
 	}
 
@@ -346,29 +396,24 @@ namespace maple
 		return VulkanDevice::get()->getPhysicalDevice()->isRaytracingSupported();
 	}
 
+	auto VulkanContext::getFrameUploadCommandBuffer() -> VkCommandBuffer
+	{
+		auto vkSwapChain = std::static_pointer_cast<VulkanSwapChain>(swapChain);
+		if (commandRecycler == nullptr || vkSwapChain == nullptr || !vkSwapChain->isRecording())
+			return VK_NULL_HANDLE;
+		return commandRecycler->getUploadCommandBuffer(vkSwapChain->getCurrentBufferIndex());
+	}
+
 	auto VulkanContext::immediateSubmit(const std::function<void(CommandBuffer *)> &execute) -> void
 	{
 		PROFILE_FUNCTION();
-		auto updateFence = std::make_unique<VulkanFence>();
-
-		auto cmd   = CommandBuffer::create();
-		auto vkCmd = std::static_pointer_cast<VulkanCommandBuffer>(cmd);
-		cmd->init(true);
-		cmd->beginRecording();
-		execute(cmd.get());
-		cmd->endRecording();
-		auto         cmdAddress = vkCmd->getCommandBuffer();
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount   = 1;
-		submitInfo.pCommandBuffers      = &cmdAddress;
-		submitInfo.pSignalSemaphores    = nullptr;
-		submitInfo.pNext                = nullptr;
-		submitInfo.pWaitDstStageMask    = nullptr;
-		submitInfo.signalSemaphoreCount = 0;
-		submitInfo.waitSemaphoreCount   = 0;
-
-		VK_CHECK_RESULT(vkQueueSubmit(VulkanDevice::get()->getGraphicsQueue(), 1, &submitInfo, updateFence->getHandle()));
-		updateFence->wait();
+		const auto graphicsFamily = VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily.value();
+
+		//wrap a recycled handle, no pool/fence/semaphore is created per submission.
+		VulkanCommandBuffer cmd(commandRecycler->acquireImmediate(graphicsFamily));
+		cmd.beginRecording();
+		execute(&cmd);
+		cmd.endRecording();
+		commandRecycler->submitImmediate(graphicsFamily, cmd.getCommandBuffer(), VulkanDevice::get()->getGraphicsQueue());
 	}
 }        // namespace maple
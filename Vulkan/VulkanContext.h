@@ -3,15 +3,18 @@
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "../GraphicsContext.h"
-#include <deque>
 #include <memory>
 #include <vector>
 #include "VkCommon.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanSwapChain.h"
 
 namespace maple
 {
 	class UniformBuffer;
 	class VulkanFence;
+	class VulkanCommandRecycler;
+	class VulkanAsyncCompute;
 
 	class  VulkanContext : public GraphicsContext
 	{
@@ -50,42 +53,43 @@ namespace maple
 			return vkInstance;
 		}
 
-		struct CommandQueue
-		{
-			CommandQueue()                     = default;
-			CommandQueue(const CommandQueue &) = delete;
-			auto operator=(const CommandQueue &) -> CommandQueue & = delete;
-
-			std::deque<std::function<void()>> deletors;
-
-			template <typename F>
-			inline auto emplace(F &&function)
-			{
-				deletors.emplace_back(function);
-			}
-
-			inline auto flush()
-			{
-				for (auto it = deletors.rbegin(); it != deletors.rend(); it++)
-				{
-					(*it)();
-				}
-				deletors.clear();
-			}
-		};
+		using CommandQueue = VulkanDeletionQueue;
 
 		static auto get() -> std::shared_ptr<VulkanContext>;
 
+		/**
+		 * index of the frame in flight, 0 before the swap chain exists.
+		 */
+		auto getCurrentFrameIndex() const -> uint32_t;
+
 		static auto getDeletionQueue() -> CommandQueue &;
 		static auto getDeletionQueue(uint32_t index) -> CommandQueue &;
 
+		inline auto getCommandRecycler()
+		{
+			return commandRecycler;
+		}
+
+		inline auto getAsyncCompute()
+		{
+			return asyncCompute;
+		}
+
+		/**
+		 * upload command buffer of the frame being recorded, or VK_NULL_HANDLE when no frame is recording.
+		 */
+		auto getFrameUploadCommandBuffer() -> VkCommandBuffer;
+
 	  private:
 		auto setupDebug() -> void;
 
 		VkInstance vkInstance = nullptr;
 
-		//bind to triple buffer
-		CommandQueue deletionQueue[3];
+		//one per frame in flight slot
+		CommandQueue deletionQueue[MAX_SWAPCHAIN_BUFFERS];
+
+		std::shared_ptr<VulkanCommandRecycler> commandRecycler;
+		std::shared_ptr<VulkanAsyncCompute>    asyncCompute;
 
 		std::vector<const char *>          instanceLayerNames;
 		std::vector<const char *>          instanceExtensionNames;
@@ -26,7 +26,7 @@ namespace maple
 		auto cmdBeginLabel(const std::string &caption) -> void
 		{
 				PROFILE_FUNCTION();
-			auto index = maple::GraphicsContext::get()->getSwapChain()->getCurrentBufferIndex();
+			auto index = maple::VulkanContext::get()->getCurrentFrameIndex();
 
 			if(lastIndex != index) 
 			{ 
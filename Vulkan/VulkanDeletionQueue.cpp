@@ -0,0 +1,261 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanDeletionQueue.h"
+#include "../Console.h"
+#include "VulkanDevice.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace maple
+{
+	namespace
+	{
+		using Entry = VulkanDeletionQueue::Entry;
+
+		struct Batch
+		{
+			std::vector<Entry> entries;
+			VkDevice           device;
+#ifdef USE_VMA_ALLOCATOR
+			VmaAllocator allocator;
+#endif
+		};
+
+		template <typename Handle>
+		inline auto toHandle(uint64_t handle)
+		{
+			if constexpr (std::is_pointer_v<Handle>)
+				return reinterpret_cast<Handle>(handle);
+			else
+				return static_cast<Handle>(handle);
+		}
+
+		inline auto destroyEntry(const Batch &batch, const Entry &entry)
+		{
+			auto device = batch.device;
+			switch (entry.type)
+			{
+				case DeletionType::DescriptorSet:
+				{
+					auto set = toHandle<VkDescriptorSet>(entry.handle);
+					vkFreeDescriptorSets(device, toHandle<VkDescriptorPool>(entry.owner), 1, &set);
+					break;
+				}
+				case DeletionType::Framebuffer:
+					vkDestroyFramebuffer(device, toHandle<VkFramebuffer>(entry.handle), nullptr);
+					break;
+				case DeletionType::Pipeline:
+					vkDestroyPipeline(device, toHandle<VkPipeline>(entry.handle), nullptr);
+					break;
+				case DeletionType::RenderPass:
+					vkDestroyRenderPass(device, toHandle<VkRenderPass>(entry.handle), nullptr);
+					break;
+				case DeletionType::ImageView:
+					vkDestroyImageView(device, toHandle<VkImageView>(entry.handle), nullptr);
+					break;
+				case DeletionType::Sampler:
+					vkDestroySampler(device, toHandle<VkSampler>(entry.handle), nullptr);
+					break;
+				case DeletionType::AccelerationStructure:
+					vkDestroyAccelerationStructureKHR(device, toHandle<VkAccelerationStructureKHR>(entry.handle), nullptr);
+					break;
+				case DeletionType::QueryPool:
+					vkDestroyQueryPool(device, toHandle<VkQueryPool>(entry.handle), nullptr);
+					break;
+#ifdef USE_VMA_ALLOCATOR
+				case DeletionType::Buffer:
+					vmaDestroyBuffer(batch.allocator, toHandle<VkBuffer>(entry.handle), static_cast<VmaAllocation>(entry.allocation));
+					break;
+				case DeletionType::Image:
+					vmaDestroyImage(batch.allocator, toHandle<VkImage>(entry.handle), static_cast<VmaAllocation>(entry.allocation));
+					break;
+				case DeletionType::Allocation:
+					vmaFreeMemory(batch.allocator, static_cast<VmaAllocation>(entry.allocation));
+					break;
+#else
+				case DeletionType::Buffer:
+					vkDestroyBuffer(device, toHandle<VkBuffer>(entry.handle), nullptr);
+					break;
+				case DeletionType::Image:
+					vkDestroyImage(device, toHandle<VkImage>(entry.handle), nullptr);
+					break;
+				case DeletionType::Allocation:
+					MAPLE_ASSERT(false, "VmaAllocation without USE_VMA_ALLOCATOR");
+					break;
+#endif
+				case DeletionType::Memory:
+					vkFreeMemory(device, toHandle<VkDeviceMemory>(entry.handle), nullptr);
+					break;
+			}
+		}
+
+		inline auto destroyBatch(const Batch &batch)
+		{
+			PROFILE_FUNCTION();
+			for (auto &entry : batch.entries)
+				destroyEntry(batch, entry);
+		}
+
+		/**
+		 * destroys the handles of retired frames off the render thread. the vectors come back as
+		 * spares so the queues keep reusing their capacity.
+		 */
+		class DeletionWorker
+		{
+		  public:
+			~DeletionWorker()
+			{
+				stop();
+			}
+
+			auto start() -> void
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (running)
+					return;
+				running = true;
+				thread  = std::thread(&DeletionWorker::run, this);
+			}
+
+			auto stop() -> void
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!running)
+						return;
+					running = false;
+				}
+				condition.notify_one();
+				thread.join();
+				spares.clear();
+			}
+
+			inline auto isRunning()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				return running;
+			}
+
+			/**
+			 * hands over the entries and leaves a spare vector in their place.
+			 */
+			auto submit(Batch &&batch, std::vector<Entry> &entries) -> void
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					pending.emplace_back(std::move(batch));
+					if (!spares.empty())
+					{
+						entries = std::move(spares.back());
+						spares.pop_back();
+					}
+				}
+				condition.notify_one();
+			}
+
+		  private:
+			auto run() -> void
+			{
+				std::vector<Batch> batches;
+				std::unique_lock<std::mutex> lock(mutex);
+				while (true)
+				{
+					condition.wait(lock, [&] { return !running || !pending.empty(); });
+					if (pending.empty())
+						break;
+
+					std::swap(batches, pending);
+					lock.unlock();
+					for (auto &batch : batches)
+					{
+						destroyBatch(batch);
+						batch.entries.clear();
+					}
+					lock.lock();
+
+					for (auto &batch : batches)
+						spares.emplace_back(std::move(batch.entries));
+					batches.clear();
+				}
+			}
+
+			std::thread                     thread;
+			std::mutex                      mutex;
+			std::condition_variable         condition;
+			std::vector<Batch>              pending;
+			std::vector<std::vector<Entry>> spares;
+			bool                            running = false;
+		};
+
+		DeletionWorker worker;
+	}        // namespace
+
+	auto VulkanDeletionQueue::flush() -> void
+	{
+		PROFILE_FUNCTION();
+		stats           = {};
+		stats.callbacks = static_cast<uint32_t>(deletors.size());
+		stats.handles   = static_cast<uint32_t>(entries.size());
+
+		for (auto it = deletors.rbegin(); it != deletors.rend(); it++)
+		{
+			(*it)();
+		}
+		deletors.clear();
+
+		if (entries.empty())
+			return;
+
+		//grouped by type, releases of the same type keep their order.
+		std::stable_sort(entries.begin(), entries.end(), [](const Entry &left, const Entry &right) {
+			return left.type < right.type;
+		});
+
+		auto  device = VulkanDevice::get();
+		Batch batch{{}, *device};
+#ifdef USE_VMA_ALLOCATOR
+		batch.allocator = device->getAllocator();
+#endif
+
+		if (!worker.isRunning())
+		{
+			batch.entries = std::move(entries);
+			destroyBatch(batch);
+			entries = std::move(batch.entries);
+			entries.clear();
+			return;
+		}
+
+		//descriptor sets sort first and stay here, their pool is not ours to touch from another thread.
+		auto sets = std::find_if(entries.begin(), entries.end(), [](const Entry &entry) {
+			return entry.type != DeletionType::DescriptorSet;
+		});
+		for (auto it = entries.begin(); it != sets; it++)
+			destroyEntry(batch, *it);
+		entries.erase(entries.begin(), sets);
+
+		stats.offloaded = static_cast<uint32_t>(entries.size());
+		if (!entries.empty())
+		{
+			batch.entries = std::move(entries);
+			entries       = {};
+			worker.submit(std::move(batch), entries);
+		}
+	}
+
+	auto VulkanDeletionQueue::setBackgroundThread(bool enable) -> void
+	{
+		if (enable)
+			worker.start();
+		else
+			worker.stop();
+	}
+
+	auto VulkanDeletionQueue::isBackgroundThreadEnabled() -> bool
+	{
+		return worker.isRunning();
+	}
+}        // namespace maple
@@ -0,0 +1,114 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "VkCommon.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * ordered so objects go before the objects they refer to, views before images,
+	 * acceleration structures before buffers and everything before its memory.
+	 */
+	enum class DeletionType : uint8_t
+	{
+		DescriptorSet,        //owner is the descriptor pool
+		Framebuffer,
+		Pipeline,
+		RenderPass,
+		ImageView,
+		Sampler,
+		AccelerationStructure,
+		QueryPool,
+		Buffer,        //allocation is the VmaAllocation under USE_VMA_ALLOCATOR, may be null
+		Image,         //allocation is the VmaAllocation under USE_VMA_ALLOCATOR, may be null
+		Memory,
+		Allocation,        //VmaAllocation without a resource
+	};
+
+	/**
+	 * resources of one frame in flight, destroyed once the frame retired.
+	 *
+	 * plain handles go into a reused array of POD entries and are destroyed grouped by type, which
+	 * can run on a background thread. descriptor sets are always freed on the flushing thread
+	 * because their pool is externally synchronized. emplace keeps taking callbacks for releases
+	 * which need more than a handle, those run on the flushing thread before the handles.
+	 */
+	class VulkanDeletionQueue
+	{
+	  public:
+		struct Stats
+		{
+			uint32_t handles   = 0;
+			uint32_t callbacks = 0;
+			uint32_t offloaded = 0;        //handles passed to the background thread
+		};
+
+		VulkanDeletionQueue()                            = default;
+		VulkanDeletionQueue(const VulkanDeletionQueue &) = delete;
+		auto operator=(const VulkanDeletionQueue &) -> VulkanDeletionQueue & = delete;
+
+		template <typename F>
+		inline auto emplace(F &&function)
+		{
+			deletors.emplace_back(std::forward<F>(function));
+		}
+
+		/**
+		 * owner is only used by descriptor sets, the pool they are freed to.
+		 */
+		template <typename Handle, typename Owner = uint64_t>
+		inline auto destroy(DeletionType type, Handle handle, void *allocation = nullptr, Owner owner = 0)
+		{
+			entries.push_back({toUint64(handle), toUint64(owner), allocation, type});
+		}
+
+		auto flush() -> void;
+
+		/**
+		 * counts of the last flush.
+		 */
+		inline auto &getStats() const
+		{
+			return stats;
+		}
+
+		/**
+		 * handles of later flushes are destroyed by a background thread. disabling waits for it
+		 * to finish, which has to happen before the device is destroyed.
+		 */
+		static auto setBackgroundThread(bool enable) -> void;
+		static auto isBackgroundThreadEnabled() -> bool;
+
+		struct Entry
+		{
+			uint64_t     handle;
+			uint64_t     owner;
+			void *       allocation;
+			DeletionType type;
+		};
+
+	  private:
+		//non-dispatchable handles are pointers on 64 bit platforms and integers elsewhere.
+		template <typename Handle>
+		static inline auto toUint64(Handle handle) -> uint64_t
+		{
+			if constexpr (std::is_null_pointer_v<Handle>)
+				return 0;
+			else if constexpr (std::is_pointer_v<Handle>)
+				return reinterpret_cast<uint64_t>(handle);
+			else
+				return static_cast<uint64_t>(handle);
+		}
+
+		std::vector<Entry>                entries;
+		std::deque<std::function<void()>> deletors;
+		Stats                             stats;
+	};
+}        // namespace maple
@@ -4,6 +4,7 @@
 
 #include "VulkanDescriptorSet.h"
 #include "../Console.h"
+#include "../StringUtils.h"
 #include "Raytracing/VulkanAccelerationStructure.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
@@ -75,6 +76,17 @@ namespace maple
 				((VulkanTextureDepthArray*)texture)->transitionImage(VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, commandBuffer);
 			}
 		}
+
+		/**
+		 * storage buffers sub-allocated from a geometry heap must not reach into the rest of their page.
+		 */
+		inline auto getBufferRange(const Descriptor& descriptor, const GPUBuffer* buffer) -> VkDeviceSize
+		{
+			auto range = buffer->getRange();
+			if (range == 0 || descriptor.size != VK_WHOLE_SIZE)
+				return descriptor.size;
+			return range - descriptor.offset;
+		}
 	}        // namespace
 
 	VulkanDescriptorSet::VulkanDescriptorSet(const DescriptorInfo& info)
@@ -178,10 +190,8 @@ namespace maple
 		PROFILE_FUNCTION();
 		for (uint32_t frame = 0; frame < framesInFlight; frame++)
 		{
-			auto  vkSet = descriptorSet[frame];
-			auto  pool = descriptorPool;
 			auto& deletionQueue = VulkanContext::getDeletionQueue();
-			deletionQueue.emplace([vkSet, pool] { vkFreeDescriptorSets(*VulkanDevice::get(), pool, 1, &vkSet); });
+			deletionQueue.destroy(DeletionType::DescriptorSet, descriptorSet[frame], nullptr, descriptorPool);
 		}
 	}
 
@@ -316,8 +326,8 @@ namespace maple
 					for (auto& ssbo : buffers)
 					{
 						bufferInfoPool[index + i].buffer = (VkBuffer)ssbo->handle();
-						bufferInfoPool[index + i].offset = imageInfo.offset;
-						bufferInfoPool[index + i].range = imageInfo.size;
+						bufferInfoPool[index + i].offset = imageInfo.offset + ssbo->getOffset();
+						bufferInfoPool[index + i].range = getBufferRange(imageInfo, ssbo.get());
 						i++;
 					}
 
@@ -325,8 +335,8 @@ namespace maple
 					for (auto& ssbo : buffers2)
 					{
 						bufferInfoPool[index + i].buffer =(VkBuffer)ssbo->handle();
-						bufferInfoPool[index + i].offset = imageInfo.offset;
-						bufferInfoPool[index + i].range = imageInfo.size;
+						bufferInfoPool[index + i].offset = imageInfo.offset + ssbo->getOffset();
+						bufferInfoPool[index + i].range = getBufferRange(imageInfo, ssbo);
 						i++;
 					}
 
@@ -445,8 +455,8 @@ namespace maple
 					for (auto& ssbo : buffers)
 					{
 						bufferInfoPool[index + i].buffer = (VkBuffer)ssbo->handle();
-						bufferInfoPool[index + i].offset = imageInfo.offset;
-						bufferInfoPool[index + i].range = imageInfo.size;
+						bufferInfoPool[index + i].offset = imageInfo.offset + ssbo->getOffset();
+						bufferInfoPool[index + i].range = getBufferRange(imageInfo, ssbo.get());
 						i++;
 					}
 
@@ -456,8 +466,8 @@ namespace maple
 					for (auto& ssbo : buffers2)
 					{
 						bufferInfoPool[index + i].buffer = (VkBuffer)ssbo->handle();
-						bufferInfoPool[index + i].offset = imageInfo.offset;
-						bufferInfoPool[index + i].range = imageInfo.size;
+						bufferInfoPool[index + i].offset = imageInfo.offset + ssbo->getOffset();
+						bufferInfoPool[index + i].range = getBufferRange(imageInfo, ssbo);
 						i++;
 					}
 
@@ -726,7 +736,7 @@ namespace maple
 		int32_t i = 0;
 		for (auto desc : descriptorSet)
 		{
-			VulkanHelper::setObjectName(name + ":" + std::to_string(i), (uint64_t)desc, VK_OBJECT_TYPE_DESCRIPTOR_SET);
+			VulkanHelper::setObjectName(StringUtils::formatTemp("%s:%d", name.c_str(), i++).data(), (uint64_t)desc, VK_OBJECT_TYPE_DESCRIPTOR_SET);
 		}
 	}
 };        // namespace maple
@@ -6,6 +6,7 @@
 #include "VulkanCommandPool.h"
 #include "VulkanContext.h"
 #include "VulkanHelper.h"
+#include "VulkanLayoutCache.h"
 #include <stdexcept>
 
 namespace maple
@@ -240,6 +241,7 @@ namespace maple
 
 	VulkanDevice::~VulkanDevice()
 	{
+		layoutCache.reset();
 		vkDestroyPipelineCache(device, pipelineCache, VK_NULL_HANDLE);
 
 		if (device != nullptr)
@@ -250,15 +252,6 @@ namespace maple
 #endif
 	}
 
-	auto VulkanDevice::createTracyContext() -> void
-	{
-		VkCommandBufferAllocateInfo allocInfo = {};
-		allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool                 = *commandPool;
-		allocInfo.commandBufferCount          = 1;
-	}
-
 	auto VulkanDevice::init() -> bool
 	{
 		const std::vector<const char *> kValidationLayers = {
@@ -282,12 +275,20 @@ namespace maple
 
 		vkGetPhysicalDeviceFeatures2(*physicalDevice, &physicalDeviceFeatures2);
 
+		//every supported feature in the chain is enabled, async compute relies on timeline semaphores.
+		physicalDevice->timelineSemaphoreSupport       = features12.timelineSemaphore == VK_TRUE;
+		physicalDevice->drawIndirectCountSupport       = features12.drawIndirectCount == VK_TRUE;
+		physicalDevice->pipelineStatisticsQuerySupport = physicalDeviceFeatures2.features.pipelineStatisticsQuery == VK_TRUE;
+		physicalDevice->hostQueryResetSupport          = features12.hostQueryReset == VK_TRUE;
+
 		std::vector<const char *> deviceExtensions = {
-		    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 		    VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME,
 			VK_KHR_MAINTENANCE1_EXTENSION_NAME
 		};
 
+		if (!VulkanContext::get()->isHeadless())
+			deviceExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
 		// Ray Tracing Features
 		VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructure{};
 		VkPhysicalDeviceRayTracingPipelineFeaturesKHR    raytracing{};
@@ -409,8 +410,8 @@ namespace maple
 
 		commandPool = std::make_shared<VulkanCommandPool>(physicalDevice->indices.graphicsFamily.value(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
-		createTracyContext();
 		createPipelineCache();
+		layoutCache = std::make_shared<VulkanLayoutCache>(device);
 
 		physicalDevice->getRaytracingProperties();
 
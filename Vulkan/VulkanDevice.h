@@ -13,6 +13,7 @@
 namespace maple
 {
 	class VulkanCommandPool;
+	class VulkanLayoutCache;
 
 	class VulkanPhysicalDevice final
 	{
@@ -61,6 +62,26 @@ namespace maple
 			return raytracingSupport;
 		}
 
+		inline auto isTimelineSemaphoreSupported() const
+		{
+			return timelineSemaphoreSupport;
+		}
+
+		inline auto isDrawIndirectCountSupported() const
+		{
+			return drawIndirectCountSupport;
+		}
+
+		inline auto isPipelineStatisticsQuerySupported() const
+		{
+			return pipelineStatisticsQuerySupport;
+		}
+
+		inline auto isHostQueryResetSupported() const
+		{
+			return hostQueryResetSupport;
+		}
+
 	  private:
 		std::vector<VkQueueFamilyProperties> queueFamilyProperties;
 		std::unordered_set<std::string>      supportedExtensions;
@@ -74,7 +95,11 @@ namespace maple
 
 		friend class VulkanDevice;
 		QueueFamilyIndices indices;
-		bool               raytracingSupport = false;
+		bool               raytracingSupport              = false;
+		bool               timelineSemaphoreSupport       = false;
+		bool               drawIndirectCountSupport       = false;
+		bool               pipelineStatisticsQuerySupport = false;
+		bool               hostQueryResetSupport          = false;
 	};
 
 	class VulkanDevice final
@@ -117,6 +142,11 @@ namespace maple
 			return pipelineCache;
 		}
 
+		inline auto &getLayoutCache() const
+		{
+			return layoutCache;
+		}
+
 		static auto get() -> std::shared_ptr<VulkanDevice>
 		{
 			if (instance == nullptr)
@@ -139,10 +169,9 @@ namespace maple
 #endif
 
 	  private:
-		auto createTracyContext() -> void;
-
 		std::shared_ptr<VulkanPhysicalDevice> physicalDevice;
 		std::shared_ptr<VulkanCommandPool>    commandPool;
+		std::shared_ptr<VulkanLayoutCache>    layoutCache;
 		static std::shared_ptr<VulkanDevice>  instance;
 
 		VkDevice device = nullptr;
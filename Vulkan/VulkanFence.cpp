@@ -82,4 +82,49 @@ namespace maple
 			wait();
 		reset();
 	}
+
+	VulkanFencePool::~VulkanFencePool()
+	{
+		for (auto fence : fences)
+		{
+			vkDestroyFence(*VulkanDevice::get(), fence, nullptr);
+		}
+	}
+
+	auto VulkanFencePool::requestFence() -> VkFence
+	{
+		PROFILE_FUNCTION();
+		if (activeCount < fences.size())
+		{
+			return fences[activeCount++];
+		}
+
+		VkFenceCreateInfo fenceCreateInfo{};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		VkFence fence = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreateFence(*VulkanDevice::get(), &fenceCreateInfo, nullptr, &fence));
+		fences.emplace_back(fence);
+		activeCount++;
+		return fence;
+	}
+
+	auto VulkanFencePool::wait(uint64_t timeout) -> void
+	{
+		PROFILE_FUNCTION();
+		if (activeCount > 0)
+		{
+			VK_CHECK_RESULT(vkWaitForFences(*VulkanDevice::get(), activeCount, fences.data(), VK_TRUE, timeout));
+		}
+	}
+
+	auto VulkanFencePool::reset() -> void
+	{
+		PROFILE_FUNCTION();
+		if (activeCount > 0)
+		{
+			VK_CHECK_RESULT(vkResetFences(*VulkanDevice::get(), activeCount, fences.data()));
+		}
+		activeCount = 0;
+	}
 };        // namespace maple
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "VulkanHelper.h"
+#include <vector>
 
 namespace maple
 {
@@ -34,4 +35,27 @@ namespace maple
 		VkFence handle;
 		bool    signaled;
 	};
+
+	/**
+	 * fences handed out by requestFence are recycled in bulk by reset,
+	 * instead of creating a VulkanFence for every submission.
+	 */
+	class VulkanFencePool
+	{
+	  public:
+		VulkanFencePool() = default;
+		~VulkanFencePool();
+		auto requestFence() -> VkFence;
+		auto wait(uint64_t timeout = UINT64_MAX) -> void;
+		auto reset() -> void;
+
+		inline auto getActiveCount() const
+		{
+			return activeCount;
+		}
+
+	  private:
+		std::vector<VkFence> fences;
+		uint32_t             activeCount = 0;
+	};
 }        // namespace maple
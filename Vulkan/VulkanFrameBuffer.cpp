@@ -55,8 +55,7 @@ namespace maple
 	VulkanFrameBuffer::~VulkanFrameBuffer()
 	{
 		auto &deletionQueue = VulkanContext::get()->getDeletionQueue();
-		auto  framebuffer   = this->buffer;
-		deletionQueue.emplace([framebuffer] { vkDestroyFramebuffer(*VulkanDevice::get(), framebuffer, VK_NULL_HANDLE); });
+		deletionQueue.destroy(DeletionType::Framebuffer, buffer);
 	}
 
 };        // namespace maple
@@ -0,0 +1,258 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanGPUProfiler.h"
+#include "../Console.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanContext.h"
+#include "VulkanDevice.h"
+
+namespace maple
+{
+	namespace
+	{
+		constexpr VkQueryPipelineStatisticFlags StatisticsFlags =
+		    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+		    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+		//one value per statistic bit plus the availability word.
+		constexpr uint32_t StatisticsStride = 8;
+
+		inline auto createQueryPool(VkQueryType type, uint32_t count, VkQueryPipelineStatisticFlags statistics = 0) -> VkQueryPool
+		{
+			VkQueryPoolCreateInfo createInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+			createInfo.queryType          = type;
+			createInfo.queryCount         = count;
+			createInfo.pipelineStatistics = statistics;
+
+			VkQueryPool pool = VK_NULL_HANDLE;
+			VK_CHECK_RESULT(vkCreateQueryPool(*VulkanDevice::get(), &createInfo, nullptr, &pool));
+			return pool;
+		}
+	}        // namespace
+
+	VulkanGPUProfiler::VulkanGPUProfiler()
+	{
+		auto  physicalDevice = VulkanDevice::get()->getPhysicalDevice();
+		auto &limits         = physicalDevice->getProperties().limits;
+
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(*physicalDevice, &familyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(*physicalDevice, &familyCount, families.data());
+
+		auto validBits      = families[physicalDevice->getQueueFamilyIndices().graphicsFamily.value()].timestampValidBits;
+		timestampSupported  = validBits > 0 && limits.timestampPeriod > 0;
+		timestampMask       = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+		timestampPeriod     = limits.timestampPeriod;
+		statisticsSupported = physicalDevice->isPipelineStatisticsQuerySupported();
+
+		if (!timestampSupported)
+		{
+			LOGW("timestamp queries are not supported on the graphics queue, GPU profiler disabled");
+			enabled = false;
+			return;
+		}
+
+		for (auto &frame : frames)
+		{
+			frame.timestamps = createQueryPool(VK_QUERY_TYPE_TIMESTAMP, MaxScopes * 2);
+			if (statisticsSupported)
+				frame.statistics = createQueryPool(VK_QUERY_TYPE_PIPELINE_STATISTICS, MaxScopes, StatisticsFlags);
+			frame.scopes.reserve(MaxScopes);
+		}
+		stack.reserve(32);
+	}
+
+	VulkanGPUProfiler::~VulkanGPUProfiler()
+	{
+		for (auto &frame : frames)
+		{
+			if (frame.timestamps != VK_NULL_HANDLE)
+				vkDestroyQueryPool(*VulkanDevice::get(), frame.timestamps, nullptr);
+			if (frame.statistics != VK_NULL_HANDLE)
+				vkDestroyQueryPool(*VulkanDevice::get(), frame.statistics, nullptr);
+		}
+	}
+
+	auto VulkanGPUProfiler::beginFrame(const CommandBuffer *cmd) -> void
+	{
+		PROFILE_FUNCTION();
+		auto &queries = frames[VulkanContext::get()->getSwapChain()->getCurrentBufferIndex()];
+		//the pool was used the last time this buffer index came around, read it before it is reset.
+		if (queries.pending)
+			resolve(queries);
+
+		current       = nullptr;
+		commandBuffer = VK_NULL_HANDLE;
+		stack.clear();
+		activeStatistics = InvalidScope;
+
+		if (!enabled || !timestampSupported)
+			return;
+
+		current                   = &queries;
+		commandBuffer             = static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer();
+		queries.frame             = frameCounter++;
+		queries.statisticsCount   = 0;
+		queries.collectStatistics = pipelineStatistics;
+		queries.scopes.clear();
+
+		vkCmdResetQueryPool(commandBuffer, queries.timestamps, 0, MaxScopes * 2);
+		if (queries.collectStatistics)
+			vkCmdResetQueryPool(commandBuffer, queries.statistics, 0, MaxScopes);
+
+		begin(cmd, "Frame");
+	}
+
+	auto VulkanGPUProfiler::endFrame(const CommandBuffer *cmd) -> void
+	{
+		PROFILE_FUNCTION();
+		auto &stats                          = static_cast<const VulkanCommandBuffer *>(cmd)->getBindStats();
+		bindStatistics.pipelines             = stats.pipelines;
+		bindStatistics.pipelinesSkipped      = stats.pipelinesSkipped;
+		bindStatistics.descriptorSets        = stats.descriptorSets;
+		bindStatistics.descriptorSetsSkipped = stats.descriptorSetsSkipped;
+		bindStatistics.pushConstants         = stats.pushConstants;
+		bindStatistics.pushConstantsSkipped  = stats.pushConstantsSkipped;
+
+		if (current == nullptr)
+			return;
+
+		if (stack.size() > 1)
+			LOGW("GPU profiler : {0} scopes are still open at the end of the frame", stack.size() - 1);
+
+		while (!stack.empty())
+			end(cmd);
+
+		current->pending = true;
+		current          = nullptr;
+		commandBuffer    = VK_NULL_HANDLE;
+	}
+
+	auto VulkanGPUProfiler::begin(const CommandBuffer *cmd, const char *name) -> void
+	{
+		if (current == nullptr || static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer() != commandBuffer)
+			return;
+
+		if (current->scopes.size() >= MaxScopes)
+		{
+			stack.emplace_back(InvalidScope);
+			return;
+		}
+
+		auto  index  = static_cast<uint32_t>(current->scopes.size());
+		auto &scope  = current->scopes.emplace_back();
+		scope.name   = name;
+		scope.depth  = static_cast<uint32_t>(stack.size());
+		scope.parent = stack.empty() ? -1 : static_cast<int32_t>(stack.back());
+
+		auto vkCmd = static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer();
+		vkCmdWriteTimestamp(vkCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, current->timestamps, index * 2);
+
+		//statistics queries of one type can not be active twice, the outermost scope below the frame gets it.
+		if (current->collectStatistics && scope.depth > 0 && activeStatistics == InvalidScope)
+		{
+			scope.statistics = current->statisticsCount++;
+			activeStatistics = index;
+			vkCmdBeginQuery(vkCmd, current->statistics, scope.statistics, 0);
+		}
+		stack.emplace_back(index);
+	}
+
+	auto VulkanGPUProfiler::end(const CommandBuffer *cmd) -> void
+	{
+		if (current == nullptr || stack.empty() || static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer() != commandBuffer)
+			return;
+
+		auto index = stack.back();
+		stack.pop_back();
+		if (index == InvalidScope)
+			return;
+
+		auto vkCmd = static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer();
+		if (activeStatistics == index)
+		{
+			vkCmdEndQuery(vkCmd, current->statistics, current->scopes[index].statistics);
+			activeStatistics = InvalidScope;
+		}
+		vkCmdWriteTimestamp(vkCmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current->timestamps, index * 2 + 1);
+	}
+
+	auto VulkanGPUProfiler::resolve(FrameQueries &queries) -> void
+	{
+		PROFILE_FUNCTION();
+		queries.pending = false;
+		if (queries.scopes.empty())
+			return;
+
+		auto count = static_cast<uint32_t>(queries.scopes.size());
+		//value and availability per query, nothing waits for the GPU here.
+		results.resize(count * 4);
+		vkGetQueryPoolResults(*VulkanDevice::get(), queries.timestamps, 0, count * 2, results.size() * sizeof(uint64_t), results.data(),
+		                      sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		for (uint32_t i = 0; i < count * 2; i++)
+		{
+			if (results[i * 2 + 1] == 0)
+			{
+				droppedFrames++;
+				return;
+			}
+		}
+
+		auto toMs = [&](uint64_t begin, uint64_t end) {
+			return static_cast<double>((end - begin) & timestampMask) * timestampPeriod / 1000000.0;
+		};
+
+		auto frameBegin = results[0];
+		lastFrame.frame = queries.frame;
+		lastFrame.nodes.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto &scope        = queries.scopes[i];
+			auto &node         = lastFrame.nodes[i];
+			node.name          = scope.name;
+			node.depth         = scope.depth;
+			node.parent        = scope.parent;
+			node.begin         = toMs(frameBegin, results[i * 4]);
+			node.time          = toMs(results[i * 4], results[i * 4 + 2]);
+			node.hasStatistics = false;
+			node.statistics    = {};
+		}
+		lastFrame.time = lastFrame.nodes[0].time;
+
+		if (queries.statisticsCount > 0)
+		{
+			auto &statistics = statisticsResults;
+			statistics.resize(queries.statisticsCount * StatisticsStride);
+			vkGetQueryPoolResults(*VulkanDevice::get(), queries.statistics, 0, queries.statisticsCount, statistics.size() * sizeof(uint64_t), statistics.data(),
+			                      sizeof(uint64_t) * StatisticsStride, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				auto query = queries.scopes[i].statistics;
+				if (query == InvalidScope || statistics[query * StatisticsStride + 7] == 0)
+					continue;
+
+				//values are written in the order of the flag bits.
+				auto *values = &statistics[query * StatisticsStride];
+				auto &node   = lastFrame.nodes[i];
+
+				node.hasStatistics                        = true;
+				node.statistics.inputAssemblyVertices     = values[0];
+				node.statistics.inputAssemblyPrimitives   = values[1];
+				node.statistics.vertexShaderInvocations   = values[2];
+				node.statistics.clippingInvocations       = values[3];
+				node.statistics.clippingPrimitives        = values[4];
+				node.statistics.fragmentShaderInvocations = values[5];
+				node.statistics.computeShaderInvocations  = values[6];
+			}
+		}
+	}
+}        // namespace maple
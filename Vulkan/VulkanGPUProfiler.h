@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../GPUProfiler.h"
+#include "VulkanHelper.h"
+#include "VulkanSwapChain.h"
+#include <array>
+
+namespace maple
+{
+	class VulkanGPUProfiler final : public GPUProfiler
+	{
+	  public:
+		VulkanGPUProfiler();
+		~VulkanGPUProfiler();
+
+		auto beginFrame(const CommandBuffer *cmd) -> void override;
+		auto endFrame(const CommandBuffer *cmd) -> void override;
+		auto begin(const CommandBuffer *cmd, const char *name) -> void override;
+		auto end(const CommandBuffer *cmd) -> void override;
+
+		auto isPipelineStatisticsSupported() const -> bool override
+		{
+			return statisticsSupported;
+		}
+
+		/**
+		 * frames whose queries were not available when the pool was reused.
+		 */
+		inline auto getDroppedFrames() const
+		{
+			return droppedFrames;
+		}
+
+	  private:
+		static constexpr uint32_t InvalidScope = UINT32_MAX;
+
+		struct Scope
+		{
+			std::string name;
+			uint32_t    depth      = 0;
+			int32_t     parent     = -1;
+			uint32_t    statistics = InvalidScope;
+		};
+
+		struct FrameQueries
+		{
+			VkQueryPool        timestamps = VK_NULL_HANDLE;
+			VkQueryPool        statistics = VK_NULL_HANDLE;
+			std::vector<Scope> scopes;
+			uint32_t           statisticsCount   = 0;
+			uint64_t           frame             = 0;
+			bool               collectStatistics = false;
+			bool               pending           = false;
+		};
+
+		auto resolve(FrameQueries &queries) -> void;
+
+		std::array<FrameQueries, MAX_SWAPCHAIN_BUFFERS> frames;
+
+		FrameQueries *        current          = nullptr;
+		VkCommandBuffer       commandBuffer    = VK_NULL_HANDLE;
+		std::vector<uint32_t> stack;
+		uint32_t              activeStatistics = InvalidScope;
+
+		uint64_t frameCounter        = 0;
+		uint64_t droppedFrames       = 0;
+		uint64_t timestampMask       = UINT64_MAX;
+		double   timestampPeriod     = 0;        //ns per tick
+		bool     timestampSupported  = false;
+		bool     statisticsSupported = false;
+
+		std::vector<uint64_t> results;
+		std::vector<uint64_t> statisticsResults;
+	};
+}        // namespace maple
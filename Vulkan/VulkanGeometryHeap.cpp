@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanGeometryHeap.h"
+#include "../Console.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanContext.h"
+#include "VulkanDevice.h"
+#include "VulkanIndexBuffer.h"
+#include "VulkanVertexBuffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace maple
+{
+	namespace
+	{
+		/**
+		 * views are bound as storage buffers too, so their offsets also have to meet the storage buffer alignment.
+		 * the result stays a multiple of the stride, keeping offset / stride a valid vertexOffset or firstIndex.
+		 */
+		inline auto viewAlignment(uint64_t stride) -> uint64_t
+		{
+			uint64_t storageAlignment = VulkanDevice::get()->getPhysicalDevice()->getProperties().limits.minStorageBufferOffsetAlignment;
+			return std::lcm(std::max<uint64_t>(stride, 1), std::max<uint64_t>(storageAlignment, 1));
+		}
+	}        // namespace
+
+	VulkanGeometryHeap::VulkanGeometryHeap(uint64_t pageSize) :
+	    GeometryHeap(pageSize)
+	{
+	}
+
+	auto VulkanGeometryHeap::free(const GeometryAllocation &allocation) -> void
+	{
+		//the range may still be read by frames in flight.
+		auto self = std::static_pointer_cast<VulkanGeometryHeap>(shared_from_this());
+		VulkanContext::getDeletionQueue().emplace([self, allocation] { self->release(allocation); });
+	}
+
+	auto VulkanGeometryHeap::createVertexBuffer(const void *data, uint32_t size, uint32_t stride) -> VertexBuffer::Ptr
+	{
+		PROFILE_FUNCTION();
+		auto allocation = allocate(size, viewAlignment(stride));
+		auto &page      = pages[allocation.page];
+		auto buffer     = std::make_shared<VulkanVertexBuffer>(shared_from_this(), allocation, page->getVkBuffer(), page->getDeviceAddress());
+		if (data != nullptr)
+			buffer->setVkData(size, data);
+		return buffer;
+	}
+
+	auto VulkanGeometryHeap::createIndexBuffer(const uint16_t *data, uint32_t count) -> IndexBuffer::Ptr
+	{
+		return createIndexBuffer(data, count, VK_INDEX_TYPE_UINT16);
+	}
+
+	auto VulkanGeometryHeap::createIndexBuffer(const uint32_t *data, uint32_t count) -> IndexBuffer::Ptr
+	{
+		return createIndexBuffer(data, count, VK_INDEX_TYPE_UINT32);
+	}
+
+	auto VulkanGeometryHeap::createIndexBuffer(const void *data, uint32_t count, VkIndexType indexType) -> IndexBuffer::Ptr
+	{
+		PROFILE_FUNCTION();
+		uint32_t indexSize  = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		auto     allocation = allocate(count * indexSize, viewAlignment(indexSize));
+		auto &   page       = pages[allocation.page];
+		auto     buffer     = std::make_shared<VulkanIndexBuffer>(shared_from_this(), allocation, page->getVkBuffer(), page->getDeviceAddress(), indexType);
+		if (data != nullptr)
+			buffer->setVkData(count * indexSize, data);
+		return buffer;
+	}
+
+	auto VulkanGeometryHeap::write(const GeometryAllocation &allocation, const std::vector<BufferUpdate> &updates) -> void
+	{
+		PROFILE_FUNCTION();
+		std::vector<BufferUpdate> pageUpdates;
+		pageUpdates.reserve(updates.size());
+		for (auto &update : updates)
+		{
+			MAPLE_ASSERT(update.offset + update.size <= allocation.size, "write out of the allocation");
+			pageUpdates.push_back({update.data, update.size, static_cast<uint32_t>(allocation.offset + update.offset)});
+		}
+		pages[allocation.page]->setVkData(pageUpdates);
+	}
+
+	auto VulkanGeometryHeap::bindVertexBuffer(const CommandBuffer *cmd, uint32_t page, uint32_t binding) const -> void
+	{
+		PROFILE_FUNCTION();
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer(), binding, 1, &pages[page]->getVkBuffer(), &offset);
+	}
+
+	auto VulkanGeometryHeap::bindIndexBuffer(const CommandBuffer *cmd, uint32_t page, bool uint16Index) const -> void
+	{
+		PROFILE_FUNCTION();
+		vkCmdBindIndexBuffer(static_cast<const VulkanCommandBuffer *>(cmd)->getCommandBuffer(), pages[page]->getVkBuffer(), 0,
+		                     uint16Index ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+	}
+
+	auto VulkanGeometryHeap::getAddress(const GeometryAllocation &allocation) const -> uint64_t
+	{
+		return pages[allocation.page]->getDeviceAddress() + allocation.offset;
+	}
+
+	auto VulkanGeometryHeap::createPage(uint64_t size) -> void
+	{
+		PROFILE_FUNCTION();
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+		                           VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+		if (VulkanDevice::get()->getPhysicalDevice()->isRaytracingSupported())
+		{
+			usage |= VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+		}
+		pages.emplace_back(std::make_unique<VulkanBuffer>(usage, static_cast<uint32_t>(size), nullptr, VMA_MEMORY_USAGE_GPU_ONLY));
+	}
+
+	auto VulkanGeometryHeap::getPageHandle(uint32_t page) const -> void *
+	{
+		return pages[page]->getVkBuffer();
+	}
+}        // namespace maple
@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../GeometryHeap.h"
+#include "VulkanBuffer.h"
+#include <memory>
+#include <vector>
+
+namespace maple
+{
+	class VulkanGeometryHeap : public GeometryHeap
+	{
+	  public:
+		VulkanGeometryHeap(uint64_t pageSize);
+
+		auto free(const GeometryAllocation &allocation) -> void override;
+
+		auto createVertexBuffer(const void *data, uint32_t size, uint32_t stride) -> VertexBuffer::Ptr override;
+		auto createIndexBuffer(const uint16_t *data, uint32_t count) -> IndexBuffer::Ptr override;
+		auto createIndexBuffer(const uint32_t *data, uint32_t count) -> IndexBuffer::Ptr override;
+
+		auto write(const GeometryAllocation &allocation, const std::vector<BufferUpdate> &updates) -> void override;
+
+		auto bindVertexBuffer(const CommandBuffer *cmd, uint32_t page, uint32_t binding = 0) const -> void override;
+		auto bindIndexBuffer(const CommandBuffer *cmd, uint32_t page, bool uint16Index) const -> void override;
+		auto getAddress(const GeometryAllocation &allocation) const -> uint64_t override;
+
+		inline auto &getPageBuffer(uint32_t page) const
+		{
+			return pages[page];
+		}
+
+	  protected:
+		auto createPage(uint64_t size) -> void override;
+		auto getPageHandle(uint32_t page) const -> void * override;
+
+	  private:
+		auto createIndexBuffer(const void *data, uint32_t count, VkIndexType indexType) -> IndexBuffer::Ptr;
+
+		std::vector<std::unique_ptr<VulkanBuffer>> pages;
+	};
+}        // namespace maple
@@ -6,12 +6,14 @@
 #include "../Console.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanCommandPool.h"
+#include "VulkanCommandRecycler.h"
 #include "VulkanContext.h"
 #include "VulkanDescriptorSet.h"
 #include "VulkanDevice.h"
 #include "VulkanSwapChain.h"
 #include "VulkanTexture.h"
 
+#include <algorithm>
 #include <string>
 
 #include <GLFW/glfw3.h>
@@ -280,6 +282,9 @@ namespace maple
 
 	auto VulkanHelper::validateResolution(uint32_t &width, uint32_t &height) -> void
 	{
+		if (GraphicsContext::get()->isHeadless())
+			return;
+
 		VkSurfaceCapabilitiesKHR capabilities;
 		auto surface = std::static_pointer_cast<VulkanSwapChain>(GraphicsContext::get()->getSwapChain())->getSurface();
 		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(*VulkanDevice::get()->getPhysicalDevice(), surface, &capabilities);
@@ -288,6 +293,12 @@ namespace maple
 		height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, height));
 	}
 
+	auto VulkanHelper::getPresentLayout() -> VkImageLayout
+	{
+		//PRESENT_SRC is only valid with VK_KHR_swapchain, which a headless device does not enable.
+		return GraphicsContext::get()->isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	}
+
 	auto VulkanHelper::instanceCreateInfo(const VkApplicationInfo &appInfo, const std::vector<const char *> &extensions,
 	                                      const std::vector<const char *> &validationLayers, bool validationLayer) -> VkInstanceCreateInfo
 	{
@@ -479,10 +490,10 @@ namespace maple
 		                          VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 	}
 
-	auto VulkanHelper::setObjectName(const std::string &name, uint64_t handle, VkObjectType objType) -> void
+	auto VulkanHelper::setObjectName(const char *name, uint64_t handle, VkObjectType objType) -> void
 	{
-		if(name != "" && handle != 0) {
-			VkDebugUtilsObjectNameInfoEXT s{VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT, nullptr, objType, handle, name.c_str()};
+		if(name != nullptr && name[0] != '\0' && handle != 0) {
+			VkDebugUtilsObjectNameInfoEXT s{VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT, nullptr, objType, handle, name};
 			vkSetDebugUtilsObjectNameEXT(*VulkanDevice::get(), &s);
 		}
 	}
@@ -516,19 +527,31 @@ namespace maple
 		return availableFormats[0];
 	}
 
-	auto VulkanHelper::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, bool vsync) -> VkPresentModeKHR
+	auto VulkanHelper::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, PresentMode presentMode) -> VkPresentModeKHR
 	{
-		VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
-		if(!vsync) {
-			for(size_t i = 0; i < availablePresentModes.size(); i++) {
-				if(availablePresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
-					swapchainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
-					break;
-				}
-			/*	if(availablePresentModes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) { swapchainPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR; }*/
-			}
+		//preferred mode first, FIFO is the only one every implementation supports.
+		std::vector<VkPresentModeKHR> candidates;
+		switch (presentMode)
+		{
+			case PresentMode::FifoRelaxed:
+				candidates = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+				break;
+			case PresentMode::Mailbox:
+				candidates = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+				break;
+			case PresentMode::Immediate:
+				candidates = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+				break;
+			default:
+				break;
 		}
-		return swapchainPresentMode;
+
+		for (auto candidate : candidates)
+		{
+			if (std::find(availablePresentModes.begin(), availablePresentModes.end(), candidate) != availablePresentModes.end())
+				return candidate;
+		}
+		return VK_PRESENT_MODE_FIFO_KHR;
 	}
 
 	auto VulkanHelper::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities, uint32_t width, uint32_t height) -> VkExtent2D
@@ -643,15 +666,6 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 
-		auto commandBuffer = cmd != nullptr ? cmd->getCommandBuffer() : nullptr;
-
-		bool singleTimeCommand = false;
-
-		if(!commandBuffer) {
-			commandBuffer = beginSingleTimeCommands();
-			singleTimeCommand = true;
-		}
-
 		VkImageSubresourceRange subresourceRange = {};
 		subresourceRange.aspectMask = depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
 
@@ -679,22 +693,26 @@ namespace maple
 			imageMemoryBarrier.dstQueueFamilyIndex = VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily.value();
 		}
 
+		if(cmd != nullptr) {
+			//batched with the other barriers of this command buffer.
+			cmd->pipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, imageMemoryBarrier);
+			return;
+		}
+
+		auto commandBuffer = beginSingleTimeCommands();
 		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1,
 		                     &imageMemoryBarrier);
-
-		if(singleTimeCommand) endSingleTimeCommands(commandBuffer);
+		endSingleTimeCommands(commandBuffer);
 	}
 
 	auto VulkanHelper::beginSingleTimeCommands() -> VkCommandBuffer
 	{
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = *VulkanDevice::get()->getCommandPool();
-		allocInfo.commandBufferCount = 1;
+		//while a frame is recording, record into its upload buffer instead of submitting and waiting.
+		if (auto uploadCmd = VulkanContext::get()->getFrameUploadCommandBuffer(); uploadCmd != VK_NULL_HANDLE)
+			return uploadCmd;
 
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(*VulkanDevice::get(), &allocInfo, &commandBuffer);
+		auto commandBuffer = VulkanContext::get()->getCommandRecycler()->acquireImmediate(
+		    VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily.value());
 
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -707,22 +725,18 @@ namespace maple
 
 	auto VulkanHelper::endSingleTimeCommands(VkCommandBuffer commandBuffer) -> void
 	{
-		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+		auto recycler = VulkanContext::get()->getCommandRecycler();
+		auto swapChain = VulkanContext::get()->getSwapChain();
 
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-		submitInfo.pSignalSemaphores = nullptr;
-		submitInfo.pNext = nullptr;
-		submitInfo.pWaitDstStageMask = nullptr;
-		submitInfo.signalSemaphoreCount = 0;
-		submitInfo.waitSemaphoreCount = 0;
+		//submitted together with the frame.
+		if (swapChain != nullptr && recycler->isUploadCommandBuffer(swapChain->getCurrentBufferIndex(), commandBuffer))
+			return;
 
-		VK_CHECK_RESULT(vkQueueSubmit(VulkanDevice::get()->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
-		VK_CHECK_RESULT(vkQueueWaitIdle(VulkanDevice::get()->getGraphicsQueue()));
+		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 
-		vkFreeCommandBuffers(*VulkanDevice::get(), *VulkanDevice::get()->getCommandPool(), 1, &commandBuffer);
+		recycler->submitImmediate(
+		    VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily.value(),
+		    commandBuffer, VulkanDevice::get()->getGraphicsQueue());
 	}
 
 	auto VulkanHelper::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t depth, int32_t offsetX, int32_t offsetY,
@@ -5,6 +5,7 @@
 #pragma once
 #include "../Definitions.h"
 #include "../Shader.h"
+#include "../SwapChain.h"
 #include "../Textures.h"
 
 #include "VkCommon.h"
@@ -55,6 +56,10 @@ namespace maple
 	namespace VulkanHelper
 	{
 		auto validateResolution(uint32_t &width, uint32_t &height) -> void;
+		/**
+		 * layout of swap chain images between frames, headless images are kept ready for readback.
+		 */
+		auto getPresentLayout() -> VkImageLayout;
 		auto instanceCreateInfo(const VkApplicationInfo &appInfo, const std::vector<const char *> &extensions, const std::vector<const char *> &validationLayers, bool validationLayer) -> VkInstanceCreateInfo;
 		auto getApplicationInfo(const std::string &name) -> VkApplicationInfo;
 		auto findQueueFamilies(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) -> QueueFamilyIndices;
@@ -119,7 +124,12 @@ namespace maple
 		auto getSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) -> VkFormat;
 		auto getDepthFormat(bool stencil = false) -> VkFormat;
 
-		auto setObjectName(const std::string &name, uint64_t handle, VkObjectType objType) -> void;
+		auto setObjectName(const char *name, uint64_t handle, VkObjectType objType) -> void;
+
+		inline auto setObjectName(const std::string &name, uint64_t handle, VkObjectType objType) -> void
+		{
+			setObjectName(name.c_str(), handle, objType);
+		}
 
 		inline auto semaphoreCreateInfo()
 		{
@@ -241,7 +251,7 @@ namespace maple
 		}
 
 		auto chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &formats) -> VkSurfaceFormatKHR;
-		auto chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &presentModes, bool vsync) -> VkPresentModeKHR;
+		auto chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &presentModes, PresentMode presentMode) -> VkPresentModeKHR;
 		auto chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities,uint32_t width,uint32_t height) -> VkExtent2D;
 
 		auto transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
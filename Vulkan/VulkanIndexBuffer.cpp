@@ -6,6 +6,7 @@
 #include "VulkanCommandBuffer.h"
 #include "VulkanDevice.h"
 #include "../Console.h"
+#include <algorithm>
 
 namespace maple
 {
@@ -32,6 +33,14 @@ namespace maple
 	{
 	}
 
+	VulkanIndexBuffer::VulkanIndexBuffer(const std::shared_ptr<GeometryHeap>& heap, const GeometryAllocation& suballocation, VkBuffer page, VkDeviceAddress pageAddress, VkIndexType indexType) :
+		VulkanBuffer(heap, suballocation, page, pageAddress, VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+		size(static_cast<uint32_t>(suballocation.size)),
+		count(static_cast<uint32_t>(suballocation.size) / (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t))),
+		usage(BufferUsage::Static), indexType(indexType)
+	{
+	}
+
 	VulkanIndexBuffer::~VulkanIndexBuffer()
 	{
 		if (mappedBuffer)
@@ -45,7 +54,7 @@ namespace maple
 	auto VulkanIndexBuffer::bind(const CommandBuffer* commandBuffer) const -> void
 	{
 		PROFILE_FUNCTION();
-		vkCmdBindIndexBuffer(static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(), buffer, 0, indexType);
+		vkCmdBindIndexBuffer(static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(), buffer, baseOffset, indexType);
 	}
 
 	auto VulkanIndexBuffer::unbind() const -> void
@@ -85,8 +94,8 @@ namespace maple
 		PROFILE_FUNCTION();
 		auto         buffer = static_cast<VulkanIndexBuffer*>(to);
 		VkBufferCopy bufferCopy;
-		bufferCopy.dstOffset = copy.dstOffset;
-		bufferCopy.srcOffset = copy.srcOffset;
+		bufferCopy.dstOffset = buffer->baseOffset + copy.dstOffset;
+		bufferCopy.srcOffset = baseOffset + copy.srcOffset;
 		bufferCopy.size = copy.size;
 		vkCmdCopyBuffer(static_cast<VulkanCommandBuffer*>(cmd)->getCommandBuffer(), getVkBuffer(), buffer->getVkBuffer(), 1, &bufferCopy);
 	}
@@ -94,27 +103,42 @@ namespace maple
 	auto VulkanIndexBuffer::setData(const uint16_t* data, uint32_t count) -> void
 	{
 		PROFILE_FUNCTION();
-		if (count > this->count)
-		{
-			resize(count * sizeof(uint16_t), data);
-		}
-		else
-		{
-			setData(count * sizeof(uint16_t), data);
-		}
+		//only reallocates when the capacity is exceeded, shrinking keeps the allocation.
+		grow(count * sizeof(uint16_t), false, isGeometric());
+		setData(count * sizeof(uint16_t), data);
+		this->size  = count * sizeof(uint16_t);
 		this->count = count;
 	}
 
 	auto VulkanIndexBuffer::setData(const uint32_t* data, uint32_t count) -> void
 	{
-		if (count > this->count) 
-		{
-			resize(count * sizeof(uint32_t), data);
-		}
-		else 
+		PROFILE_FUNCTION();
+		grow(count * sizeof(uint32_t), false, isGeometric());
+		setData(count * sizeof(uint32_t), data);
+		this->size  = count * sizeof(uint32_t);
+		this->count = count;
+	}
+
+	auto VulkanIndexBuffer::setDataSub(uint32_t size, const void* data, uint32_t offset) -> void
+	{
+		PROFILE_FUNCTION();
+		grow(offset + size, true, isGeometric());
+		setVkData(size, data, offset);
+		this->size  = std::max(this->size, offset + size);
+		this->count = std::max(count, this->size / getIndexSize());
+	}
+
+	auto VulkanIndexBuffer::setDataSub(const std::vector<BufferUpdate>& updates) -> void
+	{
+		PROFILE_FUNCTION();
+		uint32_t end = 0;
+		for (auto& update : updates)
 		{
-			setData(count * sizeof(uint32_t), data);
+			end = std::max(end, update.offset + update.size);
 		}
-		this->count = count;
+		grow(end, true, isGeometric());
+		setVkData(updates);
+		this->size  = std::max(this->size, end);
+		this->count = std::max(count, this->size / getIndexSize());
 	}
 };        // namespace maple
@@ -21,6 +21,7 @@ namespace maple
 	  public:
 		VulkanIndexBuffer(const uint16_t *data, uint32_t count, BufferUsage bufferUsage, bool gpuOnly = false);
 		VulkanIndexBuffer(const uint32_t *data, uint32_t count, BufferUsage bufferUsage, bool gpuOnly = false);
+		VulkanIndexBuffer(const std::shared_ptr<GeometryHeap> &heap, const GeometryAllocation &suballocation, VkBuffer page, VkDeviceAddress pageAddress, VkIndexType indexType);
 		~VulkanIndexBuffer();
 
 		auto bind(const CommandBuffer *commandBuffer) const -> void override;
@@ -32,6 +33,10 @@ namespace maple
 
 		auto setData(const uint32_t* data, uint32_t count) -> void override;
 
+		auto setDataSub(uint32_t size, const void *data, uint32_t offset) -> void override;
+
+		auto setDataSub(const std::vector<BufferUpdate> &updates) -> void override;
+
 		auto copy(CommandBuffer *cmd, GPUBuffer *to, const BufferCopy &copy) const -> void override;
 
 		auto getPointerInternal() -> void * override;
@@ -41,6 +46,11 @@ namespace maple
 			return size;
 		}
 
+		inline auto getCapacity() const -> uint64_t override
+		{
+			return VulkanBuffer::size;
+		}
+
 		inline auto setCount(uint32_t indexCount) -> void
 		{
 			count = indexCount;
@@ -59,7 +69,27 @@ namespace maple
 			return getVkBuffer();
 		};
 
+		inline auto getOffset() const -> uint64_t override
+		{
+			return baseOffset;
+		}
+
+		inline auto getRange() const -> uint64_t override
+		{
+			return heap != nullptr ? VulkanBuffer::size : 0;
+		}
+
 	  private:
+		inline auto isGeometric() const
+		{
+			return usage != BufferUsage::Static;
+		}
+
+		inline auto getIndexSize() const -> uint32_t
+		{
+			return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+
 		uint32_t    count = 0;
 		uint32_t    size  = 0;
 		BufferUsage usage;
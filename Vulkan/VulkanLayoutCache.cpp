@@ -0,0 +1,233 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanLayoutCache.h"
+#include "../Console.h"
+#include "../HashCode.h"
+#include <algorithm>
+
+namespace maple
+{
+	VulkanLayoutCache::VulkanLayoutCache(VkDevice device) :
+	    device(device)
+	{
+	}
+
+	VulkanLayoutCache::~VulkanLayoutCache()
+	{
+		if (!pipelineLayouts.empty() || !setLayouts.empty())
+			LOGW("{0} pipeline layouts and {1} descriptor set layouts are still referenced", pipelineLayouts.size(), setLayouts.size());
+
+		for (auto &[key, entry] : pipelineLayouts)
+			vkDestroyPipelineLayout(device, entry.handle, VK_NULL_HANDLE);
+
+		for (auto &[key, entry] : setLayouts)
+			vkDestroyDescriptorSetLayout(device, entry.handle, VK_NULL_HANDLE);
+	}
+
+	auto VulkanLayoutCache::acquireDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings, const std::vector<VkDescriptorBindingFlags> &flags) -> VkDescriptorSetLayout
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(flags.empty() || flags.size() == bindings.size(), "one flag per binding");
+
+		SetLayoutKey key;
+		key.bindings.reserve(bindings.size());
+		for (size_t i = 0; i < bindings.size(); i++)
+		{
+			auto &binding = bindings[i];
+			key.bindings.push_back({binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags, flags.empty() ? 0 : flags[i]});
+		}
+		//the order of bindings does not change the layout.
+		std::sort(key.bindings.begin(), key.bindings.end(), [](const auto &left, const auto &right) {
+			return left.binding < right.binding;
+		});
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (auto iter = setLayouts.find(key); iter != setLayouts.end())
+		{
+			iter->second.references++;
+			hits++;
+			return iter->second.handle;
+		}
+
+		std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
+		std::vector<VkDescriptorBindingFlags>     layoutBindingFlags;
+		setLayoutBindings.reserve(key.bindings.size());
+		layoutBindingFlags.reserve(key.bindings.size());
+
+		for (auto &binding : key.bindings)
+		{
+			VkDescriptorSetLayoutBinding setLayoutBinding{};
+			setLayoutBinding.binding         = binding.binding;
+			setLayoutBinding.descriptorType  = binding.type;
+			setLayoutBinding.descriptorCount = binding.count;
+			setLayoutBinding.stageFlags      = binding.stages;
+			setLayoutBindings.emplace_back(setLayoutBinding);
+			layoutBindingFlags.emplace_back(binding.flags);
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {};
+		flagsInfo.sType                                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		flagsInfo.pNext                                       = nullptr;
+		flagsInfo.bindingCount                                = static_cast<uint32_t>(layoutBindingFlags.size());
+		flagsInfo.pBindingFlags                               = layoutBindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+		setLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
+		setLayoutCreateInfo.pBindings    = setLayoutBindings.data();
+		setLayoutCreateInfo.pNext        = &flagsInfo;
+
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, VK_NULL_HANDLE, &layout));
+
+		setLayoutKeys.emplace(layout, key);
+		setLayouts.emplace(std::move(key), Entry<VkDescriptorSetLayout>{layout, 1});
+		return layout;
+	}
+
+	auto VulkanLayoutCache::releaseDescriptorSetLayout(VkDescriptorSetLayout layout) -> void
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dereference(layout);
+	}
+
+	auto VulkanLayoutCache::acquirePipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts, const std::vector<VkPushConstantRange> &pushConstantRanges) -> VkPipelineLayout
+	{
+		PROFILE_FUNCTION();
+		PipelineLayoutKey key{setLayouts, pushConstantRanges};
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (auto iter = pipelineLayouts.find(key); iter != pipelineLayouts.end())
+		{
+			iter->second.references++;
+			hits++;
+			return iter->second.handle;
+		}
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+		pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount         = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutCreateInfo.pSetLayouts            = setLayouts.data();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		pipelineLayoutCreateInfo.pPushConstantRanges    = pushConstantRanges.data();
+
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &layout));
+
+		//the set layouts have to outlive the key which refers to them.
+		for (auto setLayout : setLayouts)
+		{
+			if (auto iter = setLayoutKeys.find(setLayout); iter != setLayoutKeys.end())
+				this->setLayouts[iter->second].references++;
+		}
+
+		pipelineLayoutKeys.emplace(layout, key);
+		pipelineLayouts.emplace(std::move(key), Entry<VkPipelineLayout>{layout, 1});
+		return layout;
+	}
+
+	auto VulkanLayoutCache::releasePipelineLayout(VkPipelineLayout layout) -> void
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto                        keyIter = pipelineLayoutKeys.find(layout);
+		if (keyIter == pipelineLayoutKeys.end())
+		{
+			LOGW("release of a pipeline layout which is not cached");
+			return;
+		}
+
+		auto iter = pipelineLayouts.find(keyIter->second);
+		if (--iter->second.references > 0)
+			return;
+
+		vkDestroyPipelineLayout(device, layout, VK_NULL_HANDLE);
+		for (auto setLayout : keyIter->second.setLayouts)
+			dereference(setLayout);
+
+		pipelineLayouts.erase(iter);
+		pipelineLayoutKeys.erase(keyIter);
+	}
+
+	auto VulkanLayoutCache::getCompatibleSetCount(VkPipelineLayout from, VkPipelineLayout to) -> uint32_t
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto                        fromIter = pipelineLayoutKeys.find(from);
+		auto                        toIter   = pipelineLayoutKeys.find(to);
+		if (fromIter == pipelineLayoutKeys.end() || toIter == pipelineLayoutKeys.end())
+			return 0;
+
+		auto &fromKey = fromIter->second;
+		auto &toKey   = toIter->second;
+		if (!fromKey.isPushConstantCompatible(toKey))
+			return 0;
+
+		uint32_t count = 0;
+		while (count < fromKey.setLayouts.size() && count < toKey.setLayouts.size() && fromKey.setLayouts[count] == toKey.setLayouts[count])
+			count++;
+		return count;
+	}
+
+	auto VulkanLayoutCache::isPushConstantCompatible(VkPipelineLayout from, VkPipelineLayout to) -> bool
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto                        fromIter = pipelineLayoutKeys.find(from);
+		auto                        toIter   = pipelineLayoutKeys.find(to);
+		return fromIter != pipelineLayoutKeys.end() && toIter != pipelineLayoutKeys.end() && fromIter->second.isPushConstantCompatible(toIter->second);
+	}
+
+	auto VulkanLayoutCache::dereference(VkDescriptorSetLayout layout) -> void
+	{
+		auto keyIter = setLayoutKeys.find(layout);
+		if (keyIter == setLayoutKeys.end())
+		{
+			LOGW("release of a descriptor set layout which is not cached");
+			return;
+		}
+
+		auto iter = setLayouts.find(keyIter->second);
+		if (--iter->second.references > 0)
+			return;
+
+		vkDestroyDescriptorSetLayout(device, layout, VK_NULL_HANDLE);
+		setLayouts.erase(iter);
+		setLayoutKeys.erase(keyIter);
+	}
+
+	auto VulkanLayoutCache::PipelineLayoutKey::operator==(const PipelineLayoutKey &other) const -> bool
+	{
+		return setLayouts == other.setLayouts && isPushConstantCompatible(other);
+	}
+
+	auto VulkanLayoutCache::PipelineLayoutKey::isPushConstantCompatible(const PipelineLayoutKey &other) const -> bool
+	{
+		return std::equal(pushConstantRanges.begin(), pushConstantRanges.end(), other.pushConstantRanges.begin(), other.pushConstantRanges.end(),
+		                  [](const VkPushConstantRange &left, const VkPushConstantRange &right) {
+			                  return left.stageFlags == right.stageFlags && left.offset == right.offset && left.size == right.size;
+		                  });
+	}
+
+	auto VulkanLayoutCache::KeyHash::operator()(const SetLayoutKey &key) const -> std::size_t
+	{
+		std::size_t seed = key.bindings.size();
+		for (auto &binding : key.bindings)
+		{
+			hash::hashCode(seed, binding.binding, static_cast<uint32_t>(binding.type), binding.count, static_cast<uint32_t>(binding.stages), static_cast<uint32_t>(binding.flags));
+		}
+		return seed;
+	}
+
+	auto VulkanLayoutCache::KeyHash::operator()(const PipelineLayoutKey &key) const -> std::size_t
+	{
+		std::size_t seed = key.setLayouts.size();
+		for (auto setLayout : key.setLayouts)
+		{
+			hash::hashCode(seed, setLayout);
+		}
+		for (auto &range : key.pushConstantRanges)
+		{
+			hash::hashCode(seed, static_cast<uint32_t>(range.stageFlags), range.offset, range.size);
+		}
+		return seed;
+	}
+}        // namespace maple
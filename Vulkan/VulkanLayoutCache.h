@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "VulkanHelper.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * device wide, reference counted descriptor set layouts and pipeline layouts.
+	 *
+	 * identical descriptions share one handle, so shaders with the same per-frame or per-material
+	 * sets end up with compatible pipeline layouts and those sets stay bound across pipeline switches.
+	 * every acquire has to be paired with a release, the handle is destroyed with the last reference.
+	 */
+	class VulkanLayoutCache final
+	{
+	  public:
+		VulkanLayoutCache(VkDevice device);
+		~VulkanLayoutCache();
+
+		/**
+		 * flags has one entry per binding, or is empty if no binding has flags.
+		 */
+		auto acquireDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings, const std::vector<VkDescriptorBindingFlags> &flags) -> VkDescriptorSetLayout;
+		auto releaseDescriptorSetLayout(VkDescriptorSetLayout layout) -> void;
+
+		/**
+		 * the pipeline layout holds a reference to each of its set layouts.
+		 */
+		auto acquirePipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts, const std::vector<VkPushConstantRange> &pushConstantRanges) -> VkPipelineLayout;
+		auto releasePipelineLayout(VkPipelineLayout layout) -> void;
+
+		/**
+		 * number of leading sets which stay bound when switching from one layout to the other,
+		 * 0 unless both have the same push constant ranges. layouts which are not cached share nothing.
+		 */
+		auto getCompatibleSetCount(VkPipelineLayout from, VkPipelineLayout to) -> uint32_t;
+
+		/**
+		 * push constants stay valid across layouts with identical push constant ranges.
+		 */
+		auto isPushConstantCompatible(VkPipelineLayout from, VkPipelineLayout to) -> bool;
+
+		inline auto getDescriptorSetLayoutCount() const
+		{
+			return setLayouts.size();
+		}
+
+		inline auto getPipelineLayoutCount() const
+		{
+			return pipelineLayouts.size();
+		}
+
+		/**
+		 * acquires which were served by an existing handle.
+		 */
+		inline auto getHits() const
+		{
+			return hits;
+		}
+
+	  private:
+		struct SetLayoutBinding
+		{
+			uint32_t                 binding;
+			VkDescriptorType         type;
+			uint32_t                 count;
+			VkShaderStageFlags       stages;
+			VkDescriptorBindingFlags flags;
+
+			inline auto operator==(const SetLayoutBinding &other) const
+			{
+				return binding == other.binding && type == other.type && count == other.count && stages == other.stages && flags == other.flags;
+			}
+		};
+
+		struct SetLayoutKey
+		{
+			std::vector<SetLayoutBinding> bindings;        //sorted by binding
+
+			inline auto operator==(const SetLayoutKey &other) const
+			{
+				return bindings == other.bindings;
+			}
+		};
+
+		struct PipelineLayoutKey
+		{
+			std::vector<VkDescriptorSetLayout> setLayouts;
+			std::vector<VkPushConstantRange>   pushConstantRanges;
+
+			auto operator==(const PipelineLayoutKey &other) const -> bool;
+			auto isPushConstantCompatible(const PipelineLayoutKey &other) const -> bool;
+		};
+
+		struct KeyHash
+		{
+			auto operator()(const SetLayoutKey &key) const -> std::size_t;
+			auto operator()(const PipelineLayoutKey &key) const -> std::size_t;
+		};
+
+		template <typename Handle>
+		struct Entry
+		{
+			Handle   handle;
+			uint32_t references;
+		};
+
+		//callers hold the mutex.
+		auto dereference(VkDescriptorSetLayout layout) -> void;
+
+		VkDevice   device;
+		std::mutex mutex;
+		uint64_t   hits = 0;
+
+		std::unordered_map<SetLayoutKey, Entry<VkDescriptorSetLayout>, KeyHash>  setLayouts;
+		std::unordered_map<VkDescriptorSetLayout, SetLayoutKey>                  setLayoutKeys;
+		std::unordered_map<PipelineLayoutKey, Entry<VkPipelineLayout>, KeyHash> pipelineLayouts;
+		std::unordered_map<VkPipelineLayout, PipelineLayoutKey>                  pipelineLayoutKeys;
+	};
+}        // namespace maple
@@ -203,8 +203,7 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		auto &deletionQueue = VulkanContext::getDeletionQueue();
-		auto pipeline = this->pipeline;
-		deletionQueue.emplace([pipeline] { vkDestroyPipeline(*VulkanDevice::get(), pipeline, VK_NULL_HANDLE); });
+		deletionQueue.destroy(DeletionType::Pipeline, pipeline);
 	}
 
 	auto VulkanPipeline::init(const PipelineInfo &info) -> bool
@@ -359,7 +358,7 @@ namespace maple
 			cmdBuffer->updateViewport(getWidth() * mipScale, getHeight() * mipScale);
 		}
 
-		vkCmdBindPipeline(static_cast<const VulkanCommandBuffer *>(cmdBuffer)->getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		static_cast<const VulkanCommandBuffer *>(cmdBuffer)->bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 		return framebuffer;
 	}
 
@@ -385,7 +384,7 @@ namespace maple
 		else
 			cmdBuffer->updateViewport(getWidth(), getHeight());
 
-		vkCmdBindPipeline(static_cast<const VulkanCommandBuffer *>(cmdBuffer)->getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		static_cast<const VulkanCommandBuffer *>(cmdBuffer)->bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 		return framebuffer;
 	}
 
@@ -442,6 +441,22 @@ namespace maple
 		vkCmdDrawIndexedIndirect(vkCmd->getCommandBuffer(), vkBuffer->getHandle(), offset, drawCount, stride);
 	}
 
+	auto VulkanPipeline::drawIndexedIndirectCount(const CommandBuffer *cmdBuffer, const StorageBuffer *ssbo, const StorageBuffer *countBuffer, uint32_t maxDrawCount,
+	                                              uint32_t stride, uint64_t offset, uint64_t countOffset) -> void
+	{
+		PROFILE_FUNCTION();
+		auto vkCmd    = static_cast<const VulkanCommandBuffer *>(cmdBuffer);
+		auto vkBuffer = static_cast<const VulkanStorageBuffer *>(ssbo);
+		if (!VulkanDevice::get()->getPhysicalDevice()->isDrawIndirectCountSupported())
+		{
+			//every slot is drawn, the producer has to zero the instance count of unused ones.
+			vkCmdDrawIndexedIndirect(vkCmd->getCommandBuffer(), vkBuffer->getHandle(), offset, maxDrawCount, stride);
+			return;
+		}
+		auto vkCount = static_cast<const VulkanStorageBuffer *>(countBuffer);
+		vkCmdDrawIndexedIndirectCount(vkCmd->getCommandBuffer(), vkBuffer->getHandle(), offset, vkCount->getHandle(), countOffset, maxDrawCount, stride);
+	}
+
 	auto VulkanPipeline::drawIndexed(const CommandBuffer *cmdBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
 	                                 uint32_t firstInstance) -> void
 	{
@@ -454,7 +469,6 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		auto vkCmd = static_cast<const VulkanCommandBuffer *>(commandBuffer);
-		std::vector<VkBufferMemoryBarrier> bufferBarriers;
 		for(auto &ssbo : buffers) {
 			auto vkBuffer = static_cast<VulkanStorageBuffer *>(ssbo.get());
 			VkBufferMemoryBarrier memoryBarrier{};
@@ -473,11 +487,8 @@ namespace maple
 
 			vkBuffer->setAccessFlagBits(dstAccessFlags);
 
-			bufferBarriers.emplace_back(memoryBarrier);
+			vkCmd->pipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, memoryBarrier);
 		}
-		// TODO...................
-		vkCmdPipelineBarrier(vkCmd->getCommandBuffer(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, 0,
-		                     bufferBarriers.size(), bufferBarriers.data(), 0, 0);
 	}
 
 	auto VulkanPipeline::transitionAttachments() -> void
@@ -493,7 +504,7 @@ namespace maple
 		if(description.swapChainTarget) {
 			for(uint32_t i = 0; i < GraphicsContext::get()->getSwapChain()->getSwapChainBufferCount(); i++) {
 				((VulkanTexture2D *)GraphicsContext::get()->getSwapChain()->getImage(i).get())
-				    ->transitionImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, commandBuffer);
+				    ->transitionImage(VulkanHelper::getPresentLayout(), commandBuffer);
 			}
 		}
 
@@ -52,6 +52,7 @@ namespace maple
 		auto dispatchIndirect(const CommandBuffer *cmdBuffer, const StorageBuffer *ssbo, uint64_t offset = 0) -> void override;
 
 		auto drawIndexedIndirect(const CommandBuffer *cmdBuffer, const StorageBuffer *ssbo, uint32_t drawCount, uint32_t stride = 0, uint64_t offset = 0) -> void override;
+		auto drawIndexedIndirectCount(const CommandBuffer *cmdBuffer, const StorageBuffer *ssbo, const StorageBuffer *countBuffer, uint32_t maxDrawCount, uint32_t stride = 0, uint64_t offset = 0, uint64_t countOffset = 0) -> void override;
 
 		auto drawIndexed(const CommandBuffer *cmdBuffer,
 		                 uint32_t             indexCount,
@@ -188,6 +188,27 @@ namespace maple
 			offset, count, stride);
 	}
 
+	auto VulkanRenderDevice::drawIndexedIndirectCount(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, const StorageBuffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride) -> void
+	{
+		PROFILE_FUNCTION();
+		if (!isDrawIndirectCountSupported())
+		{
+			drawIndexedIndirect(commandBuffer, indirectBuffer, offset, maxDrawCount, stride);
+			return;
+		}
+		vkCmdDrawIndexedIndirectCount(
+			static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
+			static_cast<const VulkanStorageBuffer*>(indirectBuffer)->getHandle(),
+			offset,
+			static_cast<const VulkanStorageBuffer*>(countBuffer)->getHandle(),
+			countOffset, maxDrawCount, stride);
+	}
+
+	auto VulkanRenderDevice::isDrawIndirectCountSupported() const -> bool
+	{
+		return VulkanDevice::get()->getPhysicalDevice()->isDrawIndirectCountSupported();
+	}
+
 	auto VulkanRenderDevice::drawIndirect(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, uint32_t count, uint32_t stride) -> void
 	{
 		PROFILE_FUNCTION();
@@ -206,26 +227,22 @@ namespace maple
 	auto VulkanRenderDevice::bindDescriptorSets(Pipeline* pipeline, const CommandBuffer* commandBuffer, const std::vector<std::shared_ptr<DescriptorSet>>& descriptorSets) -> void
 	{
 		PROFILE_FUNCTION();
-		uint32_t numDynamicDescriptorSets = 0;
 		uint32_t numDesciptorSets = 0;
-		std::vector<uint32_t> offsets;
 		for (auto& descriptorSet : descriptorSets)
 		{
 			if (descriptorSet)
 			{
 				auto vkDesSet = std::static_pointer_cast<VulkanDescriptorSet>(descriptorSet);
-				if (vkDesSet->isDynamic()) {
-					offsets.emplace_back(vkDesSet->getDynamicOffset());
-				}
 				descriptorSetPool[numDesciptorSets] = vkDesSet->getDescriptorSet();
+				dynamicOffsetPool[numDesciptorSets] = vkDesSet->isDynamic() ? vkDesSet->getDynamicOffset() : VulkanCommandBuffer::NoDynamicOffset;
 				numDesciptorSets++;
 			}
 		}
 
-		vkCmdBindDescriptorSets(
-			static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
+		//sets which are still bound are skipped by the command buffer.
+		static_cast<const VulkanCommandBuffer*>(commandBuffer)->bindDescriptorSets(
 			static_cast<const VulkanPipeline*>(pipeline)->getPipelineBindPoint(),
-			static_cast<const VulkanPipeline*>(pipeline)->getPipelineLayout(), 0, numDesciptorSets, descriptorSetPool, offsets.size(), offsets.data());
+			static_cast<const VulkanPipeline*>(pipeline)->getPipelineLayout(), 0, numDesciptorSets, descriptorSetPool, dynamicOffsetPool);
 	}
 
 	auto VulkanRenderDevice::bindDescriptorSet(Pipeline* pipeline, const CommandBuffer* commandBuffer, int32_t index, const std::shared_ptr<DescriptorSet>& descriptorSet) -> void
@@ -233,10 +250,9 @@ namespace maple
 		PROFILE_FUNCTION();
 		auto vkDesSet = std::static_pointer_cast<VulkanDescriptorSet>(descriptorSet);
 		auto set = vkDesSet->getDescriptorSet();
-		vkCmdBindDescriptorSets(
-			static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
+		static_cast<const VulkanCommandBuffer*>(commandBuffer)->bindDescriptorSets(
 			static_cast<const VulkanPipeline*>(pipeline)->getPipelineBindPoint(),
-			static_cast<const VulkanPipeline*>(pipeline)->getPipelineLayout(), index, 1, &set, 0, 0);
+			static_cast<const VulkanPipeline*>(pipeline)->getPipelineLayout(), index, 1, &set, nullptr);
 	}
 
 	auto VulkanRenderDevice::clearRenderTarget(const std::shared_ptr<Texture>& texture, const CommandBuffer* commandBuffer,const vec4& clearColor) -> void
@@ -354,23 +370,14 @@ namespace maple
 		memoryBarrier.srcAccessMask = toAccessFlag(from, srcStageMask);
 		memoryBarrier.dstAccessMask = toAccessFlag(to, dstStageMask);
 
-		vkCmdPipelineBarrier(
-			static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
-			srcStageMask,
-			dstStageMask,
-			0,
-			1,
-			&memoryBarrier,
-			0,
-			0,
-			0,
-			0);
+		static_cast<const VulkanCommandBuffer*>(commandBuffer)->pipelineBarrier(srcStageMask, dstStageMask, memoryBarrier);
 	}
 
 	auto VulkanRenderDevice::bufferMemoryBarrier(const CommandBuffer* commandBuffer, ShaderType fromStage, ShaderType toStage, const std::vector<BufferBarrier>& barries) const -> void
 	{
-		std::vector<VkBufferMemoryBarrier> bufferBarriers;
-		VkPipelineStageFlags               srcStageMask = getStageFlags(fromStage);
+		PROFILE_FUNCTION();
+		auto                 vkCmd        = static_cast<const VulkanCommandBuffer*>(commandBuffer);
+		VkPipelineStageFlags srcStageMask = getStageFlags(fromStage);
 		VkPipelineStageFlags               dstStageMask = getStageFlags(toStage);
 		for (auto& barrier : barries)
 		{
@@ -382,12 +389,8 @@ namespace maple
 			memoryBarrier.buffer = (VkBuffer)barrier.ssbo->handle();
 			memoryBarrier.srcQueueFamilyIndex = *VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily;
 			memoryBarrier.dstQueueFamilyIndex = *VulkanDevice::get()->getPhysicalDevice()->getQueueFamilyIndices().graphicsFamily;
-			bufferBarriers.push_back(memoryBarrier);
+			vkCmd->pipelineBarrier(srcStageMask, dstStageMask, memoryBarrier);
 		}
-
-		vkCmdPipelineBarrier(
-			static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
-			srcStageMask, dstStageMask, 0, 0, 0, bufferBarriers.size(), bufferBarriers.data(), 0, 0);
 	}
 
 	auto VulkanRenderDevice::copyBuffer(const CommandBuffer* commandBuffer,
@@ -420,17 +423,10 @@ namespace maple
 			memoryBarrier.buffer = vkTo->getHandle();
 			bufferBarriers.emplace_back(memoryBarrier);
 
-			vkCmdPipelineBarrier(
-				vkCmd->getCommandBuffer(),
-				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-				0,
-				0,
-				0,
-				bufferBarriers.size(),
-				bufferBarriers.data(),
-				0,
-				0);
+			for (auto& bufferBarrier : bufferBarriers)
+			{
+				vkCmd->pipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, bufferBarrier);
+			}
 		}
 
 		VkBufferCopy bufferCopy;
@@ -505,19 +501,9 @@ namespace maple
 			}
 		}
 
-		if (!vkBarrier.empty())
+		for (auto& barrier : vkBarrier)
 		{
-			vkCmdPipelineBarrier(
-				static_cast<const VulkanCommandBuffer*>(commandBuffer)->getCommandBuffer(),
-				srcStageMask,
-				dstStageMask,
-				0,
-				0,
-				0,
-				0,
-				0,
-				vkBarrier.size(),
-				vkBarrier.data());
+			static_cast<const VulkanCommandBuffer*>(commandBuffer)->pipelineBarrier(srcStageMask, dstStageMask, barrier);
 		}
 	}
 }        // namespace maple
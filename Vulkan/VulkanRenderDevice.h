@@ -31,6 +31,8 @@ namespace maple
 		auto drawArraysInternal(const CommandBuffer* commandBuffer, DrawType type, uint32_t count, uint32_t start = 0) const -> void override;
 		auto drawInstanced(const CommandBuffer* commandBuffer, uint32_t verticesCount, uint32_t instanceCount, int32_t startInstance, int32_t startVertex) const -> void override;
 		auto drawIndexedIndirect(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, uint32_t count, uint32_t stride) -> void override;
+		auto drawIndexedIndirectCount(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, const StorageBuffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride) -> void override;
+		auto isDrawIndirectCountSupported() const -> bool override;
 		auto drawIndirect(const CommandBuffer* commandBuffer, const StorageBuffer* indirectBuffer, uint64_t offset, uint32_t count, uint32_t stride) -> void override;
 
 		auto bindDescriptorSets(Pipeline* pipeline, const CommandBuffer* commandBuffer, const std::vector<std::shared_ptr<DescriptorSet>>& descriptorSets) -> void override;
@@ -64,6 +66,7 @@ namespace maple
 		uint32_t         currentSemaphoreIndex = 0;
 		//VkDescriptorPool descriptorPool;
 		VkDescriptorSet  descriptorSetPool[16] = {};
+		uint32_t         dynamicOffsetPool[16] = {};
 
 		DescriptorPool::Ptr descriptorPool;
 	};
@@ -0,0 +1,294 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanRenderGraph.h"
+#include "../GPUProfiler.h"
+#include "../Sampler.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanContext.h"
+#include "VulkanDebug.h"
+#include "VulkanDevice.h"
+#include "VulkanTexture.h"
+
+namespace maple
+{
+	namespace
+	{
+		constexpr VkImageUsageFlags TRANSIENT_USAGE = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+		                                              VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+		inline auto imageCreateInfo(const RenderGraphTextureDesc &desc)
+		{
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+			imageInfo.extent        = {desc.width, desc.height, 1};
+			imageInfo.mipLevels     = 1;
+			imageInfo.arrayLayers   = 1;
+			imageInfo.format        = VkConverter::textureFormatToVK(desc.format);
+			imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage         = TRANSIENT_USAGE;
+			imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+			return imageInfo;
+		}
+
+		inline auto toVkLayout(RenderGraphAccess access)
+		{
+			switch (access)
+			{
+				case RenderGraphAccess::ColorAttachment:
+					return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+				case RenderGraphAccess::DepthAttachment:
+					return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+				case RenderGraphAccess::ShaderRead:
+					return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				case RenderGraphAccess::StorageRead:
+				case RenderGraphAccess::StorageWrite:
+					return VK_IMAGE_LAYOUT_GENERAL;
+				case RenderGraphAccess::TransferSrc:
+					return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				case RenderGraphAccess::TransferDst:
+					return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				case RenderGraphAccess::Present:
+					return VulkanHelper::getPresentLayout();
+				default:
+					return VK_IMAGE_LAYOUT_UNDEFINED;
+			}
+		}
+
+		inline auto toVkAccess(RenderGraphAccess access) -> VkAccessFlags
+		{
+			switch (access)
+			{
+				case RenderGraphAccess::ColorAttachment:
+					return VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				case RenderGraphAccess::DepthAttachment:
+					return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+				case RenderGraphAccess::ShaderRead:
+				case RenderGraphAccess::StorageRead:
+					return VK_ACCESS_SHADER_READ_BIT;
+				case RenderGraphAccess::StorageWrite:
+					return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+				case RenderGraphAccess::TransferSrc:
+					return VK_ACCESS_TRANSFER_READ_BIT;
+				case RenderGraphAccess::TransferDst:
+					return VK_ACCESS_TRANSFER_WRITE_BIT;
+				default:
+					return 0;
+			}
+		}
+
+		inline auto toVkStage(RenderGraphAccess access, bool src) -> VkPipelineStageFlags
+		{
+			switch (access)
+			{
+				case RenderGraphAccess::ColorAttachment:
+					return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				case RenderGraphAccess::DepthAttachment:
+					return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+				case RenderGraphAccess::ShaderRead:
+				case RenderGraphAccess::StorageRead:
+				case RenderGraphAccess::StorageWrite:
+					return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+				case RenderGraphAccess::TransferSrc:
+				case RenderGraphAccess::TransferDst:
+					return VK_PIPELINE_STAGE_TRANSFER_BIT;
+				default:
+					return src ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			}
+		}
+	}        // namespace
+
+	VulkanRenderGraph::~VulkanRenderGraph()
+	{
+		for (auto &heap : heaps)
+		{
+			releaseHeap(heap);
+		}
+	}
+
+	auto VulkanRenderGraph::getFrameHeap() -> FrameHeap &
+	{
+		return heaps[VulkanContext::get()->getSwapChain()->getCurrentBufferIndex()];
+	}
+
+	auto VulkanRenderGraph::releaseHeap(FrameHeap &heap) -> void
+	{
+		auto &deletionQueue = VulkanContext::getDeletionQueue();
+		for (auto &placed : heap.textures)
+		{
+			//placed images own no allocation, the heap memory goes below.
+			deletionQueue.destroy(DeletionType::ImageView, placed.imageView);
+			deletionQueue.destroy(DeletionType::Image, placed.image);
+		}
+		heap.textures.clear();
+
+#ifdef USE_VMA_ALLOCATOR
+		if (heap.allocation != VK_NULL_HANDLE)
+		{
+			deletionQueue.destroy(DeletionType::Allocation, VK_NULL_HANDLE, heap.allocation);
+			heap.allocation = VK_NULL_HANDLE;
+		}
+#else
+		if (heap.memory != VK_NULL_HANDLE)
+		{
+			deletionQueue.destroy(DeletionType::Memory, heap.memory);
+			heap.memory = VK_NULL_HANDLE;
+		}
+#endif
+		heap.size = 0;
+	}
+
+	auto VulkanRenderGraph::getMemoryRequirements(const RenderGraphTextureDesc &desc) -> RenderGraphMemoryRequirements
+	{
+		PROFILE_FUNCTION();
+		for (auto &[cachedDesc, requirements] : requirementsCache)
+		{
+			if (cachedDesc == desc)
+				return requirements;
+		}
+
+		auto imageInfo = imageCreateInfo(desc);
+		VkImage image  = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreateImage(*VulkanDevice::get(), &imageInfo, nullptr, &image));
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(*VulkanDevice::get(), image, &memRequirements);
+		vkDestroyImage(*VulkanDevice::get(), image, nullptr);
+
+		RenderGraphMemoryRequirements requirements;
+		requirements.size           = memRequirements.size;
+		requirements.alignment      = memRequirements.alignment;
+		requirements.memoryTypeBits = memRequirements.memoryTypeBits;
+		maxAlignment                = std::max<uint64_t>(maxAlignment, memRequirements.alignment);
+		requirementsCache.emplace_back(desc, requirements);
+		return requirements;
+	}
+
+	auto VulkanRenderGraph::allocateHeap(uint64_t size, uint32_t memoryTypeBits) -> void
+	{
+		PROFILE_FUNCTION();
+		auto &heap = getFrameHeap();
+		if (heap.size >= size && (heap.memoryTypeBits & memoryTypeBits) != 0)
+			return;
+
+		//the frame using this heap has retired, the old textures go with the deletion queue.
+		releaseHeap(heap);
+
+		VkMemoryRequirements memRequirements{};
+		memRequirements.size           = size;
+		memRequirements.alignment      = maxAlignment;
+		memRequirements.memoryTypeBits = memoryTypeBits;
+
+#ifdef USE_VMA_ALLOCATOR
+		VmaAllocationCreateInfo allocInfo{};
+		allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		VK_CHECK_RESULT(vmaAllocateMemory(VulkanDevice::get()->getAllocator(), &memRequirements, &allocInfo, &heap.allocation, nullptr));
+#else
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize  = size;
+		allocInfo.memoryTypeIndex = VulkanHelper::findMemoryType(memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		VK_CHECK_RESULT(vkAllocateMemory(*VulkanDevice::get(), &allocInfo, nullptr, &heap.memory));
+#endif
+		heap.size           = size;
+		heap.memoryTypeBits = memoryTypeBits;
+		LOGI("[RenderGraph] transient heap {0} bytes", size);
+	}
+
+	auto VulkanRenderGraph::createTexture(const std::string &name, const RenderGraphTextureDesc &desc, uint64_t offset) -> std::shared_ptr<Texture>
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(!Texture::isDepthFormat(desc.format) && !Texture::isDepthStencilFormat(desc.format), "transient depth targets are not supported, import them");
+
+		auto &heap = getFrameHeap();
+		for (auto &placed : heap.textures)
+		{
+			if (placed.offset == offset && placed.desc == desc)
+			{
+				placed.texture->setName(name);
+				return placed.texture;
+			}
+		}
+
+		auto    imageInfo = imageCreateInfo(desc);
+		VkImage image     = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreateImage(*VulkanDevice::get(), &imageInfo, nullptr, &image));
+#ifdef USE_VMA_ALLOCATOR
+		VK_CHECK_RESULT(vmaBindImageMemory2(VulkanDevice::get()->getAllocator(), heap.allocation, offset, image, nullptr));
+#else
+		VK_CHECK_RESULT(vkBindImageMemory(*VulkanDevice::get(), image, heap.memory, offset));
+#endif
+		auto imageView = VulkanHelper::createImageView(image, imageInfo.format, 1, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+		auto texture = std::make_shared<VulkanTexture2D>(image, imageView, imageInfo.format, desc.width, desc.height);
+		texture->setSampler(Sampler::create(TextureFilter::Linear, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge, 1.f, 1));
+		texture->setName(name);
+
+		heap.textures.push_back({desc, offset, image, imageView, texture});
+		return texture;
+	}
+
+	auto VulkanRenderGraph::barriers(const CommandBuffer *cmd, const std::vector<RenderGraphBarrier> &barriers) -> void
+	{
+		PROFILE_FUNCTION();
+		auto vkCmd = static_cast<const VulkanCommandBuffer *>(cmd);
+
+		for (auto &barrier : barriers)
+		{
+			if (barrier.texture == nullptr)
+				continue;
+
+			VkTexture *vkTexture = nullptr;
+			bool       depth     = false;
+			if (barrier.texture->getType() == TextureType::Color)
+			{
+				vkTexture = static_cast<VulkanTexture2D *>(barrier.texture);
+			}
+			else if (barrier.texture->getType() == TextureType::Depth)
+			{
+				vkTexture = static_cast<VulkanTextureDepth *>(barrier.texture);
+				depth     = true;
+			}
+			else
+			{
+				LOGW("[RenderGraph] unsupported texture type for {0}", barrier.texture->getName());
+				continue;
+			}
+
+			VkImageMemoryBarrier imageBarrier{};
+			imageBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.oldLayout                       = barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : vkTexture->getImageLayout();
+			imageBarrier.newLayout                       = toVkLayout(barrier.dstAccess);
+			imageBarrier.srcAccessMask                   = toVkAccess(barrier.srcAccess);
+			imageBarrier.dstAccessMask                   = toVkAccess(barrier.dstAccess);
+			imageBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image                           = vkTexture->getImage();
+			imageBarrier.subresourceRange.aspectMask     = depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			imageBarrier.subresourceRange.baseMipLevel   = 0;
+			imageBarrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+			imageBarrier.subresourceRange.baseArrayLayer = 0;
+			imageBarrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+
+			//goes through the batcher, all barriers of a pass end up in one vkCmdPipelineBarrier.
+			vkCmd->pipelineBarrier(toVkStage(barrier.srcAccess, true), toVkStage(barrier.dstAccess, false), imageBarrier);
+			vkTexture->setImageLayout(imageBarrier.newLayout);
+		}
+	}
+
+	auto VulkanRenderGraph::beginPass(const CommandBuffer *cmd, const std::string &name) -> void
+	{
+		debug_utils::cmdBeginLabel(name);
+		if (auto &profiler = VulkanContext::get()->getGPUProfiler())
+			profiler->begin(cmd, name.c_str());
+	}
+
+	auto VulkanRenderGraph::endPass(const CommandBuffer *cmd, const std::string &name) -> void
+	{
+		if (auto &profiler = VulkanContext::get()->getGPUProfiler())
+			profiler->end(cmd);
+		debug_utils::cmdEndLabel();
+	}
+}        // namespace maple
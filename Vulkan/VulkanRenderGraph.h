@@ -0,0 +1,63 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../RenderGraph.h"
+#include "VulkanHelper.h"
+#include "VulkanSwapChain.h"
+#include <array>
+#include <vector>
+
+namespace maple
+{
+	class VulkanTexture2D;
+
+	/**
+	 * places the transient textures of the render graph in one memory heap per frame in
+	 * flight, so aliased textures never overlap with the frame still running on the GPU.
+	 * transient textures are colour only, depth targets have to be imported.
+	 */
+	class VulkanRenderGraph : public RenderGraphBackend
+	{
+	  public:
+		VulkanRenderGraph() = default;
+		~VulkanRenderGraph();
+
+		auto getMemoryRequirements(const RenderGraphTextureDesc &desc) -> RenderGraphMemoryRequirements override;
+		auto allocateHeap(uint64_t size, uint32_t memoryTypeBits) -> void override;
+		auto createTexture(const std::string &name, const RenderGraphTextureDesc &desc, uint64_t offset) -> std::shared_ptr<Texture> override;
+		auto barriers(const CommandBuffer *cmd, const std::vector<RenderGraphBarrier> &barriers) -> void override;
+		auto beginPass(const CommandBuffer *cmd, const std::string &name) -> void override;
+		auto endPass(const CommandBuffer *cmd, const std::string &name) -> void override;
+
+	  private:
+		struct PlacedTexture
+		{
+			RenderGraphTextureDesc           desc;
+			uint64_t                         offset;
+			VkImage                          image;
+			VkImageView                      imageView;
+			std::shared_ptr<VulkanTexture2D> texture;
+		};
+
+		struct FrameHeap
+		{
+			uint64_t size           = 0;
+			uint32_t memoryTypeBits = 0;
+#ifdef USE_VMA_ALLOCATOR
+			VmaAllocation allocation = VK_NULL_HANDLE;
+#else
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+#endif
+			std::vector<PlacedTexture> textures;
+		};
+
+		auto getFrameHeap() -> FrameHeap &;
+		auto releaseHeap(FrameHeap &heap) -> void;
+
+		std::array<FrameHeap, MAX_SWAPCHAIN_BUFFERS>                                 heaps;
+		std::vector<std::pair<RenderGraphTextureDesc, RenderGraphMemoryRequirements>> requirementsCache;
+		uint64_t                                                                      maxAlignment = 1;
+	};
+}        // namespace maple
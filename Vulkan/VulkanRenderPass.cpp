@@ -119,7 +119,7 @@ namespace maple
 				VkImageLayout         layout = std::static_pointer_cast<VulkanTexture2D>(texture)->getImageLayout();
 				VkAttachmentReference colorAttachmentRef = {};
 				colorAttachmentRef.attachment = uint32_t(i);
-				colorAttachmentRef.layout = layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : layout;
+				colorAttachmentRef.layout = layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR || layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : layout;
 				colorAttachmentReferences.push_back(colorAttachmentRef);
 				depthOnly = false;
 			}
@@ -178,10 +178,7 @@ namespace maple
 
 	VulkanRenderPass::~VulkanRenderPass()
 	{
-		auto renderPass = this->renderPass;
-		VulkanContext::getDeletionQueue().emplace([renderPass]() {
-			vkDestroyRenderPass(*VulkanDevice::get(), renderPass, nullptr);
-			});
+		VulkanContext::getDeletionQueue().destroy(DeletionType::RenderPass, renderPass);
 		delete[] clearValue;
 	}
 
@@ -29,7 +29,6 @@ namespace maple
 	VulkanSampler::~VulkanSampler()
 	{
 		auto &deletionQueue = VulkanContext::getDeletionQueue();
-		auto s = sampler;
-		deletionQueue.emplace([s] { vkDestroySampler(*VulkanDevice::get(), s, nullptr); });
+		deletionQueue.destroy(DeletionType::Sampler, sampler);
 	}
 } // namespace maple
\ No newline at end of file
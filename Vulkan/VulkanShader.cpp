@@ -7,9 +7,11 @@
 #include "Raytracing/RayTracingProperties.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanDevice.h"
+#include "VulkanLayoutCache.h"
 #include "VulkanPipeline.h"
-#include <spirv_cross/spirv_cross.hpp>
+#include "VulkanShaderReflection.h"
 #include <fstream>
+#include <sys/stat.h>
 
 namespace maple
 {
@@ -52,180 +54,6 @@ namespace maple
 			return 0;
 		}
 
-		inline auto getVulkanFormat(const spirv_cross::SPIRType type)
-		{
-			VkFormat uintTypes[] =
-			{
-				VK_FORMAT_R32_UINT,
-				VK_FORMAT_R32G32_UINT,
-				VK_FORMAT_R32G32B32_UINT,
-				VK_FORMAT_R32G32B32A32_UINT };
-
-			VkFormat intTypes[] =
-			{
-				VK_FORMAT_R32_SINT,
-				VK_FORMAT_R32G32_SINT,
-				VK_FORMAT_R32G32B32_SINT,
-				VK_FORMAT_R32G32B32A32_SINT };
-
-			VkFormat floatTypes[] =
-			{
-				VK_FORMAT_R32_SFLOAT,
-				VK_FORMAT_R32G32_SFLOAT,
-				VK_FORMAT_R32G32B32_SFLOAT,
-				VK_FORMAT_R32G32B32A32_SFLOAT };
-
-			VkFormat doubleTypes[] =
-			{
-				VK_FORMAT_R64_SFLOAT,
-				VK_FORMAT_R64G64_SFLOAT,
-				VK_FORMAT_R64G64B64_SFLOAT,
-				VK_FORMAT_R64G64B64A64_SFLOAT,
-			};
-
-			switch (type.basetype)
-			{
-			case spirv_cross::SPIRType::UInt:
-				return uintTypes[type.vecsize - 1];
-			case spirv_cross::SPIRType::Int:
-				return intTypes[type.vecsize - 1];
-			case spirv_cross::SPIRType::Float:
-				return floatTypes[type.vecsize - 1];
-			case spirv_cross::SPIRType::Double:
-				return doubleTypes[type.vecsize - 1];
-			default:
-				LOGC("Cannot find VK_Format : {0}", type.basetype);
-				return VK_FORMAT_R32G32B32A32_SFLOAT;
-			}
-		}
-
-		inline auto sprivTypeToDataType(const spirv_cross::SPIRType type)
-		{
-			switch (type.basetype)
-			{
-			case spirv_cross::SPIRType::Boolean:
-				return ShaderDataType::Bool;
-			case spirv_cross::SPIRType::Int:
-				if (type.vecsize == 1)
-					return ShaderDataType::Int;
-				if (type.vecsize == 2)
-					return ShaderDataType::IVec2;
-				if (type.vecsize == 3)
-					return ShaderDataType::IVec3;
-				if (type.vecsize == 4)
-					return ShaderDataType::IVec4;
-			case spirv_cross::SPIRType::UInt:
-				return ShaderDataType::UInt;
-			case spirv_cross::SPIRType::Float:
-				if (type.columns == 3)
-					return ShaderDataType::Mat3;
-				if (type.columns == 4)
-					return ShaderDataType::Mat4;
-
-				if (type.vecsize == 1)
-					return ShaderDataType::Float32;
-				if (type.vecsize == 2)
-					return ShaderDataType::Vec2;
-				if (type.vecsize == 3)
-					return ShaderDataType::Vec3;
-				if (type.vecsize == 4)
-					return ShaderDataType::Vec4;
-				break;
-			case spirv_cross::SPIRType::Struct:
-				return ShaderDataType::Struct;
-			}
-			LOGW("Unknown spirv type!");
-			return ShaderDataType::None;
-		}
-
-		inline auto getImageFormatName(spv::ImageFormat format) -> const char*
-		{
-			switch (format)
-			{
-			case spv::ImageFormat::ImageFormatRgba32f:
-				return "rgba32f";
-			case spv::ImageFormat::ImageFormatRgba16f:
-				return "rgba16f";
-			case spv::ImageFormat::ImageFormatR32f:
-				return "r32f";
-			case spv::ImageFormat::ImageFormatRgba8:
-				return "rgba8";
-			case spv::ImageFormat::ImageFormatRgba8Snorm:
-				return "rgba8_snorm";
-			case spv::ImageFormat::ImageFormatRg32f:
-				return "rg32f";
-			case spv::ImageFormat::ImageFormatRg16f:
-				return "rg16f";
-			case spv::ImageFormat::ImageFormatRgba32i:
-				return "rgba32i";
-			case spv::ImageFormat::ImageFormatRgba16i:
-				return "rgba16i";
-			case spv::ImageFormat::ImageFormatR32i:
-				return "r32i";
-			case spv::ImageFormat::ImageFormatRgba8i:
-				return "rgba8i";
-			case spv::ImageFormat::ImageFormatRg32i:
-				return "rg32i";
-			case spv::ImageFormat::ImageFormatRg16i:
-				return "rg16i";
-			case spv::ImageFormat::ImageFormatRgba32ui:
-				return "rgba32ui";
-			case spv::ImageFormat::ImageFormatRgba16ui:
-				return "rgba16ui";
-			case spv::ImageFormat::ImageFormatR32ui:
-				return "r32ui";
-			case spv::ImageFormat::ImageFormatRgba8ui:
-				return "rgba8ui";
-			case spv::ImageFormat::ImageFormatRg32ui:
-				return "rg32ui";
-			case spv::ImageFormat::ImageFormatRg16ui:
-				return "rg16ui";
-			case spv::ImageFormat::ImageFormatR11fG11fB10f:
-				return "r11f_g11f_b10f";
-			case spv::ImageFormat::ImageFormatR16f:
-				return "r16f";
-			case spv::ImageFormat::ImageFormatRgb10A2:
-				return "rgb10_a2";
-			case spv::ImageFormat::ImageFormatR8:
-				return "r8";
-			case spv::ImageFormat::ImageFormatRg8:
-				return "rg8";
-			case spv::ImageFormat::ImageFormatR16:
-				return "r16";
-			case spv::ImageFormat::ImageFormatRg16:
-				return "rg16";
-			case spv::ImageFormat::ImageFormatRgba16:
-				return "rgba16";
-			case spv::ImageFormat::ImageFormatR16Snorm:
-				return "r16_snorm";
-			case spv::ImageFormat::ImageFormatRg16Snorm:
-				return "rg16_snorm";
-			case spv::ImageFormat::ImageFormatRgba16Snorm:
-				return "rgba16_snorm";
-			case spv::ImageFormat::ImageFormatR8Snorm:
-				return "r8_snorm";
-			case spv::ImageFormat::ImageFormatRg8Snorm:
-				return "rg8_snorm";
-			case spv::ImageFormat::ImageFormatR8ui:
-				return "r8ui";
-			case spv::ImageFormat::ImageFormatRg8ui:
-				return "rg8ui";
-			case spv::ImageFormat::ImageFormatR16ui:
-				return "r16ui";
-			case spv::ImageFormat::ImageFormatRgb10a2ui:
-				return "rgb10_a2ui";
-			case spv::ImageFormat::ImageFormatR8i:
-				return "r8i";
-			case spv::ImageFormat::ImageFormatRg8i:
-				return "rg8i";
-			case spv::ImageFormat::ImageFormatR16i:
-				return "r16i";
-			default:
-			case spv::ImageFormat::ImageFormatUnknown:
-				return nullptr;
-			}
-		}
-
 		inline auto fileExists(const std::string& file) 
 		{
 			struct stat fileInfo;
@@ -289,7 +117,6 @@ namespace maple
 	auto VulkanShader::bindPushConstants(const CommandBuffer* cmdBuffer, Pipeline* pipeline) -> void
 	{
 		PROFILE_FUNCTION();
-		uint32_t index = 0;
 		for (auto& pc : pushConstants)
 		{
 			uint32_t bits = 0;
@@ -299,10 +126,10 @@ namespace maple
 				bits |= VkConverter::shaderTypeToVK(stage);
 			}
 
-			vkCmdPushConstants(
-				static_cast<const VulkanCommandBuffer*>(cmdBuffer)->getCommandBuffer(),
+			//unchanged contents are not pushed again.
+			static_cast<const VulkanCommandBuffer*>(cmdBuffer)->pushConstants(
 				static_cast<VulkanPipeline*>(pipeline)->getPipelineLayout(),
-				bits, index, pc.size, pc.data.data());
+				bits, pc.offset, pc.size, pc.data.data());
 		}
 	}
 
@@ -321,9 +148,7 @@ namespace maple
 		}
 		else 
 		{
-			std::vector<std::string> lines;
-			StringUtils::split(source, "\n", lines);
-			parseSource(lines, sources);
+			parseSource(source, sources);
 		}
 
 		for (auto& source : sources)
@@ -362,10 +187,10 @@ namespace maple
 				loadShader({ reinterpret_cast<uint32_t*>(buffer->data()), 
 					reinterpret_cast<uint32_t*>(buffer->data()) + size }, 
 					source.first,
-					currentShaderStage);
+					currentShaderStage,
+					source.second);
 			}
-			auto out = StringUtils::split(source.second, ".");
-			shaderGroups.emplace(out[0], shaderStages[currentShaderStage]);
+			shaderGroups.emplace(StringUtils::splitView(source.second, ".").front(), shaderStages[currentShaderStage]);
 			currentShaderStage++;
 		}
 		createPipelineLayout();
@@ -375,7 +200,6 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		std::vector<std::vector<DescriptorLayoutInfo>> layouts;
-		std::vector<bool>                              layoutUsage;
 		std::unordered_set<ShaderType>                 stages;
 
 		auto it = std::max_element(
@@ -387,13 +211,10 @@ namespace maple
 		if (it != std::end(descriptorLayoutInfo))
 		{
 			layouts.resize(it->setID + 1);
-			layoutUsage.resize(it->setID + 1, false);
 		}
 
 		for (auto& descriptorLayout : descriptorLayoutInfo)
 		{
-			layoutUsage[descriptorLayout.setID] = true;
-
 			if (raytracingShader)        //raytracing shader usually shares same pipeline layout
 			{
 				auto iter = std::find_if(layouts[descriptorLayout.setID].begin(), layouts[descriptorLayout.setID].end(), [&](const DescriptorLayoutInfo& info) {
@@ -435,11 +256,11 @@ namespace maple
 			stageFlags |= s.stage;
 		}
 
+		//identical sets share one layout across shaders, unused set indices get the empty layout so set numbers match the shader.
+		auto& layoutCache = *VulkanDevice::get()->getLayoutCache();
+
 		for (size_t i = 0; i < layouts.size(); i++)
 		{
-			if (!layoutUsage[i])
-				continue;
-
 			auto& l = layouts[i];
 
 			std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
@@ -491,22 +312,7 @@ namespace maple
 				setLayoutBindings.emplace_back(setLayoutBinding);
 			}
 
-			VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {};
-			flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
-			flagsInfo.pNext = nullptr;
-			flagsInfo.bindingCount = static_cast<uint32_t>(layoutBindingFlags.size());
-			flagsInfo.pBindingFlags = layoutBindingFlags.data();
-
-			// Pipeline layout
-			VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
-			setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-			setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
-			setLayoutCreateInfo.pBindings = setLayoutBindings.data();
-			setLayoutCreateInfo.pNext = &flagsInfo;
-			VkDescriptorSetLayout layout;
-			vkCreateDescriptorSetLayout(*VulkanDevice::get(), &setLayoutCreateInfo, VK_NULL_HANDLE, &layout);
-
-			descriptorSetLayouts.emplace_back(layout);
+			descriptorSetLayouts.emplace_back(layoutCache.acquireDescriptorSetLayout(setLayoutBindings, layoutBindingFlags));
 		}
 
 		std::vector<VkPushConstantRange> pushConstantRanges;
@@ -522,15 +328,7 @@ namespace maple
 			pushConstantRanges.push_back(VulkanHelper::pushConstantRange(bits, pushConst.size, pushConst.offset));
 		}
 
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
-		pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
-
-		pipelineLayoutCreateInfo.pushConstantRangeCount = uint32_t(pushConstantRanges.size());
-		pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
-
-		VK_CHECK_RESULT(vkCreatePipelineLayout(*VulkanDevice::get(), &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &pipelineLayout));
+		pipelineLayout = layoutCache.acquirePipelineLayout(descriptorSetLayouts, pushConstantRanges);
 	}
 
 	auto VulkanShader::unload() const -> void
@@ -542,13 +340,15 @@ namespace maple
 				vkDestroyShaderModule(*VulkanDevice::get(), stage.module, nullptr);
 		}
 
+		auto& layoutCache = *VulkanDevice::get()->getLayoutCache();
 		for (auto& descriptorLayout : descriptorSetLayouts)
-			vkDestroyDescriptorSetLayout(*VulkanDevice::get(), descriptorLayout, VK_NULL_HANDLE);
+			layoutCache.releaseDescriptorSetLayout(descriptorLayout);
 
-		vkDestroyPipelineLayout(*VulkanDevice::get(), pipelineLayout, VK_NULL_HANDLE);
+		if (pipelineLayout != VK_NULL_HANDLE)
+			layoutCache.releasePipelineLayout(pipelineLayout);
 	}
 
-	auto VulkanShader::loadShader(const std::vector<uint32_t>& spvCode, ShaderType shaderType, int32_t currentShaderStage) -> void
+	auto VulkanShader::loadShader(const std::vector<uint32_t>& spvCode, ShaderType shaderType, int32_t currentShaderStage, const std::string& path) -> void
 	{
 		VkShaderModuleCreateInfo shaderCreateInfo{};
 		shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -556,31 +356,22 @@ namespace maple
 		shaderCreateInfo.pCode = spvCode.data();
 		shaderCreateInfo.pNext = VK_NULL_HANDLE;
 
-		spirv_cross::Compiler        comp(spvCode.data(), spvCode.size());
-		spirv_cross::ShaderResources resources = comp.get_shader_resources();
+		//warm loads take the reflection from memory or the blob next to the spir-v.
+		auto reflection = ShaderReflector::load(spvCode, shaderType, path);
 
 		if (shaderType == ShaderType::Vertex)
 		{
 			//Vertex Layout
 			vertexInputStride = 0;
 
-			auto copyInput = resources.stage_inputs;
-
-			std::sort(copyInput.begin(), copyInput.end(), [&](const auto& left, const auto& right) {
-				auto location = comp.get_decoration(left.id, spv::DecorationLocation);
-				auto location1 = comp.get_decoration(right.id, spv::DecorationLocation);
-				return location < location1;
-				});
-
-			for (const spirv_cross::Resource& resource : copyInput)
+			for (auto& input : reflection.vertexInputs)
 			{
-				const spirv_cross::SPIRType& InputType = comp.get_type(resource.type_id);
 				VkVertexInputAttributeDescription description = {};
-				description.binding = comp.get_decoration(resource.id, spv::DecorationBinding);
-				description.location = comp.get_decoration(resource.id, spv::DecorationLocation);
+				description.binding = input.binding;
+				description.location = input.location;
 				LOGV("Load Vertex , binding : {} location : {}, name : {}", description.binding, description.location, name);
 				description.offset = vertexInputStride;
-				description.format = getVulkanFormat(InputType);
+				description.format = input.format;
 				vertexInputAttributeDescriptions.emplace_back(description);
 				vertexInputStride += getStrideFromVulkanFormat(description.format);
 			}
@@ -589,41 +380,31 @@ namespace maple
 		if (shaderType == ShaderType::Compute)
 		{
 			computeShader = true;
-			localSizeX = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 0);
-			localSizeY = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 1);
-			localSizeZ = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 2);
-			//todo...reflect the image
-
-			for (auto & str : comp.get_declared_extensions())
-			{
-				if (str == "SPV_KHR_ray_query") 
-				{
-					rayQuerySupport = true;
-					break;
-				}
-			}
+			localSizeX = reflection.localSize[0];
+			localSizeY = reflection.localSize[1];
+			localSizeZ = reflection.localSize[2];
+			rayQuerySupport = rayQuerySupport || reflection.rayQuerySupport;
 		}
 
-		for (auto& resource : resources.storage_images)
+		auto findDescriptor = [&](const ShaderReflection::Resource& resource) {
+			return std::find_if(descriptorInfos[resource.set].begin(), descriptorInfos[resource.set].end(), [&](const Descriptor& info) {
+				return info.type == resource.type && info.binding == resource.binding && info.name == resource.name;
+				});
+		};
+
+		//resources are in the order spirv_cross reports them: storage images, uniforms, samplers, ssbos and acceleration structures.
+		for (auto& resource : reflection.resources)
 		{
-			auto& glslType = comp.get_type(resource.base_type_id);
-			auto& glslType2 = comp.get_type(resource.type_id);
+			auto set = resource.set;
+			auto binding = resource.binding;
 
-			if (glslType.basetype == spirv_cross::SPIRType::Image)
+			switch (resource.type)
 			{
-				const char* fmt = getImageFormatName(glslType.image.format);
-				uint32_t    set = comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-				uint32_t    binding = comp.get_decoration(resource.id, spv::DecorationBinding);
-
-				auto iter = std::find_if(descriptorInfos[set].begin(), descriptorInfos[set].end(), [&](const Descriptor& info) {
-					return info.type == DescriptorType::Image && info.binding == binding && info.name == resource.name;
-					});
-
-				if (iter == descriptorInfos[set].end())
+			case DescriptorType::Image:
+				if (findDescriptor(resource) == descriptorInfos[set].end())
 				{
-					LOGI("Load Image, type {0}, set {1}, binding {2}, name {3}", fmt, set, binding, resource.name);
-					auto& type = comp.get_type(resource.type_id);
-					descriptorLayoutInfo.push_back({ DescriptorType::Image, shaderType, binding, set, type.array.size() ? uint32_t(type.array[0]) : 1 });
+					LOGI("Load Image, set {0}, binding {1}, name {2}", set, binding, resource.name);
+					descriptorLayoutInfo.push_back({ DescriptorType::Image, shaderType, binding, set, resource.count });
 
 					auto& descriptorInfo = descriptorInfos[set];
 					auto& descriptor = descriptorInfo.emplace_back();
@@ -634,236 +415,142 @@ namespace maple
 					descriptor.name = resource.name;
 					descriptor.shaderType = shaderType;
 					descriptor.type = DescriptorType::Image;
-					//descriptor.accessFlag = glslType.image.access;
-					descriptor.accessFlag = spv::AccessQualifierReadWrite;
-					descriptor.format = spirvTypeToTextureType(glslType.image.format);
+					descriptor.accessFlag = resource.access;
+					descriptor.format = resource.format;
 				}
-			}
-		}
-		//Descriptor Layout
-		for (auto& u : resources.uniform_buffers)
-		{
-			uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-			uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-			auto& type = comp.get_type(u.type_id);
-
-			LOGI("Uniform {0} at set = {1}, binding = {2}", u.name, set, binding);
-
-			descriptorLayoutInfo.push_back({ 
-				dynamicUniforms.count(u.name) > 0 ? DescriptorType::UniformBufferDynamic : DescriptorType::UniformBuffer, 
-				shaderType, 
-				binding, 
-				set, 
-				type.array.size() ? uint32_t(type.array[0]) : 1 
-			});
+				break;
 
-			auto& bufferType = comp.get_type(u.base_type_id);
-			auto  bufferSize = comp.get_declared_struct_size(bufferType);
-			auto  memberCount = (int32_t)bufferType.member_types.size();
-
-			auto& descriptorInfo = descriptorInfos[set];
-			auto& descriptor = descriptorInfo.emplace_back();
-			descriptor.binding = binding;
-			descriptor.size = (uint32_t)bufferSize;
-			descriptor.name = u.name;
-			descriptor.offset = 0;
-			descriptor.shaderType = shaderType;
-			descriptor.type = dynamicUniforms.count(u.name) > 0 ? DescriptorType::UniformBufferDynamic : DescriptorType::UniformBuffer;
-			descriptor.buffer = nullptr;
-
-			for (int32_t i = 0; i < memberCount; i++)
+			case DescriptorType::UniformBuffer:
 			{
-				auto        type = comp.get_type(bufferType.member_types[i]);
-				const auto& memberName = comp.get_member_name(bufferType.self, i);
-				auto        size = comp.get_declared_struct_member_size(bufferType, i);
-				auto        offset = comp.type_struct_member_offset(bufferType, i);
-
-				std::string uniformName = u.name + "." + memberName;
-
-				auto& member = descriptor.members.emplace_back();
-				member.name = memberName;
-				member.offset = offset;
-				member.size = (uint32_t)size;
-				member.fullName = uniformName;
-				LOGI("{0} - Size {1}, offset {2}", uniformName, size, offset);
-			}
-		}
-
-		for (auto& u : resources.push_constant_buffers)
-		{
-			uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-			uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-			uint32_t binding3 = comp.get_decoration(u.id, spv::DecorationOffset);
-
-			auto& type = comp.get_type(u.type_id);
+				LOGI("Uniform {0} at set = {1}, binding = {2}", resource.name, set, binding);
+				auto type = dynamicUniforms.count(resource.name) > 0 ? DescriptorType::UniformBufferDynamic : DescriptorType::UniformBuffer;
 
-			/*	auto ranges = comp.get_active_buffer_ranges(u.id);
+				descriptorLayoutInfo.push_back({ type, shaderType, binding, set, resource.count });
 
-			uint32_t size = 0;
-			for (auto &range : ranges)
-			{
-				LOGI("Accessing Member {0} offset {1}, size {2}", range.index, range.offset, range.range);
-				size += uint32_t(range.range);
+				auto& descriptorInfo = descriptorInfos[set];
+				auto& descriptor = descriptorInfo.emplace_back();
+				descriptor.binding = binding;
+				descriptor.size = resource.size;
+				descriptor.name = resource.name;
+				descriptor.offset = 0;
+				descriptor.shaderType = shaderType;
+				descriptor.type = type;
+				descriptor.buffer = nullptr;
+				descriptor.members = resource.members;
+				break;
 			}
-*/
-
-			auto& bufferType = comp.get_type(u.base_type_id);
-			auto  bufferSize = comp.get_declared_struct_size(bufferType);
-
-			auto iter = std::find_if(pushConstants.begin(), pushConstants.end(), [&](const PushConstant& consts) {
-				return consts.name == u.name && bufferSize == consts.size;
-				});
 
-			if (iter == pushConstants.end())
-			{
-				auto& push = pushConstants.emplace_back();
-				push.name = u.name;
-				push.shaderStages.emplace(shaderType);
-				int32_t  memberCount = (int32_t)bufferType.member_types.size();
-				uint32_t totalSize = 0;
-				for (int32_t i = 0; i < memberCount; i++)
+			case DescriptorType::ImageSampler:
+				if (findDescriptor(resource) == descriptorInfos[set].end())
 				{
-					auto        type = comp.get_type(bufferType.member_types[i]);
-					const auto& memberName = comp.get_member_name(bufferType.self, i);
-					auto        size = comp.get_declared_struct_member_size(bufferType, i);
-					auto        offset = comp.type_struct_member_offset(bufferType, i);
-
-					std::string uniformName = u.name + "." + memberName;
-
-					auto& member = push.members.emplace_back();
-					member.size = (uint32_t)size;
-					member.offset = offset;
-					member.type = sprivTypeToDataType(type);
-					member.fullName = uniformName;
-					member.name = memberName;
-				}
+					auto& descriptorInfo = descriptorInfos[set];
+					auto& descriptor = descriptorInfo.emplace_back();
 
-				push.size = bufferSize;
-				push.data.resize(bufferSize);
-				LOGI("Push Constant {0} at set = {1}, binding = {2}, size = {3}", u.name.c_str(), set, binding, totalSize);
-			}
-			else
-			{
-				iter->shaderStages.emplace(shaderType);
-			}
-		}
+					LOGI("Found Sampled Texture {0} at set = {1}, binding = {2}", resource.name, set, binding);
 
-		for (auto& u : resources.sampled_images)
-		{
-			uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-			uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+					uint32_t size = resource.count;
+					bool     variableSize = false;
+					if (auto s = arraySize[resource.name]; s > 0)
+					{
+						size = s;
+						variableSize = true;
+					}
 
-			auto iter = std::find_if(descriptorInfos[set].begin(), descriptorInfos[set].end(), [&](const Descriptor& info) {
-				return info.type == DescriptorType::ImageSampler && info.binding == binding && info.name == u.name;
-				});
+					descriptorLayoutInfo.push_back({ DescriptorType::ImageSampler, shaderType, binding, set, size, variableSize });
+					descriptor.binding = binding;
+					descriptor.name = resource.name;
+					descriptor.offset = 0;
+					descriptor.size = 0;
+					descriptor.shaderType = shaderType;
+					descriptor.format = TextureFormat::NONE;
+				}
+				break;
 
-			if (iter == descriptorInfos[set].end())
+			case DescriptorType::Buffer:
 			{
-				auto& descriptorInfo = descriptorInfos[set];
-				auto& descriptor = descriptorInfo.emplace_back();
-
-				auto& type = comp.get_type(u.type_id);
-				LOGI("Found Sampled Texture {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding);
+				LOGI("Buffer {0} at set = {1}, binding = {2}", resource.name, set, binding);
 
-				uint32_t size = 1;
+				uint32_t size = resource.count;
 				bool     variableSize = false;
-				if (type.array.size() > 0)
-				{
-					size = uint32_t(type.array[0]);
-				}
-
-				if (auto s = arraySize[u.name]; s > 0)
+				if (auto s = arraySize[resource.name]; s > 0)
 				{
 					size = s;
 					variableSize = true;
 				}
 
-				descriptorLayoutInfo.push_back({ DescriptorType::ImageSampler, shaderType, binding, set, size, variableSize });
-				descriptor.binding = binding;
-				descriptor.name = u.name;
-				descriptor.offset = 0;
-				descriptor.size = 0;
-				descriptor.shaderType = shaderType;
-				descriptor.format = TextureFormat::NONE;
-			}
-		}
-		//ssbos
-		for (auto& u : resources.storage_buffers)
-		{
-			uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-			uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+				auto iter2 = findDescriptor(resource);
 
-			LOGI("Buffer {0} at set = {1}, binding = {2}", u.name, set, binding);
-			auto& type = comp.get_type(u.type_id);
+				auto iter = std::find_if(descriptorLayoutInfo.begin(), descriptorLayoutInfo.end(), [&](const DescriptorLayoutInfo& info) {
+					return info.type == DescriptorType::Buffer && info.binding == binding && info.setID == set && info.name == resource.name;
+					});
 
-			uint32_t size = 1;
-			bool     variableSize = false;
-			if (type.array.size() > 0)
-			{
-				size = uint32_t(type.array[0]);
-			}
-			if (auto s = arraySize[u.name]; s > 0)
-			{
-				size = s;
-				variableSize = true;
-			}
+				if (iter == descriptorLayoutInfo.end() && iter2 == descriptorInfos[set].end())
+				{
+					descriptorLayoutInfo.push_back({ DescriptorType::Buffer, shaderType, binding, set, size, variableSize, resource.name });
 
-			auto iter2 = std::find_if(descriptorInfos[set].begin(), descriptorInfos[set].end(), [&](const Descriptor& info) {
-				return info.type == DescriptorType::Buffer && info.binding == binding && info.name == u.name;
-				});
+					auto& descriptorInfo = descriptorInfos[set];
+					auto& descriptor = descriptorInfo.emplace_back();
 
-			auto iter = std::find_if(descriptorLayoutInfo.begin(), descriptorLayoutInfo.end(), [&](const DescriptorLayoutInfo& info) {
-				return info.type == DescriptorType::Buffer && info.binding == binding && info.setID == set && info.name == u.name;
-				});
+					descriptor.binding = binding;
+					descriptor.name = resource.name;
+					descriptor.offset = 0;
+					descriptor.shaderType = shaderType;
+					descriptor.type = DescriptorType::Buffer;
+					descriptor.buffer = nullptr;
+					descriptor.size = VK_WHOLE_SIZE;
+				}
+				else
+				{//todo raytracing shader check..
+					auto mask = static_cast<int32_t>(iter->stage) | static_cast<int32_t>(shaderType);
+					iter->stage = static_cast<ShaderType>(mask);
+					iter2->shaderType = static_cast<ShaderType>(mask);
+				}
+				break;
+			}
 
+			case DescriptorType::AccelerationStructure:
+				LOGI("Acceleration Structures {0} at set = {1}, binding = {2}", resource.name, set, binding);
 
-			if (iter == descriptorLayoutInfo.end() && iter2 == descriptorInfos[set].end())
-			{
-				descriptorLayoutInfo.push_back({ DescriptorType::Buffer, shaderType, binding, set, size, variableSize, u.name });
+				if (findDescriptor(resource) == descriptorInfos[set].end())
+				{
+					descriptorLayoutInfo.push_back({ DescriptorType::AccelerationStructure, shaderType, binding, set, 1 });
+					auto& descriptorInfo = descriptorInfos[set];
+					auto& descriptor = descriptorInfo.emplace_back();
 
-				auto& descriptorInfo = descriptorInfos[set];
-				auto& descriptor = descriptorInfo.emplace_back();
+					descriptor.binding = binding;
+					descriptor.name = resource.name;
+					descriptor.offset = 0;
+					descriptor.shaderType = shaderType;
+					descriptor.type = DescriptorType::AccelerationStructure;
+					descriptor.buffer = nullptr;
+					descriptor.size = VK_WHOLE_SIZE;
+				}
+				break;
 
-				descriptor.binding = binding;
-				descriptor.name = u.name;
-				descriptor.offset = 0;
-				descriptor.shaderType = shaderType;
-				descriptor.type = DescriptorType::Buffer;
-				descriptor.buffer = nullptr;
-				descriptor.size = VK_WHOLE_SIZE;
-			}
-			else
-			{//todo raytracing shader check..
-				auto mask = static_cast<int32_t>(iter->stage) | static_cast<int32_t>(shaderType);
-				iter->stage = static_cast<ShaderType>(mask);
-				iter2->shaderType = static_cast<ShaderType>(mask);
+			default:
+				break;
 			}
 		}
 
-		for (auto& u : resources.acceleration_structures)
+		for (auto& u : reflection.pushConstants)
 		{
-			uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-			uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-
-			LOGI("Acceleration Structures {0} at set = {1}, binding = {2}", u.name, set, binding);
-
-			auto iter = std::find_if(descriptorInfos[set].begin(), descriptorInfos[set].end(), [&](const Descriptor& info) {
-				return info.type == DescriptorType::AccelerationStructure && info.binding == binding && info.name == u.name;
+			auto iter = std::find_if(pushConstants.begin(), pushConstants.end(), [&](const PushConstant& consts) {
+				return consts.name == u.name && u.size == consts.size;
 				});
 
-			if (iter == descriptorInfos[set].end())
+			if (iter == pushConstants.end())
 			{
-				descriptorLayoutInfo.push_back({ DescriptorType::AccelerationStructure, shaderType, binding, set, 1 });
-				auto& descriptorInfo = descriptorInfos[set];
-				auto& descriptor = descriptorInfo.emplace_back();
-
-				descriptor.binding = binding;
-				descriptor.name = u.name;
-				descriptor.offset = 0;
-				descriptor.shaderType = shaderType;
-				descriptor.type = DescriptorType::AccelerationStructure;
-				descriptor.buffer = nullptr;
-				descriptor.size = VK_WHOLE_SIZE;
+				auto& push = pushConstants.emplace_back();
+				push.name = u.name;
+				push.shaderStages.emplace(shaderType);
+				push.members = u.members;
+				push.size = u.size;
+				push.data.resize(u.size);
+				LOGI("Push Constant {0} at set = {1}, binding = {2}, size = {3}", u.name, u.set, u.binding, u.size);
+			}
+			else
+			{
+				iter->shaderStages.emplace(shaderType);
 			}
 		}
 
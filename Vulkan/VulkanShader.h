@@ -103,12 +103,12 @@ namespace maple
 		}
 
 	private:
-		auto loadShader(const std::vector<uint32_t>& spvCode, ShaderType type, int32_t currentShaderStage) -> void;
+		auto loadShader(const std::vector<uint32_t>& spvCode, ShaderType type, int32_t currentShaderStage, const std::string& path = "") -> void;
 		auto init(const ShaderTypes& path = {}) -> void;
 		auto createPipelineLayout() -> void;
 		auto unload() const -> void;
 
-		VkPipelineLayout pipelineLayout;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
 
@@ -0,0 +1,472 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#include "VulkanShaderReflection.h"
+#include "../Console.h"
+#include "../HashCode.h"
+#include "../Shader.h"
+#include <spirv_cross/spirv_cross.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace maple
+{
+	namespace
+	{
+		constexpr uint32_t BlobMagic = 0x4C46524D;        //MRFL
+
+		inline auto getVulkanFormat(const spirv_cross::SPIRType type)
+		{
+			VkFormat uintTypes[] =
+			{
+				VK_FORMAT_R32_UINT,
+				VK_FORMAT_R32G32_UINT,
+				VK_FORMAT_R32G32B32_UINT,
+				VK_FORMAT_R32G32B32A32_UINT };
+
+			VkFormat intTypes[] =
+			{
+				VK_FORMAT_R32_SINT,
+				VK_FORMAT_R32G32_SINT,
+				VK_FORMAT_R32G32B32_SINT,
+				VK_FORMAT_R32G32B32A32_SINT };
+
+			VkFormat floatTypes[] =
+			{
+				VK_FORMAT_R32_SFLOAT,
+				VK_FORMAT_R32G32_SFLOAT,
+				VK_FORMAT_R32G32B32_SFLOAT,
+				VK_FORMAT_R32G32B32A32_SFLOAT };
+
+			VkFormat doubleTypes[] =
+			{
+				VK_FORMAT_R64_SFLOAT,
+				VK_FORMAT_R64G64_SFLOAT,
+				VK_FORMAT_R64G64B64_SFLOAT,
+				VK_FORMAT_R64G64B64A64_SFLOAT,
+			};
+
+			switch (type.basetype)
+			{
+			case spirv_cross::SPIRType::UInt:
+				return uintTypes[type.vecsize - 1];
+			case spirv_cross::SPIRType::Int:
+				return intTypes[type.vecsize - 1];
+			case spirv_cross::SPIRType::Float:
+				return floatTypes[type.vecsize - 1];
+			case spirv_cross::SPIRType::Double:
+				return doubleTypes[type.vecsize - 1];
+			default:
+				LOGC("Cannot find VK_Format : {0}", type.basetype);
+				return VK_FORMAT_R32G32B32A32_SFLOAT;
+			}
+		}
+
+		inline auto sprivTypeToDataType(const spirv_cross::SPIRType type)
+		{
+			switch (type.basetype)
+			{
+			case spirv_cross::SPIRType::Boolean:
+				return ShaderDataType::Bool;
+			case spirv_cross::SPIRType::Int:
+				if (type.vecsize == 1)
+					return ShaderDataType::Int;
+				if (type.vecsize == 2)
+					return ShaderDataType::IVec2;
+				if (type.vecsize == 3)
+					return ShaderDataType::IVec3;
+				if (type.vecsize == 4)
+					return ShaderDataType::IVec4;
+			case spirv_cross::SPIRType::UInt:
+				return ShaderDataType::UInt;
+			case spirv_cross::SPIRType::Float:
+				if (type.columns == 3)
+					return ShaderDataType::Mat3;
+				if (type.columns == 4)
+					return ShaderDataType::Mat4;
+
+				if (type.vecsize == 1)
+					return ShaderDataType::Float32;
+				if (type.vecsize == 2)
+					return ShaderDataType::Vec2;
+				if (type.vecsize == 3)
+					return ShaderDataType::Vec3;
+				if (type.vecsize == 4)
+					return ShaderDataType::Vec4;
+				break;
+			case spirv_cross::SPIRType::Struct:
+				return ShaderDataType::Struct;
+			}
+			LOGW("Unknown spirv type!");
+			return ShaderDataType::None;
+		}
+
+		inline auto getArraySize(const spirv_cross::SPIRType &type) -> uint32_t
+		{
+			return type.array.size() ? uint32_t(type.array[0]) : 1;
+		}
+
+		//members of a uniform or push constant block, the type is only needed by push constants.
+		inline auto reflectMembers(spirv_cross::Compiler &comp, const spirv_cross::Resource &resource, bool withType)
+		{
+			std::vector<BufferMemberInfo> members;
+			auto &                        bufferType  = comp.get_type(resource.base_type_id);
+			auto                          memberCount = (int32_t) bufferType.member_types.size();
+			members.reserve(memberCount);
+			for (int32_t i = 0; i < memberCount; i++)
+			{
+				auto &member    = members.emplace_back();
+				member.name     = comp.get_member_name(bufferType.self, i);
+				member.fullName = resource.name + "." + member.name;
+				member.size     = (uint32_t) comp.get_declared_struct_member_size(bufferType, i);
+				member.offset   = comp.type_struct_member_offset(bufferType, i);
+				member.type     = withType ? sprivTypeToDataType(comp.get_type(bufferType.member_types[i])) : ShaderDataType::None;
+			}
+			return members;
+		}
+
+		class BlobWriter
+		{
+		  public:
+			template <typename T>
+			inline auto write(const T &value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				auto offset = blob.size();
+				blob.resize(offset + sizeof(T));
+				std::memcpy(blob.data() + offset, &value, sizeof(T));
+			}
+
+			inline auto write(const std::string &str)
+			{
+				write((uint32_t) str.size());
+				blob.insert(blob.end(), str.begin(), str.end());
+			}
+
+			inline auto write(const std::vector<BufferMemberInfo> &members)
+			{
+				write((uint32_t) members.size());
+				for (auto &member : members)
+				{
+					write(member.size);
+					write(member.offset);
+					write(member.type);
+					write(member.name);
+				}
+			}
+
+			std::vector<uint8_t> blob;
+		};
+
+		class BlobReader
+		{
+		  public:
+			BlobReader(const std::vector<uint8_t> &blob) :
+			    blob(blob)
+			{
+			}
+
+			template <typename T>
+			inline auto read(T &value) -> bool
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				if (offset + sizeof(T) > blob.size())
+					return false;
+				std::memcpy(&value, blob.data() + offset, sizeof(T));
+				offset += sizeof(T);
+				return true;
+			}
+
+			inline auto read(std::string &str) -> bool
+			{
+				uint32_t size = 0;
+				if (!read(size) || offset + size > blob.size())
+					return false;
+				str.assign(reinterpret_cast<const char *>(blob.data()) + offset, size);
+				offset += size;
+				return true;
+			}
+
+			//the full name is not stored, it is rebuilt from the block name.
+			inline auto read(std::vector<BufferMemberInfo> &members, const std::string &blockName) -> bool
+			{
+				uint32_t count = 0;
+				if (!read(count) || count > blob.size() - offset)
+					return false;
+				members.resize(count);
+				for (auto &member : members)
+				{
+					if (!read(member.size) || !read(member.offset) || !read(member.type) || !read(member.name))
+						return false;
+					member.fullName = blockName + "." + member.name;
+				}
+				return true;
+			}
+
+			//counts are checked against the bytes left so a corrupt blob can not allocate much.
+			inline auto readCount(uint32_t &count) -> bool
+			{
+				return read(count) && count <= blob.size() - offset;
+			}
+
+			inline auto isEnd() const
+			{
+				return offset == blob.size();
+			}
+
+		  private:
+			const std::vector<uint8_t> &blob;
+			size_t                      offset = 0;
+		};
+
+		struct ReflectionCache
+		{
+			std::mutex                                     mutex;
+			std::unordered_map<uint64_t, ShaderReflection> reflections;
+		};
+
+		auto getReflectionCache() -> ReflectionCache &
+		{
+			static ReflectionCache cache;
+			return cache;
+		}
+
+		inline auto readFile(const std::string &path, std::vector<uint8_t> &blob) -> bool
+		{
+			std::ifstream fileReader(path, std::ios::ate | std::ios::binary);
+			if (!fileReader)
+				return false;
+			auto fileSize = fileReader.tellg();
+			blob.resize(fileSize);
+			fileReader.seekg(0);
+			return static_cast<bool>(fileReader.read(reinterpret_cast<char *>(blob.data()), fileSize));
+		}
+	}        // namespace
+
+	namespace ShaderReflector
+	{
+		auto getCacheKey(const std::vector<uint32_t> &spvCode, ShaderType type) -> uint64_t
+		{
+			std::size_t seed = std::hash<std::vector<uint32_t>>{}(spvCode);
+			hash::hashCode(seed, Version, static_cast<uint32_t>(type));
+			return seed;
+		}
+
+		auto reflect(const std::vector<uint32_t> &spvCode, ShaderType shaderType) -> ShaderReflection
+		{
+			PROFILE_FUNCTION();
+			ShaderReflection             reflection;
+			spirv_cross::Compiler        comp(spvCode.data(), spvCode.size());
+			spirv_cross::ShaderResources resources = comp.get_shader_resources();
+
+			if (shaderType == ShaderType::Vertex)
+			{
+				for (auto &resource : resources.stage_inputs)
+				{
+					auto &input    = reflection.vertexInputs.emplace_back();
+					input.binding  = comp.get_decoration(resource.id, spv::DecorationBinding);
+					input.location = comp.get_decoration(resource.id, spv::DecorationLocation);
+					input.format   = getVulkanFormat(comp.get_type(resource.type_id));
+				}
+				std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const auto &left, const auto &right) {
+					return left.location < right.location;
+				});
+			}
+
+			if (shaderType == ShaderType::Compute)
+			{
+				for (uint32_t i = 0; i < 3; i++)
+					reflection.localSize[i] = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, i);
+
+				for (auto &str : comp.get_declared_extensions())
+				{
+					if (str == "SPV_KHR_ray_query")
+					{
+						reflection.rayQuerySupport = true;
+						break;
+					}
+				}
+			}
+
+			auto addResource = [&](const spirv_cross::Resource &resource, DescriptorType type) -> ShaderReflection::Resource & {
+				auto &info   = reflection.resources.emplace_back();
+				info.type    = type;
+				info.set     = comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
+				info.binding = comp.get_decoration(resource.id, spv::DecorationBinding);
+				info.count   = getArraySize(comp.get_type(resource.type_id));
+				info.format  = TextureFormat::NONE;
+				info.name    = resource.name;
+				return info;
+			};
+
+			for (auto &resource : resources.storage_images)
+			{
+				auto &glslType = comp.get_type(resource.base_type_id);
+				if (glslType.basetype == spirv_cross::SPIRType::Image)
+				{
+					auto &info  = addResource(resource, DescriptorType::Image);
+					info.format = Shader::spirvTypeToTextureType(glslType.image.format);
+					info.access = spv::AccessQualifierReadWrite;        //glslType.image.access is not reliable
+				}
+			}
+
+			for (auto &resource : resources.uniform_buffers)
+			{
+				auto &info   = addResource(resource, DescriptorType::UniformBuffer);
+				info.size    = (uint32_t) comp.get_declared_struct_size(comp.get_type(resource.base_type_id));
+				info.members = reflectMembers(comp, resource, false);
+			}
+
+			for (auto &resource : resources.push_constant_buffers)
+			{
+				auto &push   = reflection.pushConstants.emplace_back();
+				push.set     = comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
+				push.binding = comp.get_decoration(resource.id, spv::DecorationBinding);
+				push.size    = (uint32_t) comp.get_declared_struct_size(comp.get_type(resource.base_type_id));
+				push.name    = resource.name;
+				push.members = reflectMembers(comp, resource, true);
+			}
+
+			for (auto &resource : resources.sampled_images)
+				addResource(resource, DescriptorType::ImageSampler);
+
+			for (auto &resource : resources.storage_buffers)
+				addResource(resource, DescriptorType::Buffer);
+
+			for (auto &resource : resources.acceleration_structures)
+				addResource(resource, DescriptorType::AccelerationStructure).count = 1;
+
+			return reflection;
+		}
+
+		auto serialize(const ShaderReflection &reflection, uint64_t key) -> std::vector<uint8_t>
+		{
+			BlobWriter writer;
+			writer.write(BlobMagic);
+			writer.write(Version);
+			writer.write(key);
+
+			writer.write((uint32_t) reflection.resources.size());
+			for (auto &resource : reflection.resources)
+			{
+				writer.write(resource.type);
+				writer.write(resource.set);
+				writer.write(resource.binding);
+				writer.write(resource.count);
+				writer.write(resource.size);
+				writer.write(resource.access);
+				writer.write(resource.format);
+				writer.write(resource.name);
+				writer.write(resource.members);
+			}
+
+			writer.write((uint32_t) reflection.pushConstants.size());
+			for (auto &push : reflection.pushConstants)
+			{
+				writer.write(push.set);
+				writer.write(push.binding);
+				writer.write(push.size);
+				writer.write(push.name);
+				writer.write(push.members);
+			}
+
+			writer.write((uint32_t) reflection.vertexInputs.size());
+			for (auto &input : reflection.vertexInputs)
+			{
+				writer.write(input.binding);
+				writer.write(input.location);
+				writer.write(input.format);
+			}
+
+			writer.write(reflection.localSize);
+			writer.write(reflection.rayQuerySupport);
+			return std::move(writer.blob);
+		}
+
+		auto deserialize(const std::vector<uint8_t> &blob, uint64_t key, ShaderReflection &reflection) -> bool
+		{
+			BlobReader reader(blob);
+			uint32_t   magic     = 0;
+			uint32_t   version   = 0;
+			uint64_t   storedKey = 0;
+			if (!reader.read(magic) || !reader.read(version) || !reader.read(storedKey) ||
+			    magic != BlobMagic || version != Version || storedKey != key)
+				return false;
+
+			uint32_t count = 0;
+			if (!reader.readCount(count))
+				return false;
+			reflection.resources.resize(count);
+			for (auto &resource : reflection.resources)
+			{
+				if (!reader.read(resource.type) || !reader.read(resource.set) || !reader.read(resource.binding) ||
+				    !reader.read(resource.count) || !reader.read(resource.size) || !reader.read(resource.access) || !reader.read(resource.format) ||
+				    !reader.read(resource.name) || !reader.read(resource.members, resource.name))
+					return false;
+			}
+
+			if (!reader.readCount(count))
+				return false;
+			reflection.pushConstants.resize(count);
+			for (auto &push : reflection.pushConstants)
+			{
+				if (!reader.read(push.set) || !reader.read(push.binding) || !reader.read(push.size) ||
+				    !reader.read(push.name) || !reader.read(push.members, push.name))
+					return false;
+			}
+
+			if (!reader.readCount(count))
+				return false;
+			reflection.vertexInputs.resize(count);
+			for (auto &input : reflection.vertexInputs)
+			{
+				if (!reader.read(input.binding) || !reader.read(input.location) || !reader.read(input.format))
+					return false;
+			}
+
+			return reader.read(reflection.localSize) && reader.read(reflection.rayQuerySupport) && reader.isEnd();
+		}
+
+		auto load(const std::vector<uint32_t> &spvCode, ShaderType type, const std::string &spvPath) -> ShaderReflection
+		{
+			PROFILE_FUNCTION();
+			auto  key   = getCacheKey(spvCode, type);
+			auto &cache = getReflectionCache();
+			{
+				std::lock_guard<std::mutex> lock(cache.mutex);
+				if (auto iter = cache.reflections.find(key); iter != cache.reflections.end())
+					return iter->second;
+			}
+
+			ShaderReflection     reflection;
+			std::vector<uint8_t> blob;
+			auto                 blobPath = spvPath + ".refl";
+
+			if (spvPath.empty() || !readFile(blobPath, blob) || !deserialize(blob, key, reflection))
+			{
+				reflection = reflect(spvCode, type);
+				if (!spvPath.empty())
+				{
+					blob = serialize(reflection, key);
+					std::ofstream out(blobPath, std::ios::binary | std::ios::trunc);
+					if (!out.write(reinterpret_cast<const char *>(blob.data()), blob.size()))
+						LOGW("can not write shader reflection {0}", blobPath);
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(cache.mutex);
+			return cache.reflections.emplace(key, std::move(reflection)).first->second;
+		}
+
+		auto clearCache() -> void
+		{
+			auto &                      cache = getReflectionCache();
+			std::lock_guard<std::mutex> lock(cache.mutex);
+			cache.reflections.clear();
+		}
+	};        // namespace ShaderReflector
+}        // namespace maple
@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Maple Engine                              		//
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../DescriptorSet.h"
+#include "VulkanHelper.h"
+#include <string>
+#include <vector>
+
+namespace maple
+{
+	/**
+	 * everything VulkanShader needs from one spir-v stage. resources keep the order spirv_cross
+	 * reports them in, per stage settings such as dynamic uniforms or variable array sizes are
+	 * applied by the shader, so the same reflection can be shared between shaders.
+	 */
+	struct ShaderReflection
+	{
+		struct Resource
+		{
+			DescriptorType                type;
+			uint32_t                      set     = 0;
+			uint32_t                      binding = 0;
+			uint32_t                      count   = 1;
+			uint32_t                      size    = 0;
+			uint32_t                      access  = 0;        //spv::AccessQualifier of storage images
+			TextureFormat                 format;
+			std::string                   name;
+			std::vector<BufferMemberInfo> members;
+		};
+
+		struct PushConstantRange
+		{
+			uint32_t                      set     = 0;
+			uint32_t                      binding = 0;
+			uint32_t                      size    = 0;
+			std::string                   name;
+			std::vector<BufferMemberInfo> members;
+		};
+
+		struct VertexInput
+		{
+			uint32_t binding  = 0;
+			uint32_t location = 0;
+			VkFormat format   = VK_FORMAT_UNDEFINED;
+		};
+
+		std::vector<Resource>          resources;
+		std::vector<PushConstantRange> pushConstants;
+		std::vector<VertexInput>       vertexInputs;        //sorted by location
+		uint32_t                       localSize[3]    = {0, 0, 0};
+		bool                           rayQuerySupport = false;
+	};
+
+	namespace ShaderReflector
+	{
+		/**
+		 * bump whenever the reflection or its blob layout changes, old blobs are then ignored.
+		 */
+		constexpr uint32_t Version = 1;
+
+		/**
+		 * identifies the reflection of the spir-v, covers the version and the shader stage.
+		 */
+		auto getCacheKey(const std::vector<uint32_t> &spvCode, ShaderType type) -> uint64_t;
+
+		auto reflect(const std::vector<uint32_t> &spvCode, ShaderType type) -> ShaderReflection;
+
+		auto serialize(const ShaderReflection &reflection, uint64_t key) -> std::vector<uint8_t>;
+
+		/**
+		 * returns false if the blob is truncated or was written for another key.
+		 */
+		auto deserialize(const std::vector<uint8_t> &blob, uint64_t key, ShaderReflection &reflection) -> bool;
+
+		/**
+		 * looks the reflection up in memory, then in <spvPath>.refl, and only runs spirv_cross if
+		 * both miss, writing the blob back next to the spir-v. an empty path skips the file.
+		 */
+		auto load(const std::vector<uint32_t> &spvCode, ShaderType type, const std::string &spvPath = "") -> ShaderReflection;
+
+		auto clearCache() -> void;
+	};        // namespace ShaderReflector
+}        // namespace maple
@@ -4,11 +4,13 @@
 
 #include "VulkanStorageBuffer.h"
 #include "VulkanBuffer.h"
+#include "VulkanCommandBuffer.h"
 #include "Console.h"
 namespace maple
 {
 	VulkanStorageBuffer::VulkanStorageBuffer(uint32_t size, const void *data, const BufferOptions &options) :
-	    options(options)
+	    options(options),
+	    size(size)
 	{
 		accessFlagBits = VK_ACCESS_SHADER_READ_BIT;
 
@@ -30,7 +32,9 @@ namespace maple
 		vulkanBuffer = std::make_shared<VulkanBuffer>();
 	}
 
-	VulkanStorageBuffer::VulkanStorageBuffer(uint32_t size, uint32_t flags, const BufferOptions &options)
+	VulkanStorageBuffer::VulkanStorageBuffer(uint32_t size, uint32_t flags, const BufferOptions &options) :
+	    options(options),
+	    size(size)
 	{
 		vulkanBuffer = std::make_shared<VulkanBuffer>(flags, size, nullptr, options.vmaUsage, options.vmaCreateFlags);
 	}
@@ -55,8 +59,10 @@ namespace maple
 		}
 		else
 		{
+			grow(size, false, nullptr);
 			vulkanBuffer->setVkData(size, data);
 		}
+		this->size = size;
 	}
 
 	auto VulkanStorageBuffer::getHandle() const -> VkBuffer &
@@ -94,26 +100,54 @@ namespace maple
 	auto VulkanStorageBuffer::getSize() const -> uint32_t
 	{
 		PROFILE_FUNCTION();
+		return size;
+	}
+
+	auto VulkanStorageBuffer::getCapacity() const -> uint32_t
+	{
 		return vulkanBuffer->getSize();
 	}
 
 	auto VulkanStorageBuffer::resize(uint32_t size) -> void
 	{
 		PROFILE_FUNCTION();
-		dirty = true;
-		vulkanBuffer->release();
+		grow(size, false, nullptr);
+		this->size = size;
+	}
 
-		VkBufferUsageFlags flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-		accessFlagBits           = VK_ACCESS_SHADER_READ_BIT;
+	auto VulkanStorageBuffer::resize(uint32_t size, const CommandBuffer *copyCommand) -> void
+	{
+		PROFILE_FUNCTION();
+		grow(size, true, copyCommand);
+		this->size = size;
+	}
 
-		if (options.indirect)
+	auto VulkanStorageBuffer::grow(uint32_t size, bool keepContents, const CommandBuffer *copyCommand) -> void
+	{
+		if (size <= vulkanBuffer->getSize())
+			return;
+
+		//descriptors pointing to the old VkBuffer have to be rewritten.
+		dirty = true;
+
+		if (vulkanBuffer->getSize() == 0)
 		{
-			flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
-			accessFlagBits |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			VkBufferUsageFlags flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+			accessFlagBits           = VK_ACCESS_SHADER_READ_BIT;
+
+			if (options.indirect)
+			{
+				flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+				accessFlagBits |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			}
+
+			lastAccessFlagBits = accessFlagBits;
+			vulkanBuffer->init(flags, size, nullptr, options.vmaUsage, options.vmaCreateFlags);
+			return;
 		}
 
-		lastAccessFlagBits = accessFlagBits;
-		vulkanBuffer->init(flags, size, nullptr, options.vmaUsage, options.vmaCreateFlags);
+		vulkanBuffer->grow(size, keepContents, true,
+		                   copyCommand != nullptr ? static_cast<const VulkanCommandBuffer *>(copyCommand)->getCommandBuffer() : VK_NULL_HANDLE);
 	}
 
 	auto VulkanStorageBuffer::setAccessFlagBits(uint32_t flags) -> void
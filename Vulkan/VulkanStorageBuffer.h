@@ -23,7 +23,9 @@ namespace maple
 		auto map() -> void * override;
 		auto getDeviceAddress() const -> uint64_t override;
 		auto getSize() const -> uint32_t override;
+		auto getCapacity() const -> uint32_t override;
 		auto resize(uint32_t size) -> void override;
+		auto resize(uint32_t size, const CommandBuffer *copyCommand) -> void override;
 
 		inline auto getAccessFlagBits() const
 		{
@@ -48,7 +50,10 @@ namespace maple
 
 	  private:
 		std::shared_ptr<VulkanBuffer> vulkanBuffer;
+		auto grow(uint32_t size, bool keepContents, const CommandBuffer *copyCommand) -> void;
+
 		BufferOptions                 options;
+		uint32_t                      size = 0;
 		uint32_t                      accessFlagBits;
 		uint32_t                      lastAccessFlagBits;
 		bool                          dirty = false;
@@ -4,13 +4,20 @@
 
 #include "VulkanSwapChain.h"
 #include "../Console.h"
+#include "VulkanAsyncCompute.h"
+#include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanCommandPool.h"
+#include "VulkanCommandRecycler.h"
 #include "VulkanContext.h"
 #include "VulkanDevice.h"
+#include "VulkanGPUProfiler.h"
 #include "VulkanHelper.h"
 #include "VulkanTexture.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 
@@ -24,6 +31,29 @@ namespace maple
 			glfwCreateWindowSurface(VulkanContext::get()->getVkInstance(), static_cast<GLFWwindow *>(window), nullptr, (VkSurfaceKHR *) &surface);
 			return surface;
 		}
+
+		//acquisition is retried with a warning instead of blocking forever on a stuck presentation engine.
+		constexpr uint64_t AcquireTimeout = 1000000000;        //ns
+
+		inline auto elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+		{
+			return std::chrono::duration<float, std::milli>(to - from).count();
+		}
+
+		template <size_t N>
+		inline auto pushSample(std::array<float, N> &samples, uint32_t &count, float value, float &avg, float &max)
+		{
+			samples[count++ % N] = value;
+			auto filled          = std::min<uint32_t>(count, N);
+			avg                  = 0;
+			max                  = 0;
+			for (uint32_t i = 0; i < filled; i++)
+			{
+				avg += samples[i];
+				max = std::max(max, samples[i]);
+			}
+			avg /= filled;
+		}
 	}        // namespace
 
 	VulkanSwapChain::VulkanSwapChain(uint32_t width, uint32_t height) :
@@ -34,12 +64,23 @@ namespace maple
 
 	VulkanSwapChain::~VulkanSwapChain()
 	{
-		for (uint32_t i = 0; i < swapChainBufferCount; i++)
+		//slots beyond frameCount may be left from a swap chain with more images.
+		for (uint32_t i = 0; i < MAX_SWAPCHAIN_BUFFERS; i++)
 		{
+			if (frames[i].commandBuffer == nullptr)
+				continue;
 			frames[i].commandBuffer->flush();
-			vkDestroySemaphore(*VulkanDevice::get(), presentSemaphore, nullptr);
-			frames[i].commandBuffer = nullptr;
+			vkDestroySemaphore(*VulkanDevice::get(), frames[i].acquireSemaphore, nullptr);
+			frames[i].commandBuffer  = nullptr;
+			frames[i].readbackBuffer = nullptr;
 		}
+
+		for (auto semaphore : renderSemaphores)
+			vkDestroySemaphore(*VulkanDevice::get(), semaphore, nullptr);
+
+		if (headless)
+			return;
+
 		vkDestroySwapchainKHR(*VulkanDevice::get(), swapChain, VK_NULL_HANDLE);
 
 		if (surface != VK_NULL_HANDLE)
@@ -53,9 +94,11 @@ namespace maple
 	auto VulkanSwapChain::init(bool vsync, void *window) -> bool
 	{
 		PROFILE_FUNCTION();
-		this->vsync = vsync;
+		this->vsync         = vsync;
+		pacing.presentMode  = vsync ? PresentMode::Fifo : PresentMode::Mailbox;
 		nativeWin = window;
-		if (surface == VK_NULL_HANDLE)
+		headless  = window == nullptr;
+		if (surface == VK_NULL_HANDLE && !headless)
 			surface = createPlatformSurface(window);
 
 		bool success = init(vsync);
@@ -66,6 +109,9 @@ namespace maple
 	auto VulkanSwapChain::init(bool vsync) -> bool
 	{
 		PROFILE_FUNCTION();
+		if (headless)
+			return initHeadless();
+
 		findImageFormatAndColorSpace();
 
 		if (!surface)
@@ -96,13 +142,12 @@ namespace maple
 		swapChainExtent.width  = static_cast<uint32_t>(width);
 		swapChainExtent.height = static_cast<uint32_t>(height);
 
-		auto swapChainPresentMode = VulkanHelper::chooseSwapPresentMode(pPresentModes, vsync);
-
-		//triple-buffering
-		swapChainBufferCount = surfaceCapabilities.maxImageCount;
+		auto swapChainPresentMode = VulkanHelper::chooseSwapPresentMode(pPresentModes, pacing.presentMode);
 
-		if (swapChainBufferCount > 3)
-			swapChainBufferCount = 3;
+		//triple-buffering, the driver may still create more images than requested.
+		auto requestedImageCount = std::max(surfaceCapabilities.minImageCount, MAX_SWAPCHAIN_BUFFERS);
+		if (surfaceCapabilities.maxImageCount > 0)
+			requestedImageCount = std::min(requestedImageCount, surfaceCapabilities.maxImageCount);
 
 		VkSurfaceTransformFlagBitsKHR preTransform;
 		if (surfaceCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR)
@@ -134,7 +179,7 @@ namespace maple
 		VkSwapchainCreateInfoKHR swapChainCI{};
 		swapChainCI.sType                 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
 		swapChainCI.surface               = surface;
-		swapChainCI.minImageCount         = swapChainBufferCount;
+		swapChainCI.minImageCount         = requestedImageCount;
 		swapChainCI.imageFormat           = colorFormat;
 		swapChainCI.imageExtent.width     = swapChainExtent.width;
 		swapChainCI.imageExtent.height    = swapChainExtent.height;
@@ -166,24 +211,18 @@ namespace maple
 		{
 			vkDestroySwapchainKHR(*VulkanDevice::get(), oldSwapChain, VK_NULL_HANDLE);
 			oldSwapChain = VK_NULL_HANDLE;
-
-			for (uint32_t i = 0; i < swapChainBufferCount; i++)
-			{
-				if (frames[i].commandBuffer->getState() == CommandBufferState::Submitted)
-					frames[i].commandBuffer->wait();
-
-				frames[i].commandBuffer->reset();
-
-				vkDestroySemaphore(*VulkanDevice::get(), presentSemaphore, nullptr);
-				 presentSemaphore = VK_NULL_HANDLE;
-			}
+			waitAllFrames();
 		}
 
 		uint32_t swapChainImageCount;
 		VK_CHECK_RESULT(vkGetSwapchainImagesKHR(*VulkanDevice::get(), swapChain, &swapChainImageCount, VK_NULL_HANDLE));
 
-		VkImage *pSwapChainImages = new VkImage[swapChainImageCount];
-		VK_CHECK_RESULT(vkGetSwapchainImagesKHR(*VulkanDevice::get(), swapChain, &swapChainImageCount, pSwapChainImages));
+		std::vector<VkImage> swapChainImages(swapChainImageCount);
+		VK_CHECK_RESULT(vkGetSwapchainImagesKHR(*VulkanDevice::get(), swapChain, &swapChainImageCount, swapChainImages.data()));
+
+		//images are indexed by the acquired index, frame slots are capped.
+		swapChainBufferCount = swapChainImageCount;
+		frameCount           = std::min(swapChainImageCount, MAX_SWAPCHAIN_BUFFERS);
 
 		for (uint32_t i = 0; i < swapChainBufferCount; i++)
 		{
@@ -202,16 +241,15 @@ namespace maple
 			viewCI.subresourceRange.layerCount     = 1;
 			viewCI.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
 			viewCI.flags                           = 0;
-			viewCI.image                           = pSwapChainImages[i];
+			viewCI.image                           = swapChainImages[i];
 
 			VkImageView imageView;
 			VK_CHECK_RESULT(vkCreateImageView(*VulkanDevice::get(), &viewCI, VK_NULL_HANDLE, &imageView));
-			auto swapChainBuffer = std::make_shared<VulkanTexture2D>(pSwapChainImages[i], imageView, colorFormat, width, height);
+			auto swapChainBuffer = std::make_shared<VulkanTexture2D>(swapChainImages[i], imageView, colorFormat, width, height);
 			swapChainBuffer->transitionImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 			swapChainBuffers.emplace_back(swapChainBuffer);
 		}
 
-		delete[] pSwapChainImages;
 		createFrameData();
 
 		if (graphicsSemaphore == nullptr)
@@ -223,6 +261,72 @@ namespace maple
 		return true;
 	}
 
+	auto VulkanSwapChain::initHeadless() -> bool
+	{
+		PROFILE_FUNCTION();
+		//offscreen images with the rotation of a triple buffered swap chain, nothing waits for a display.
+		swapChainBufferCount = MAX_SWAPCHAIN_BUFFERS;
+		frameCount           = MAX_SWAPCHAIN_BUFFERS;
+		createFrameData();
+
+		for (uint32_t i = 0; i < swapChainBufferCount; i++)
+		{
+			auto swapChainBuffer = std::make_shared<VulkanTexture2D>();
+			swapChainBuffer->buildTexture(TextureFormat::RGBA8, width, height, false, false, false, false, false, 0);
+			swapChainBuffer->setName("SwapChain:" + std::to_string(i));
+			swapChainBuffer->transitionImage(VulkanHelper::getPresentLayout());
+			swapChainBuffers.emplace_back(swapChainBuffer);
+		}
+
+		colorFormat = std::static_pointer_cast<VulkanTexture2D>(swapChainBuffers.front())->getVkFormat();
+		colorSpace  = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+		setReadback(readback);
+
+		if (graphicsSemaphore == nullptr)
+		{
+			VkSemaphoreCreateInfo semaphoreCreateInfo{};
+			semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreCreateInfo, nullptr, &graphicsSemaphore));
+		}
+		return true;
+	}
+
+	auto VulkanSwapChain::setReadback(bool readback) -> void
+	{
+		PROFILE_FUNCTION();
+		if (!headless)
+		{
+			LOGW("readback is only supported by a headless swap chain");
+			return;
+		}
+
+		this->readback = readback;
+		readbackFrame  = UINT32_MAX;
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			if (!readback)
+				frames[i].readbackBuffer = nullptr;
+			else if (frames[i].readbackBuffer == nullptr || frames[i].readbackBuffer->getSize() != width * height * 4)
+				frames[i].readbackBuffer = std::make_shared<VulkanBuffer>(VK_BUFFER_USAGE_TRANSFER_DST_BIT, width * height * 4, nullptr, VMA_MEMORY_USAGE_GPU_TO_CPU);
+		}
+	}
+
+	auto VulkanSwapChain::readPresentedImage(std::vector<uint8_t> &pixels) -> bool
+	{
+		PROFILE_FUNCTION();
+		if (!readback || readbackFrame >= frameCount)
+			return false;
+
+		//the buffer stays untouched until its frame slot is recorded again.
+		waitFrame(readbackFrame);
+		auto &buffer = frames[readbackFrame].readbackBuffer;
+		pixels.resize(width * height * 4);
+		buffer->map();
+		memcpy(pixels.data(), buffer->getMapped(), pixels.size());
+		buffer->unmap();
+		return true;
+	}
+
 	auto VulkanSwapChain::createFrameData() -> void
 	{
 		PROFILE_FUNCTION();
@@ -231,7 +335,7 @@ namespace maple
 		semaphoreInfo.pNext                 = nullptr;
 		semaphoreInfo.flags                 = 0;
 
-		for (uint32_t i = 0; i < swapChainBufferCount; i++)
+		for (uint32_t i = 0; i < frameCount; i++)
 		{
 			if (!frames[i].commandBuffer)
 			{
@@ -242,9 +346,25 @@ namespace maple
 				frames[i].commandBuffer->init(true, *frames[i].commandPool);
 			}
 
+			if (headless)
+				continue;
+
+			if (frames[i].acquireSemaphore == VK_NULL_HANDLE)
+				VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreInfo, nullptr, &frames[i].acquireSemaphore));
+		}
+
+		if (headless)
+			return;
+
+		//kept when the image count shrinks, the destructor releases all of them.
+		if (renderSemaphores.size() < swapChainBufferCount)
+			renderSemaphores.resize(swapChainBufferCount, VK_NULL_HANDLE);
+
+		for (auto &semaphore : renderSemaphores)
+		{
+			if (semaphore == VK_NULL_HANDLE)
+				VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreInfo, nullptr, &semaphore));
 		}
-		if (presentSemaphore == nullptr)
-			VK_CHECK_RESULT(vkCreateSemaphore(*VulkanDevice::get(), &semaphoreInfo, nullptr, &presentSemaphore));
 	}
 
 	auto VulkanSwapChain::createComputeData() -> void
@@ -317,8 +437,19 @@ namespace maple
 		PROFILE_FUNCTION();
 		if (swapChainBufferCount == 1 && acquireImageIndex != std::numeric_limits<uint32_t>::max())
 			return;
+
+		if (headless)
+		{
+			acquireImageIndex = (acquireImageIndex + 1) % swapChainBufferCount;
+			return;
+		}
 		{
-			auto result = vkAcquireNextImageKHR(*VulkanDevice::get(), swapChain, UINT64_MAX, presentSemaphore, VK_NULL_HANDLE, &acquireImageIndex);
+			auto result = vkAcquireNextImageKHR(*VulkanDevice::get(), swapChain, AcquireTimeout, getFrameData().acquireSemaphore, VK_NULL_HANDLE, &acquireImageIndex);
+			while (result == VK_TIMEOUT || result == VK_NOT_READY)
+			{
+				LOGW("[VULKAN] swap chain image was not available within {0} ms", AcquireTimeout / 1000000);
+				result = vkAcquireNextImageKHR(*VulkanDevice::get(), swapChain, AcquireTimeout, getFrameData().acquireSemaphore, VK_NULL_HANDLE, &acquireImageIndex);
+			}
 
 			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 			{
@@ -334,6 +465,8 @@ namespace maple
 					}
 					vkDeviceWaitIdle(*VulkanDevice::get());
 					onResize(width, height, true);
+					//nothing was acquired and the semaphore is unsignaled, try again on the new swap chain.
+					acquireNextImage();
 				}
 				return;
 			}
@@ -348,28 +481,207 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		auto &frameData = getFrameData();
-		frameData.commandBuffer->executeInternal(
-		    {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
-		    {presentSemaphore},
-		    {/*frameData.commandBuffer->getSemaphore()*/},
-		    true);
+		//one-time uploads recorded during this frame go first on the same queue.
+		VulkanContext::get()->getCommandRecycler()->submitUploads(frameSlot, VulkanDevice::get()->getGraphicsQueue());
+
+		std::vector<VkPipelineStageFlags> waitStages;
+		std::vector<VkSemaphore>          waitSemaphores;
+		std::vector<VkSemaphore>          signalSemaphores{/*frameData.commandBuffer->getSemaphore()*/};
+		std::vector<uint64_t>             waitValues;
+		std::vector<uint64_t>             signalValues;
+		//headless images are not acquired from a presentation engine.
+		if (!headless)
+		{
+			waitStages.emplace_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+			waitSemaphores.emplace_back(frameData.acquireSemaphore);
+			signalSemaphores.emplace_back(renderSemaphores[acquireImageIndex]);
+		}
+		//advances the graphics timeline async compute jobs wait for.
+		VulkanContext::get()->getAsyncCompute()->onGraphicsSubmit(waitStages, waitSemaphores, waitValues, signalSemaphores, signalValues);
+
+		frameData.commandBuffer->executeInternal(waitStages, waitSemaphores, signalSemaphores, true, waitValues, signalValues);
+		frameData.inFlight  = true;
+		frameData.completed = false;
+
+		pacingStats.cpuTime = elapsedMs(frameData.inputTime, std::chrono::steady_clock::now());
+		pacingStats.frames++;
+		pollCompletedFrames();
+	}
+
+	auto VulkanSwapChain::getFramesInFlight() const -> uint32_t
+	{
+		return std::clamp<uint32_t>(pacing.framesInFlight, 1, std::max<uint32_t>(frameCount, 1));
+	}
+
+	auto VulkanSwapChain::onFrameCompleted(FrameData &frame) -> void
+	{
+		frame.completed     = true;
+		frame.completeTime  = std::chrono::steady_clock::now();
+		pacingStats.latency = elapsedMs(frame.inputTime, frame.completeTime);
+		pushSample(latencies, latencyCount, pacingStats.latency, pacingStats.latencyAvg, pacingStats.latencyMax);
+	}
+
+	auto VulkanSwapChain::pollCompletedFrames() -> void
+	{
+		//completion is only observed here or when waiting, latency is accurate to the polling interval.
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			auto &frame = frames[i];
+			if (frame.inFlight && !frame.completed && frame.commandBuffer->isComplete())
+				onFrameCompleted(frame);
+		}
+	}
+
+	auto VulkanSwapChain::waitFrame(uint32_t slot) -> void
+	{
+		PROFILE_FUNCTION();
+		auto &frame = frames[slot];
+		if (!frame.inFlight)
+			return;
+
+		auto start = std::chrono::steady_clock::now();
+		if (frame.commandBuffer->getState() == CommandBufferState::Submitted)
+			frame.commandBuffer->wait();
+		if (!frame.completed)
+			onFrameCompleted(frame);
+		waitTime += elapsedMs(start, std::chrono::steady_clock::now());
+
+		//everything the slot recorded has finished, its per-frame resources can be recycled.
+		frame.commandBuffer->reset();
+		frame.inFlight = false;
+		VulkanContext::get()->getCommandRecycler()->resetFrame(slot);
+		VulkanContext::getDeletionQueue(slot).flush();
+	}
+
+	auto VulkanSwapChain::waitAllFrames() -> void
+	{
+		PROFILE_FUNCTION();
+		for (uint32_t i = 0; i < frameCount; i++)
+			waitFrame(i);
+	}
+
+	auto VulkanSwapChain::waitBeforeInput() -> void
+	{
+		PROFILE_FUNCTION();
+		if (inputWaited)
+			return;
+
+		pollCompletedFrames();
+		auto next = static_cast<uint32_t>(frameCounter % getFramesInFlight());
+		waitTime  = 0;
+		waitFrame(next);
+
+		//time acquisition would block for after input was sampled is spent here instead.
+		if (pacing.lowLatency && inputDelay > 0)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(inputDelay));
+			waitTime += elapsedMs(start, std::chrono::steady_clock::now());
+		}
+
+		frames[next].inputTime = std::chrono::steady_clock::now();
+		inputWaited            = true;
+	}
+
+	auto VulkanSwapChain::setFramePacing(const FramePacing &pacing) -> void
+	{
+		PROFILE_FUNCTION();
+		MAPLE_ASSERT(!isRecording(), "frame pacing can not change while a frame is recording");
+		auto recreate = !headless && swapChain != VK_NULL_HANDLE && pacing.presentMode != this->pacing.presentMode;
+
+		//slots beyond a smaller count would never be waited for again.
+		waitAllFrames();
+		this->pacing = pacing;
+		inputDelay   = 0;
+		if (recreate)
+			onResize(width, height, true);
 	}
 
 	auto VulkanSwapChain::begin() -> void
 	{
 		PROFILE_FUNCTION();
 		PROFILE_FRAMEMARKER();
+		auto now = std::chrono::steady_clock::now();
+		if (frameCounter > 0)
+		{
+			pacingStats.frameTime = elapsedMs(frameStart, now);
+			pushSample(frameTimes, frameTimeCount, pacingStats.frameTime, pacingStats.frameTimeAvg, pacingStats.frameTimeMax);
+		}
+		frameStart = now;
+
+		//without waitBeforeInput the input was sampled already, the frame starts counting from here.
+		auto next = static_cast<uint32_t>(frameCounter % getFramesInFlight());
+		if (!inputWaited)
+		{
+			pollCompletedFrames();
+			waitTime = 0;
+			waitFrame(next);
+			frames[next].inputTime = std::chrono::steady_clock::now();
+		}
+		inputWaited = false;
+		frameSlot   = next;
+		frameCounter++;
+
+		auto acquireStart = std::chrono::steady_clock::now();
 		acquireNextImage();
+		auto acquireTime = elapsedMs(acquireStart, std::chrono::steady_clock::now());
+		waitTime += acquireTime;
+		pacingStats.waitTime = waitTime;
+
+		//converges to the delay which leaves acquisition blocking for about the margin.
+		if (pacing.lowLatency)
+			inputDelay = std::clamp(inputDelay + 0.5f * (acquireTime - pacing.marginMs), 0.0f, pacingStats.frameTimeAvg);
+
+		//results of the async compute jobs of the previous frame are acquired ahead of this one.
+		VulkanContext::get()->getAsyncCompute()->onFrameBegin();
+
 		auto commandBuffer = getFrameData().commandBuffer;
 		commandBuffer->beginRecording();
+		if (auto &profiler = VulkanContext::get()->getGPUProfiler())
+			profiler->beginFrame(commandBuffer.get());
 	}
 
 	auto VulkanSwapChain::end() -> void
 	{
 		PROFILE_FUNCTION();
+		if (headless && readback)
+			recordReadback();
+		if (auto &profiler = VulkanContext::get()->getGPUProfiler())
+			profiler->endFrame(getCurrentCommandBuffer());
 		getCurrentCommandBuffer()->endRecording();
 	}
 
+	auto VulkanSwapChain::recordReadback() -> void
+	{
+		PROFILE_FUNCTION();
+		auto  cmd   = static_cast<VulkanCommandBuffer *>(getCurrentCommandBuffer());
+		auto  image = std::static_pointer_cast<VulkanTexture2D>(swapChainBuffers[acquireImageIndex]);
+		auto &frame = getFrameData();
+
+		image->transitionImage(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, cmd);
+
+		//the image may already have been in TRANSFER_SRC, order the copy after the color writes anyway.
+		VkMemoryBarrier barrier{};
+		barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(cmd->getCommandBuffer(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		                     VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent                 = {width, height, 1};
+		vkCmdCopyImageToBuffer(cmd->getCommandBuffer(), image->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frame.readbackBuffer->getVkBuffer(), 1, &region);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(cmd->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		image->transitionImage(VulkanHelper::getPresentLayout(), cmd);
+		readbackRecorded = true;
+	}
+
 	auto VulkanSwapChain::getCurrentCommandBuffer() -> CommandBuffer *
 	{
 		return getFrameData().commandBuffer.get();
@@ -380,39 +692,41 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 
-		VkPresentInfoKHR present{};
-		present.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-		present.pNext              = VK_NULL_HANDLE;
-		present.swapchainCount     = 1;
-		present.pSwapchains        = &swapChain;
-		present.pImageIndices      = &acquireImageIndex;
+		if (!headless)
+		{
+			VkPresentInfoKHR present{};
+			present.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			present.pNext              = VK_NULL_HANDLE;
+			present.swapchainCount     = 1;
+			present.pSwapchains        = &swapChain;
+			present.pImageIndices      = &acquireImageIndex;
 
-		/*present.waitSemaphoreCount = 1;
-		present.pWaitSemaphores    = &getFrameData().commandBuffer->getSemaphore();*/
-		present.pResults           = VK_NULL_HANDLE;
+			present.waitSemaphoreCount = 1;
+			present.pWaitSemaphores    = &renderSemaphores[acquireImageIndex];
+			present.pResults           = VK_NULL_HANDLE;
 
-		auto error = vkQueuePresentKHR(VulkanDevice::get()->getPresentQueue(), &present);
+			auto error = vkQueuePresentKHR(VulkanDevice::get()->getPresentQueue(), &present);
 
-		if (error == VK_ERROR_OUT_OF_DATE_KHR)
-		{
-			LOGE("[Vulkan] SwapChain is out of date");
-		}
-		else if (error == VK_SUBOPTIMAL_KHR)
-		{
-			LOGE("[Vulkan] SwapChain suboptimal....");
-		}
-		else
-		{
-			VK_CHECK_RESULT(error);
+			if (error == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				LOGE("[Vulkan] SwapChain is out of date");
+			}
+			else if (error == VK_SUBOPTIMAL_KHR)
+			{
+				LOGE("[Vulkan] SwapChain suboptimal....");
+			}
+			else
+			{
+				VK_CHECK_RESULT(error);
+			}
 		}
 
-		auto commandBuffer = getFrameData().commandBuffer;
-		if (commandBuffer->getState() == CommandBufferState::Submitted)
+		//the frame is waited for when its slot comes around again, see waitFrame.
+		if (readbackRecorded)
 		{
-			commandBuffer->wait();
+			readbackFrame    = frameSlot;
+			readbackRecorded = false;
 		}
-		commandBuffer->reset();
-		VulkanContext::getDeletionQueue(acquireImageIndex).flush();
 	}
 
 	auto VulkanSwapChain::getComputeCmdBuffer() -> CommandBuffer *
@@ -420,10 +734,17 @@ namespace maple
 		return computeData.commandBuffer.get();
 	}
 
+	auto VulkanSwapChain::isRecording() const -> bool
+	{
+		return frameSlot < frameCount &&
+		       frames[frameSlot].commandBuffer != nullptr &&
+		       frames[frameSlot].commandBuffer->isRecording();
+	}
+
 	auto VulkanSwapChain::getFrameData() -> FrameData &
 	{
-		MAPLE_ASSERT(acquireImageIndex < swapChainBufferCount, "buffer index is out of bounds");
-		return frames[acquireImageIndex];
+		MAPLE_ASSERT(frameSlot < frameCount, "frame slot is out of bounds");
+		return frames[frameSlot];
 	}
 
 	auto VulkanSwapChain::onResize(uint32_t width, uint32_t height, bool forceResize /*= false*/, NativeWindow *windowHandle /*= nullptr*/) -> void
@@ -436,15 +757,14 @@ namespace maple
 		this->width  = width;
 		this->height = height;
 
-		for (uint32_t i = 0; i < swapChainBufferCount; i++)
+		waitAllFrames();
+		swapChainBuffers.clear();
+		if (headless)
 		{
-			if (frames[i].commandBuffer->getState() == CommandBufferState::Submitted)
-				frames[i].commandBuffer->wait();
-
-			swapChainBuffers[i].reset();
+			initHeadless();
+			return;
 		}
 
-		swapChainBuffers.clear();
 		oldSwapChain = swapChain;
 
 		swapChain = VK_NULL_HANDLE;
@@ -6,16 +6,27 @@
 #include "../SwapChain.h"
 #include "../Textures.h"
 #include "VulkanHelper.h"
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace maple
 {
 	constexpr uint32_t MAX_SWAPCHAIN_BUFFERS = 3;
 
+	class VulkanBuffer;
+
 	struct FrameData
 	{
 		std::shared_ptr<VulkanCommandPool>   commandPool;
 		std::shared_ptr<VulkanCommandBuffer> commandBuffer;
+		std::shared_ptr<VulkanBuffer>        readbackBuffer;        //headless only
+		VkSemaphore                          acquireSemaphore = VK_NULL_HANDLE;
+
+		std::chrono::steady_clock::time_point inputTime;
+		std::chrono::steady_clock::time_point completeTime;
+		bool                                  inFlight  = false;
+		bool                                  completed = false;
 	};
 
 	struct ComputeData
@@ -45,20 +56,35 @@ namespace maple
 			return swapChainBuffers[index];
 		}
 
+		/**
+		 * frame in flight slot, per-frame resources are indexed by it. it differs from the image index
+		 * once images are not acquired in order.
+		 */
 		auto getCurrentBufferIndex() const -> uint32_t override
 		{
-			return acquireImageIndex;
+			return frameSlot;
 		}
 
 		auto getCurrentImageIndex() const -> uint32_t override
 		{
 			return acquireImageIndex;
 		}
+		/**
+		 * number of images, the driver may create more than MAX_SWAPCHAIN_BUFFERS.
+		 */
 		auto getSwapChainBufferCount() const -> size_t override
 		{
 			return swapChainBufferCount;
 		}
 
+		/**
+		 * number of frame in flight slots, at most MAX_SWAPCHAIN_BUFFERS.
+		 */
+		inline auto getFrameCount() const
+		{
+			return frameCount;
+		}
+
 		inline auto getScreenFormat() const
 		{
 			return colorFormat;
@@ -87,13 +113,40 @@ namespace maple
 
 		auto getFrameData() -> FrameData &;
 
+		auto isRecording() const -> bool;
+
 		autoUnpack(swapChain);
 
 		auto getComputeCmdBuffer() -> CommandBuffer * override;
 
 		auto getNativeWin() -> void* override { return nativeWin; }
 
+		auto setFramePacing(const FramePacing &pacing) -> void override;
+		auto waitBeforeInput() -> void override;
+
+		inline auto isHeadless() const
+		{
+			return headless;
+		}
+
+		/**
+		 * headless only, copies every frame into a host visible buffer after it is rendered.
+		 */
+		auto setReadback(bool readback) -> void;
+
+		/**
+		 * tightly packed pixels of the last presented image, false if there is none yet.
+		 */
+		auto readPresentedImage(std::vector<uint8_t> &pixels) -> bool;
+
 	  private:
+		auto initHeadless() -> bool;
+		auto recordReadback() -> void;
+		auto getFramesInFlight() const -> uint32_t;
+		auto waitFrame(uint32_t slot) -> void;
+		auto waitAllFrames() -> void;
+		auto pollCompletedFrames() -> void;
+		auto onFrameCompleted(FrameData &frame) -> void;
 		auto createFrameData() -> void;
 		auto createComputeData() -> void;
 
@@ -108,7 +161,14 @@ namespace maple
 		uint32_t width                = 0;
 		uint32_t height               = 0;
 		uint32_t swapChainBufferCount = 0;
+		uint32_t frameCount           = 0;
+		uint32_t frameSlot            = 0;
+		uint32_t readbackFrame        = UINT32_MAX;
+		uint64_t frameCounter         = 0;
 		bool     vsync                = false;
+		bool     headless             = false;
+		bool     readback             = false;
+		bool     readbackRecorded     = false;
 
 		VkSwapchainKHR  swapChain    = nullptr;
 		VkSwapchainKHR  oldSwapChain = nullptr;
@@ -120,7 +180,20 @@ namespace maple
 		// Execution dependency between compute & graphic submission
 		VkSemaphore graphicsSemaphore = nullptr;
 
-		VkSemaphore presentSemaphore = VK_NULL_HANDLE;
+		//one per image, signaled by the frame submission, waited by the present of that image.
+		std::vector<VkSemaphore> renderSemaphores;
+
+		//frame pacing
+		bool  inputWaited = false;
+		float inputDelay  = 0;
+		float waitTime    = 0;
+
+		std::chrono::steady_clock::time_point frameStart;
+
+		std::array<float, FramePacingStats::History> frameTimes{};
+		std::array<float, FramePacingStats::History> latencies{};
+		uint32_t                                     frameTimeCount = 0;
+		uint32_t                                     latencyCount   = 0;
 
 		void* nativeWin = nullptr;
 	};
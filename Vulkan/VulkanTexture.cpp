@@ -4,6 +4,7 @@
 
 #include "VulkanTexture.h"
 #include "../Console.h"
+#include "../StringUtils.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanContext.h"
@@ -173,8 +174,7 @@ namespace maple
 		auto &deletionQueue = VulkanContext::getDeletionQueue();
 		for(auto &view : mipImageViews) {
 			if(view.second) {
-				auto imageView = view.second;
-				deletionQueue.emplace([imageView] { vkDestroyImageView(*VulkanDevice::get(), imageView, nullptr); });
+				deletionQueue.destroy(DeletionType::ImageView, view.second);
 			}
 		}
 
@@ -497,8 +497,8 @@ namespace maple
 	{
 		PROFILE_FUNCTION();
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 	}
 
 	auto VulkanTexture2D::generateMipmaps(const CommandBuffer *cmd) -> void
@@ -548,33 +548,27 @@ namespace maple
 		                }*/
 
 		if(textureImageView) {
-			auto imageView = textureImageView;
-			deletionQueue.emplace([imageView] { vkDestroyImageView(*VulkanDevice::get(), imageView, nullptr); });
+			deletionQueue.destroy(DeletionType::ImageView, textureImageView);
 			textureImageView = nullptr;
 		}
 
 		for(auto &mipmapView : mipImageViews) {
-			deletionQueue.emplace([mipmapView] { vkDestroyImageView(*VulkanDevice::get(), mipmapView.second, nullptr); });
+			deletionQueue.destroy(DeletionType::ImageView, mipmapView.second);
 		}
 		mipImageViews.clear();
 
 		if(textureFboImageView) {
-			auto imageView = textureFboImageView;
-			deletionQueue.emplace([imageView] { vkDestroyImageView(*VulkanDevice::get(), imageView, nullptr); });
+			deletionQueue.destroy(DeletionType::ImageView, textureFboImageView);
 			textureFboImageView = nullptr;
 		}
 
 		if(deleteImage) {
-			auto image = textureImage;
-
 #ifdef USE_VMA_ALLOCATOR
-			auto alloc = allocation;
-			deletionQueue.emplace([image, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), image, alloc); });
+			deletionQueue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-			deletionQueue.emplace([image] { vkDestroyImage(*VulkanDevice::get(), image, nullptr); });
+			deletionQueue.destroy(DeletionType::Image, textureImage);
 			if(textureImageMemory) {
-				auto memory = textureImageMemory;
-				deletionQueue.emplace([memory] { vkFreeMemory(*VulkanDevice::get(), memory, nullptr); });
+				deletionQueue.destroy(DeletionType::Memory, textureImageMemory);
 			}
 #endif
 		}
@@ -600,38 +594,20 @@ namespace maple
 		imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		updated = true;
 		if(textureSampler) {
-			auto sampler = textureSampler;
-			auto imageView = textureImageView;
-			deletionQueue.emplace([sampler, imageView]() {
-				auto device = VulkanDevice::get();
-				vkDestroyImageView(*device, imageView, nullptr);
-				vkDestroySampler(*device, sampler, nullptr);
-			});
+			deletionQueue.destroy(DeletionType::ImageView, textureImageView);
+			deletionQueue.destroy(DeletionType::Sampler, textureSampler);
 		}
 
 		if(textureFboImageView) {
-			auto imageView = textureFboImageView;
-			deletionQueue.emplace([imageView]() {
-				auto device = VulkanDevice::get();
-				vkDestroyImageView(*device, imageView, nullptr);
-			});
+			deletionQueue.destroy(DeletionType::ImageView, textureFboImageView);
 			textureFboImageView = nullptr;
 		}
 
 #ifdef USE_VMA_ALLOCATOR
-		auto image = textureImage;
-		auto alloc = allocation;
-
-		deletionQueue.emplace([image, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), image, alloc); });
+		deletionQueue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-		auto image = textureImage;
-		auto imageMemory = textureImageMemory;
-
-		deletionQueue.emplace([image, imageMemory]() {
-			auto device = VulkanDevice::get();
-			vkDestroyImage(*device, image, nullptr);
-			vkFreeMemory(*device, imageMemory, nullptr);
-		});
+		deletionQueue.destroy(DeletionType::Image, textureImage);
+		deletionQueue.destroy(DeletionType::Memory, textureImageMemory);
 #endif
 	}
 
@@ -666,8 +642,8 @@ namespace maple
 	auto VulkanTextureDepth::setName(const std::string &name) -> void
 	{
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 	}
 
 	auto VulkanTextureDepth::generateMipmaps(const CommandBuffer *cmd) -> void
@@ -790,25 +766,20 @@ namespace maple
 		auto &deletionQueue = VulkanContext::getDeletionQueue();
 
 		if(textureSampler) {
-			auto sampler = textureSampler;
-			deletionQueue.emplace([sampler] { vkDestroySampler(*VulkanDevice::get(), sampler, nullptr); });
+			deletionQueue.destroy(DeletionType::Sampler, textureSampler);
 		}
 
 		if(textureImageView) {
-			auto imageView = textureImageView;
-			deletionQueue.emplace([imageView] { vkDestroyImageView(*VulkanDevice::get(), imageView, nullptr); });
+			deletionQueue.destroy(DeletionType::ImageView, textureImageView);
 		}
 
 		if(deleteImg) {
-			auto image = textureImage;
 #ifdef USE_VMA_ALLOCATOR
-			auto alloc = allocation;
-			deletionQueue.emplace([image, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), image, alloc); });
+			deletionQueue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-			deletionQueue.emplace([image] { vkDestroyImage(*VulkanDevice::get(), image, nullptr); });
+			deletionQueue.destroy(DeletionType::Image, textureImage);
 			if(textureImageMemory) {
-				auto imageMemory = textureImageMemory;
-				deletionQueue.emplace([imageMemory] { vkFreeMemory(*VulkanDevice::get(), imageMemory, nullptr); });
+				deletionQueue.destroy(DeletionType::Memory, textureImageMemory);
 			}
 #endif
 		}
@@ -947,8 +918,8 @@ namespace maple
 	auto VulkanTextureCube::setName(const std::string &name) -> void
 	{
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 	}
 
 	auto VulkanTextureCube::init() -> void
@@ -1067,29 +1038,18 @@ namespace maple
 	{
 		auto &queue = VulkanContext::getDeletionQueue();
 
-		auto textureImageView = this->textureImageView;
-		auto textureImage = this->textureImage;
-		auto textureImageMemory = this->textureImageMemory;
-		auto textureSampler = this->textureSampler;
-		auto imageViews = this->imageViews;
-		auto size = count;
 		updated = true;
-		queue.emplace([textureImageView, textureSampler, imageViews, size]() {
-			vkDestroyImageView(*VulkanDevice::get(), textureImageView, nullptr);
+		queue.destroy(DeletionType::ImageView, textureImageView);
 
-			if(textureSampler) vkDestroySampler(*VulkanDevice::get(), textureSampler, nullptr);
+		if(textureSampler) queue.destroy(DeletionType::Sampler, textureSampler);
 
-			for(uint32_t i = 0; i < size; i++) { vkDestroyImageView(*VulkanDevice::get(), imageViews[i], nullptr); }
-		});
+		for(uint32_t i = 0; i < count; i++) { queue.destroy(DeletionType::ImageView, imageViews[i]); }
 
 #ifdef USE_VMA_ALLOCATOR
-		auto alloc = allocation;
-		queue.emplace([textureImage, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), textureImage, alloc); });
+		queue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-		queue.emplace([textureImage, textureImageMemory]() {
-			vkDestroyImage(*VulkanDevice::get(), textureImage, nullptr);
-			vkFreeMemory(*VulkanDevice::get(), textureImageMemory, nullptr);
-		});
+		queue.destroy(DeletionType::Image, textureImage);
+		queue.destroy(DeletionType::Memory, textureImageMemory);
 #endif
 	}
 
@@ -1106,10 +1066,10 @@ namespace maple
 	auto VulkanTextureDepthArray::setName(const std::string &name) -> void
 	{
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 		for(int32_t i = 0; i < imageViews.size(); i++) {
-			VulkanHelper::setObjectName("ImageView:" + name + "_" + std::to_string(i), (uint64_t)imageViews[i], VK_OBJECT_TYPE_IMAGE_VIEW);
+			VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s_%d", name.c_str(), i).data(), (uint64_t)imageViews[i], VK_OBJECT_TYPE_IMAGE_VIEW);
 		}
 	}
 
@@ -1286,8 +1246,8 @@ namespace maple
 	auto VulkanTexture3D::setName(const std::string &name) -> void
 	{
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 	}
 
 	auto VulkanTexture3D::transitionImage2(VkImageLayout newLayout, const VulkanCommandBuffer *commandBuffer /*= nullptr*/, int32_t mipLevel /*= 0*/)
@@ -1342,25 +1302,19 @@ namespace maple
 		auto &deletionQueue = VulkanContext::getDeletionQueue();
 
 		if(textureSampler) {
-			auto sampler = textureSampler;
-			deletionQueue.emplace([sampler] { vkDestroySampler(*VulkanDevice::get(), sampler, nullptr); });
+			deletionQueue.destroy(DeletionType::Sampler, textureSampler);
 		}
 
 		for(auto textureImageView : mipmapVies) {
-			auto imageView = textureImageView;
-			deletionQueue.emplace([imageView] { vkDestroyImageView(*VulkanDevice::get(), imageView, nullptr); });
+			deletionQueue.destroy(DeletionType::ImageView, textureImageView);
 		}
 
-		auto image = textureImage;
-
 #ifdef USE_VMA_ALLOCATOR
-		auto alloc = allocation;
-		deletionQueue.emplace([image, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), image, alloc); });
+		deletionQueue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-		deletionQueue.emplace([image] { vkDestroyImage(*VulkanDevice::get(), image, nullptr); });
+		deletionQueue.destroy(DeletionType::Image, textureImage);
 		if(textureImageMemory) {
-			auto memory = textureImageMemory;
-			deletionQueue.emplace([memory] { vkFreeMemory(*VulkanDevice::get(), memory, nullptr); });
+			deletionQueue.destroy(DeletionType::Memory, textureImageMemory);
 		}
 #endif
 	}
@@ -1490,39 +1444,28 @@ namespace maple
 	{
 		auto &queue = VulkanContext::getDeletionQueue();
 
-		auto textureImageView = this->textureImageView;
-		auto textureImage = this->textureImage;
-		auto textureImageMemory = this->textureImageMemory;
-		auto textureSampler = this->textureSampler;
-		auto imageViews = this->imageViews;
-		auto size = count;
 		updated = true;
-		queue.emplace([textureImageView, textureSampler, imageViews, size]() {
-			vkDestroyImageView(*VulkanDevice::get(), textureImageView, nullptr);
+		queue.destroy(DeletionType::ImageView, textureImageView);
 
-			if(textureSampler) vkDestroySampler(*VulkanDevice::get(), textureSampler, nullptr);
+		if(textureSampler) queue.destroy(DeletionType::Sampler, textureSampler);
 
-			for(uint32_t i = 0; i < size; i++) { vkDestroyImageView(*VulkanDevice::get(), imageViews[i], nullptr); }
-		});
+		for(uint32_t i = 0; i < count; i++) { queue.destroy(DeletionType::ImageView, imageViews[i]); }
 
 #ifdef USE_VMA_ALLOCATOR
-		auto alloc = allocation;
-		queue.emplace([textureImage, alloc] { vmaDestroyImage(VulkanDevice::get()->getAllocator(), textureImage, alloc); });
+		queue.destroy(DeletionType::Image, textureImage, allocation);
 #else
-		queue.emplace([textureImage, textureImageMemory]() {
-			vkDestroyImage(*VulkanDevice::get(), textureImage, nullptr);
-			vkFreeMemory(*VulkanDevice::get(), textureImageMemory, nullptr);
-		});
+		queue.destroy(DeletionType::Image, textureImage);
+		queue.destroy(DeletionType::Memory, textureImageMemory);
 #endif
 	}
 
 	auto VulkanTexture2DArray::setName(const std::string &name) -> void
 	{
 		Texture::setName(name);
-		VulkanHelper::setObjectName("Image:" + name, (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
-		VulkanHelper::setObjectName("ImageView:" + name, (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("Image:%s", name.c_str()).data(), (uint64_t)textureImage, VK_OBJECT_TYPE_IMAGE);
+		VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s", name.c_str()).data(), (uint64_t)textureImageView, VK_OBJECT_TYPE_IMAGE_VIEW);
 		for(int32_t i = 0; i < imageViews.size(); i++) {
-			VulkanHelper::setObjectName("ImageView:" + name + "_" + std::to_string(i), (uint64_t)imageViews[i], VK_OBJECT_TYPE_IMAGE_VIEW);
+			VulkanHelper::setObjectName(StringUtils::formatTemp("ImageView:%s_%d", name.c_str(), i).data(), (uint64_t)imageViews[i], VK_OBJECT_TYPE_IMAGE_VIEW);
 		}
 	}
 }; // namespace maple
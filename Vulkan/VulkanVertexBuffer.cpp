@@ -6,10 +6,12 @@
 #include "VulkanContext.h"
 #include "VulkanDevice.h"
 #include "VulkanPipeline.h"
+#include <algorithm>
 
 namespace maple
 {
-	VulkanVertexBuffer::VulkanVertexBuffer(const BufferUsage &usage)
+	VulkanVertexBuffer::VulkanVertexBuffer(const BufferUsage &usage) :
+	    bufferUsage(usage)
 	{
 		PROFILE_FUNCTION();
 		auto flags = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
@@ -25,7 +27,14 @@ namespace maple
 	    VulkanBuffer(VulkanDevice::get()->getPhysicalDevice()->isRaytracingSupported() ?
                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR :
                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-	                 size, data, gpuOnly ? VMA_MEMORY_USAGE_GPU_ONLY : VMA_MEMORY_USAGE_CPU_TO_GPU)
+	                 size, data, gpuOnly ? VMA_MEMORY_USAGE_GPU_ONLY : VMA_MEMORY_USAGE_CPU_TO_GPU),
+	    dataSize(size)
+	{
+	}
+
+	VulkanVertexBuffer::VulkanVertexBuffer(const std::shared_ptr<GeometryHeap> &heap, const GeometryAllocation &suballocation, VkBuffer page, VkDeviceAddress pageAddress) :
+	    VulkanBuffer(heap, suballocation, page, pageAddress, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+	    dataSize(suballocation.size)
 	{
 	}
 
@@ -38,36 +47,38 @@ namespace maple
 	auto VulkanVertexBuffer::resize(uint32_t size) -> void
 	{
 		PROFILE_FUNCTION();
-		if (this->size != size)
-		{
-			VulkanBuffer::resize(size, nullptr);
-		}
+		VulkanBuffer::grow(size, true, isGeometric());
+		dataSize = size;
 	}
 
 	auto VulkanVertexBuffer::setData(uint32_t size, const void *data) -> void
 	{
 		PROFILE_FUNCTION();
-		if (size != this->size)
-		{
-			VulkanBuffer::resize(size, data);
-		}
-		else
-		{
-			VulkanBuffer::setVkData(size, data);
-		}
+		//everything is replaced, nothing to carry over when growing.
+		VulkanBuffer::grow(size, false, isGeometric());
+		VulkanBuffer::setVkData(size, data);
+		dataSize = size;
 	}
 
 	auto VulkanVertexBuffer::setDataSub(uint32_t size, const void *data, uint32_t offset) -> void
 	{
 		PROFILE_FUNCTION();
-		if (size != this->size)
-		{
-			VulkanBuffer::resize(size, data);
-		}
-		else
+		VulkanBuffer::grow(offset + size, true, isGeometric());
+		VulkanBuffer::setVkData(size, data, offset);
+		dataSize = std::max<uint64_t>(dataSize, offset + size);
+	}
+
+	auto VulkanVertexBuffer::setDataSub(const std::vector<BufferUpdate> &updates) -> void
+	{
+		PROFILE_FUNCTION();
+		uint64_t end = 0;
+		for (auto &update : updates)
 		{
-			VulkanBuffer::setVkData(size, data);
+			end = std::max<uint64_t>(end, update.offset + update.size);
 		}
+		VulkanBuffer::grow(static_cast<uint32_t>(end), true, isGeometric());
+		VulkanBuffer::setVkData(updates);
+		dataSize = std::max(dataSize, end);
 	}
 
 	auto VulkanVertexBuffer::releasePointer() -> void
@@ -84,7 +95,7 @@ namespace maple
 	auto VulkanVertexBuffer::bind(const CommandBuffer *commandBuffer, Pipeline *pipeline) -> void
 	{
 		PROFILE_FUNCTION();
-		VkDeviceSize offsets[1] = {0};
+		VkDeviceSize offsets[1] = {baseOffset};
 		if (commandBuffer)
 			vkCmdBindVertexBuffers(static_cast<const VulkanCommandBuffer *>(commandBuffer)->getCommandBuffer(), 0, 1, &buffer, offsets);
 	}
@@ -110,8 +121,8 @@ namespace maple
 		PROFILE_FUNCTION();
 		auto buffer = static_cast<VulkanVertexBuffer *>(to);
 		VkBufferCopy bufferCopy;
-		bufferCopy.dstOffset = copy.dstOffset;
-		bufferCopy.srcOffset = copy.srcOffset;
+		bufferCopy.dstOffset = buffer->baseOffset + copy.dstOffset;
+		bufferCopy.srcOffset = baseOffset + copy.srcOffset;
 		bufferCopy.size      = copy.size;
 		vkCmdCopyBuffer(static_cast<VulkanCommandBuffer *>(cmd)->getCommandBuffer(), getVkBuffer(), buffer->getVkBuffer(), 1, &bufferCopy);
 	}
@@ -15,16 +15,23 @@ namespace maple
 	  public:
 		VulkanVertexBuffer(const BufferUsage &usage);
 		VulkanVertexBuffer(const void *data, uint32_t size, bool gpuOnly = false);
+		VulkanVertexBuffer(const std::shared_ptr<GeometryHeap> &heap, const GeometryAllocation &suballocation, VkBuffer page, VkDeviceAddress pageAddress);
 		~VulkanVertexBuffer();
 
 		auto bind(const CommandBuffer *commandBuffer, Pipeline *pipeline) -> void override;
 		auto resize(uint32_t size) -> void override;
 		auto setData(uint32_t size, const void *data) -> void override;
 		auto setDataSub(uint32_t size, const void *data, uint32_t offset) -> void override;
+		auto setDataSub(const std::vector<BufferUpdate> &updates) -> void override;
 		auto releasePointer() -> void override;
 		auto unbind() -> void override;
 
 		inline auto getSize() -> uint64_t override
+		{
+			return dataSize;
+		}
+
+		inline auto getCapacity() const -> uint64_t override
 		{
 			return size;
 		}
@@ -39,10 +46,26 @@ namespace maple
 			return getVkBuffer();
 		};
 
+		inline auto getOffset() const -> uint64_t override
+		{
+			return baseOffset;
+		}
+
+		inline auto getRange() const -> uint64_t override
+		{
+			return heap != nullptr ? VulkanBuffer::size : 0;
+		}
+
 		auto copy(CommandBuffer *cmd, GPUBuffer *to, const BufferCopy &copy) const -> void override;
 
 	  protected:
+		inline auto isGeometric() const
+		{
+			return bufferUsage != BufferUsage::Static;
+		}
+
 		bool        mappedBuffer = false;
 		BufferUsage bufferUsage  = BufferUsage::Static;
+		uint64_t    dataSize     = 0;
 	};
 };        // namespace maple